@@ -0,0 +1,189 @@
+// Compares the direct RawMIDI back-end with alsa_raw: system calls and context switches
+// per message, and the latency between a write and the matching callback.
+//
+// Without arguments, the direct back-end reads from a FIFO, which needs no hardware.
+// To compare both back-ends on real ports, connect an output to an input
+// (MIDI cable, or two snd-virmidi ports linked with aconnect) and pass their names:
+//   alsa_raw_direct_benchmark "VirMIDI 1-0" "VirMIDI 1-1"
+
+#include <libremidi/detail/midi_stream_decoder.hpp>
+#include <libremidi/libremidi.hpp>
+
+#if defined(LIBREMIDI_ALSA_RAW_DIRECT)
+  #include <libremidi/backends/alsa_raw_direct.hpp>
+#endif
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+// Summed over every thread of the process
+struct counters
+{
+  int64_t read_syscalls{};
+  int64_t write_syscalls{};
+  int64_t context_switches{};
+
+  static counters now()
+  {
+    counters c;
+    std::ifstream io{"/proc/self/io"};
+    for (std::string key; io >> key;)
+    {
+      int64_t value{};
+      io >> value;
+      if (key == "syscr:")
+        c.read_syscalls = value;
+      else if (key == "syscw:")
+        c.write_syscalls = value;
+    }
+
+    for (const auto& task : std::filesystem::directory_iterator{"/proc/self/task"})
+    {
+      std::ifstream status{task.path() / "status"};
+      for (std::string line; std::getline(status, line);)
+        if (line.starts_with("voluntary_ctxt_switches:"))
+          c.context_switches += std::atoll(line.c_str() + line.find(':') + 1);
+    }
+    return c;
+  }
+};
+
+struct result
+{
+  double reads_per_message;
+  double writes_per_message;
+  double switches_per_message;
+  double median_latency_ns;
+  double p99_latency_ns;
+};
+
+struct receiver
+{
+  std::atomic_int count{};
+  std::atomic<int64_t> last_ns{};
+
+  libremidi::input_configuration configuration()
+  {
+    return {.on_message = [this](libremidi::message&&) {
+      last_ns.store(libremidi::system_ns(), std::memory_order_relaxed);
+      count.fetch_add(1, std::memory_order_release);
+    }};
+  }
+};
+
+// Sends one message at a time and waits for it, so that each message costs a wakeup
+result ping_pong(int count, libremidi::midi_out& out, receiver& recv)
+{
+  std::vector<int64_t> lat;
+  lat.reserve(count);
+  const unsigned char msg[] = {0x90, 64, 100};
+
+  const auto before = counters::now();
+  for (int i = 0; i < count; i++)
+  {
+    const auto t0 = libremidi::system_ns();
+    out.send_message(msg, sizeof(msg));
+    while (recv.count.load(std::memory_order_acquire) <= i)
+      std::this_thread::yield();
+    lat.push_back(recv.last_ns.load(std::memory_order_relaxed) - t0);
+  }
+  const auto after = counters::now();
+
+  std::sort(lat.begin(), lat.end());
+  return {
+      .reads_per_message = double(after.read_syscalls - before.read_syscalls) / count,
+      .writes_per_message = double(after.write_syscalls - before.write_syscalls) / count,
+      .switches_per_message = double(after.context_switches - before.context_switches) / count,
+      .median_latency_ns = double(lat[lat.size() / 2]),
+      .p99_latency_ns = double(lat[lat.size() * 99 / 100])};
+}
+
+void print(const char* name, result r)
+{
+  std::printf(
+      "%-24s %6.2f read() %6.2f write() %6.2f ctx switches per msg, latency: %10.1f ns median "
+      "%10.1f ns p99\n",
+      name, r.reads_per_message, r.writes_per_message, r.switches_per_message,
+      r.median_latency_ns, r.p99_latency_ns);
+}
+
+#if defined(LIBREMIDI_ALSA_RAW_DIRECT)
+void run_fifo(int count)
+{
+  const auto path = std::filesystem::temp_directory_path() / "libremidi_benchmark_fifo";
+  std::filesystem::remove(path);
+  if (mkfifo(path.c_str(), 0600) != 0)
+    return;
+
+  receiver recv;
+  libremidi::midi_in in{
+      recv.configuration(), libremidi::alsa_raw_direct::input_configuration{.device_path = path}};
+  in.open_port(libremidi::input_port{});
+
+  libremidi::midi_out out{
+      {}, libremidi::alsa_raw_direct::output_configuration{.device_path = path}};
+  out.open_port(libremidi::output_port{});
+
+  print("alsa_raw_direct (FIFO)", ping_pong(count, out, recv));
+  std::filesystem::remove(path);
+}
+#endif
+
+void run_ports(libremidi::API api, int count, std::string_view in_name, std::string_view out_name)
+{
+  if (libremidi::get_api_name(api).empty())
+    return;
+
+  libremidi::observer obs{{}, libremidi::observer_configuration_for(api)};
+  auto ins = obs.get_input_ports();
+  auto outs = obs.get_output_ports();
+  auto in_port = std::find_if(ins.begin(), ins.end(), [=](auto& p) {
+    return p.port_name.find(in_name) != std::string::npos;
+  });
+  auto out_port = std::find_if(outs.begin(), outs.end(), [=](auto& p) {
+    return p.port_name.find(out_name) != std::string::npos;
+  });
+  if (in_port == ins.end() || out_port == outs.end())
+  {
+    std::printf("%-24s ports not found\n", libremidi::get_api_name(api).data());
+    return;
+  }
+
+  receiver recv;
+  libremidi::midi_in in{recv.configuration(), libremidi::midi_in_configuration_for(api)};
+  in.open_port(*in_port);
+  libremidi::midi_out out{{}, libremidi::midi_out_configuration_for(api)};
+  out.open_port(*out_port);
+
+  print(libremidi::get_api_name(api).data(), ping_pong(count, out, recv));
+}
+}
+
+int main(int argc, char** argv)
+{
+  const int count = 10'000;
+  if (argc < 3)
+  {
+#if defined(LIBREMIDI_ALSA_RAW_DIRECT)
+    run_fifo(count);
+#else
+    std::printf("The direct RawMIDI back-end is not available\n");
+#endif
+    return 0;
+  }
+
+  for (auto api : {libremidi::API::ALSA_RAW, libremidi::API::ALSA_RAW_DIRECT})
+    run_ports(api, count, argv[1], argv[2]);
+}
@@ -0,0 +1,91 @@
+// Measures the whole send -> decode -> callback path without any hardware,
+// through the in-process loopback back-end.
+
+#include <libremidi/backends/loopback.hpp>
+#include <libremidi/libremidi.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace
+{
+struct result
+{
+  double ns_per_message;
+  double median_latency_ns;
+  double max_latency_ns;
+};
+
+result run(int count, std::size_t sysex_size, bool real_clock_latency)
+{
+  using namespace std::chrono_literals;
+  namespace lb = libremidi::loopback;
+
+  auto ctx = std::make_shared<lb::context>(
+      lb::context_configuration{.latency = real_clock_latency ? 1us : 0us});
+
+  std::vector<int64_t> latencies;
+  latencies.reserve(count);
+  std::atomic_int received = 0;
+
+  libremidi::midi_in in{
+      {.on_message =
+           [&](libremidi::message&& m) {
+    latencies.push_back(libremidi::system_ns() - m.timestamp);
+    received.fetch_add(1, std::memory_order_release);
+           },
+       .ignore_sysex = false,
+       .timestamps = libremidi::timestamp_mode::SystemMonotonic},
+      lb::input_configuration{ctx}};
+  in.open_virtual_port("benchmark in");
+
+  libremidi::midi_out out{{}, lb::output_configuration{ctx}};
+  out.open_port(libremidi::observer{{}, lb::observer_configuration{ctx}}.get_output_ports()[0]);
+
+  std::vector<unsigned char> msg;
+  if (sysex_size > 0)
+  {
+    msg.assign(sysex_size, 0x10);
+    msg.front() = 0xF0;
+    msg.back() = 0xF7;
+  }
+  else
+  {
+    msg = {0x90, 64, 100};
+  }
+
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < count; i++)
+    out.send_message(msg.data(), msg.size());
+  while (received.load(std::memory_order_acquire) < count)
+    std::this_thread::yield();
+  const auto t1 = std::chrono::steady_clock::now();
+
+  std::sort(latencies.begin(), latencies.end());
+  return {
+      .ns_per_message = std::chrono::duration<double, std::nano>(t1 - t0).count() / count,
+      .median_latency_ns = double(latencies[latencies.size() / 2]),
+      .max_latency_ns = double(latencies.back())};
+}
+
+void print(const char* name, result r)
+{
+  std::printf(
+      "%-32s %10.1f ns/msg %12.1f ns median latency %12.1f ns max latency\n", name,
+      r.ns_per_message, r.median_latency_ns, r.max_latency_ns);
+}
+}
+
+int main(int argc, char** argv)
+{
+  const int count = argc > 1 ? std::atoi(argv[1]) : 1'000'000;
+
+  print("note, synchronous", run(count, 0, false));
+  print("sysex 256 bytes, synchronous", run(count, 256, false));
+  print("note, delivery thread", run(count / 10, 0, true));
+}
@@ -0,0 +1,90 @@
+// Measures the parsing throughput of reader on the valid and invalid files of the
+// test corpus, or of another folder with the same Valid / Invalid layout.
+// The whole folder is then parsed from disk with batch_reader, on one thread
+// and on one thread per core.
+
+#include <libremidi/batch_reader.hpp>
+#include <libremidi/reader.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+std::vector<std::vector<uint8_t>> load_files(const std::filesystem::path& folder)
+{
+  std::vector<std::vector<uint8_t>> files;
+  if (!std::filesystem::exists(folder))
+    return files;
+
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(folder))
+  {
+    if (entry.is_regular_file() && entry.path().extension() == ".mid")
+    {
+      std::ifstream file{entry.path(), std::ios::binary};
+      files.emplace_back(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+  }
+  return files;
+}
+
+void run(const char* name, const std::vector<std::vector<uint8_t>>& files, int iterations)
+{
+  std::size_t bytes = 0;
+  std::size_t diagnostics = 0;
+  libremidi::reader r;
+
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+  {
+    for (const auto& file : files)
+    {
+      r.parse(file);
+      bytes += file.size();
+      diagnostics += r.diagnostics.size();
+    }
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+
+  const double s = std::chrono::duration<double>(t1 - t0).count();
+  std::printf(
+      "%-8s %6zu files %10.2f MB/s %10.0f files/s %8zu diagnostics\n", name, files.size(),
+      bytes / s / 1e6, files.size() * iterations / s, diagnostics / iterations);
+}
+
+void run_batch(const std::filesystem::path& folder, int threads, int iterations)
+{
+  libremidi::batch_reader batch;
+  batch.threadCount = threads;
+  const auto paths = libremidi::batch_reader::list_files(folder);
+
+  libremidi::batch_statistics total;
+  for (int i = 0; i < iterations; i++)
+  {
+    const auto stats = batch.run(paths, [](const libremidi::batch_file&) {});
+    total += stats;
+    total.elapsed += stats.elapsed;
+  }
+
+  std::printf(
+      "%-8s %6zu files %10.2f MB/s %10.0f files/s %8zu not validated\n",
+      threads == 1 ? "batch-1" : "batch-n", paths.size(), total.bytes_per_second() / 1e6,
+      total.files_per_second(), (total.files - total.validated) / iterations);
+}
+}
+
+int main(int argc, char** argv)
+{
+  std::filesystem::path corpus = argc > 1 ? argv[1] : LIBREMIDI_TEST_CORPUS;
+  const int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+
+  run("valid", load_files(corpus / "Valid"), iterations);
+  run("invalid", load_files(corpus / "Invalid"), iterations);
+  run_batch(corpus, 1, iterations);
+  run_batch(corpus, 0, iterations);
+}
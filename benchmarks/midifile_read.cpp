@@ -0,0 +1,196 @@
+// Measures the parsing of a large multi-track file with reader and reader_view,
+// with one thread and with one thread per core, and reading all its events
+// in time order with stream_reader.
+// Seeking to the middle of the file with stream_reader is measured with and without
+// a seek index.
+// The merge of the parsed tracks into a single timeline is then compared with
+// a stable sort of a copy of all the events.
+// Counting loud note-ons is compared between the parsed tracks and their columns.
+// A file can be passed as argument, otherwise a 64-track file is generated.
+
+#include <libremidi/reader.hpp>
+#include <libremidi/writer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+std::vector<uint8_t> generate_file(int tracks, int notes_per_track)
+{
+  libremidi::writer w;
+  for (int t = 0; t < tracks; t++)
+  {
+    for (int n = 0; n < notes_per_track; n++)
+    {
+      const auto note = uint8_t(36 + (n + t) % 48);
+      w.add_event(10, t, libremidi::channel_events::note_on(1 + t % 16, note, 100));
+      w.add_event(10, t, libremidi::channel_events::note_off(1 + t % 16, note, 0));
+    }
+    w.add_event(0, t, libremidi::meta_events::end_of_track());
+  }
+
+  std::stringstream str;
+  w.write(str);
+  const auto s = str.str();
+  return {s.begin(), s.end()};
+}
+
+template <typename Reader>
+double run(const std::vector<uint8_t>& bytes, int threads, int iterations)
+{
+  Reader r;
+  r.threadCount = threads;
+
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+  {
+    if (r.parse(bytes) == libremidi::reader::invalid)
+      std::fprintf(stderr, "invalid file\n");
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+}
+
+double run_stream(const std::vector<uint8_t>& bytes, int iterations)
+{
+  libremidi::stream_reader s;
+  std::size_t count = 0;
+
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+  {
+    if (s.open(bytes) == libremidi::reader::invalid)
+      std::fprintf(stderr, "invalid file\n");
+    while (s.next())
+      count++;
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  if (count == 0)
+    std::fprintf(stderr, "no events\n");
+  return std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+}
+
+double run_seek(const std::vector<uint8_t>& bytes, int64_t interval, int iterations)
+{
+  libremidi::stream_reader s;
+  s.open(bytes);
+  int64_t end = 0;
+  while (auto ev = s.next())
+    end = ev->tick;
+  if (interval > 0)
+    s.build_seek_index(interval);
+
+  uint32_t tempo = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+    tempo += s.seek(end / 2 + i).tempo;
+  const auto t1 = std::chrono::steady_clock::now();
+  if (tempo == 0)
+    std::fprintf(stderr, "no tempo\n");
+  return std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+}
+
+template <typename F>
+double run_merge(F&& f, int iterations)
+{
+  const auto t0 = std::chrono::steady_clock::now();
+  std::size_t count = 0;
+  for (int i = 0; i < iterations; i++)
+    count += f();
+  const auto t1 = std::chrono::steady_clock::now();
+  if (count == 0)
+    std::fprintf(stderr, "no events\n");
+  return std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+}
+}
+
+int main(int argc, char** argv)
+{
+  std::vector<uint8_t> bytes;
+  if (argc > 1)
+  {
+    std::ifstream file{argv[1], std::ios::binary};
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+  else
+  {
+    bytes = generate_file(64, 20000);
+  }
+
+  constexpr int iterations = 10;
+  std::printf("file: %zu bytes\n", bytes.size());
+  std::printf("%-12s %-8s %10s\n", "reader", "threads", "ms/parse");
+  for (int threads : {1, 0})
+  {
+    const char* t = threads == 1 ? "1" : "all";
+    std::printf(
+        "%-12s %-8s %10.2f\n", "reader", t, run<libremidi::reader>(bytes, threads, iterations));
+    std::printf(
+        "%-12s %-8s %10.2f\n", "reader_view", t,
+        run<libremidi::reader_view>(bytes, threads, iterations));
+  }
+  std::printf("%-12s %-8s %10.2f\n", "stream", "1", run_stream(bytes, iterations));
+
+  std::printf("%-12s %-8s %10s\n", "seek", "interval", "ms/seek");
+  std::printf("%-12s %-8s %10.3f\n", "seek", "none", run_seek(bytes, 0, iterations));
+  std::printf("%-12s %-8s %10.3f\n", "seek", "480", run_seek(bytes, 480, iterations));
+
+  libremidi::reader r{true};
+  r.parse(bytes);
+  std::printf("%-12s %10s\n", "merge", "ms/merge");
+  std::printf(
+      "%-12s %10.2f\n", "merged",
+      run_merge(
+          [&] {
+            std::size_t sum = 0;
+            for (auto ev : r.merged())
+              sum += ev.m.size();
+            return sum;
+          },
+          iterations));
+  std::printf(
+      "%-12s %10.2f\n", "to_track",
+      run_merge([&] { return r.merged().to_track().size(); }, iterations));
+  std::printf(
+      "%-12s %10.2f\n", "stable_sort",
+      run_merge(
+          [&] {
+            libremidi::midi_track all;
+            for (const auto& track : r.tracks)
+              all.insert(all.end(), track.begin(), track.end());
+            std::ranges::stable_sort(all, {}, &libremidi::track_event::tick);
+            return all.size();
+          },
+          iterations));
+
+  const auto is_loud_note = [](uint8_t status, uint8_t, uint8_t velocity) {
+    return (status & 0xF0) == 0x90 && velocity > 90;
+  };
+  const auto cols = r.columns();
+  std::printf("%-12s %10s\n", "scan", "ms/scan");
+  std::printf(
+      "%-12s %10.2f\n", "columns", run_merge([&] { return r.columns().size(); }, iterations));
+  std::printf(
+      "%-12s %10.3f\n", "tracks",
+      run_merge(
+          [&] {
+            std::size_t n = 0;
+            for (const auto& track : r.tracks)
+              for (const auto& ev : track)
+                n += ev.m.size() == 3 && is_loud_note(ev.m.bytes[0], 0, ev.m.bytes[2]);
+            return n + 1;
+          },
+          iterations));
+  std::printf(
+      "%-12s %10.3f\n", "count",
+      run_merge([&] { return cols.count(is_loud_note) + 1; }, iterations));
+  std::printf(
+      "%-12s %10.3f\n", "select",
+      run_merge([&] { return cols.select(is_loud_note).size() + 1; }, iterations));
+}
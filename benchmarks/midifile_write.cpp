@@ -0,0 +1,103 @@
+// Measures the serialization of a large multi-track file through an ostream,
+// into a vector, and into a reused buffer, with and without running status,
+// then into a reused buffer with one thread per core.
+// Finally, the same events with absolute ticks, in order and in reverse order.
+
+#include <libremidi/writer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <span>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+libremidi::writer generate_file(int tracks, int notes_per_track)
+{
+  libremidi::writer w;
+  for (int t = 0; t < tracks; t++)
+  {
+    for (int n = 0; n < notes_per_track; n++)
+    {
+      const auto note = uint8_t(36 + (n + t) % 48);
+      w.add_event(10, t, libremidi::channel_events::note_on(1 + t % 16, note, 100));
+      w.add_event(10, t, libremidi::channel_events::note_on(1 + t % 16, note, 0));
+    }
+  }
+  return w;
+}
+
+template <typename F>
+double run(F&& f, int iterations)
+{
+  std::size_t size = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+    size += f();
+  const auto t1 = std::chrono::steady_clock::now();
+  if (size == 0)
+    std::fprintf(stderr, "nothing written\n");
+  return std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+}
+}
+
+int main()
+{
+  auto w = generate_file(64, 20000);
+  constexpr int iterations = 10;
+
+  std::vector<uint8_t> buffer;
+  std::printf("%-10s %-16s %10s %10s\n", "status", "output", "bytes", "ms/write");
+  for (bool running : {false, true})
+  {
+    w.runningStatus = running;
+    const char* status = running ? "running" : "full";
+    const auto size = w.encoded_size();
+    buffer.resize(size);
+
+    const double stream = run(
+        [&] {
+          std::stringstream str;
+          w.write(str);
+          return std::size_t(str.tellp());
+        },
+        iterations);
+    const double vector = run(
+        [&] {
+          std::vector<uint8_t> bytes;
+          w.write_to(bytes);
+          return bytes.size();
+        },
+        iterations);
+    const double span = run([&] { return w.write_to(std::span{buffer}); }, iterations);
+
+    std::printf("%-10s %-16s %10zu %10.2f\n", status, "ostream", size, stream);
+    std::printf("%-10s %-16s %10zu %10.2f\n", status, "vector", size, vector);
+    std::printf("%-10s %-16s %10zu %10.2f\n", status, "reused buffer", size, span);
+
+    w.threadCount = 0;
+    const double parallel = run([&] { return w.write_to(std::span{buffer}); }, iterations);
+    w.threadCount = 1;
+    std::printf("%-10s %-16s %10zu %10.2f\n", status, "all threads", size, parallel);
+  }
+
+  // Same events with absolute ticks
+  w.runningStatus = false;
+  w.useAbsoluteTicks = true;
+  for (auto& track : w.tracks)
+  {
+    int tick = 0;
+    for (auto& ev : track)
+      ev.tick = (tick += ev.tick);
+  }
+  buffer.resize(w.encoded_size());
+  const double in_order = run([&] { return w.write_to(std::span{buffer}); }, iterations);
+  std::printf("%-10s %-16s %10zu %10.2f\n", "absolute", "in order", buffer.size(), in_order);
+
+  for (auto& track : w.tracks)
+    std::ranges::reverse(track);
+  const double reversed = run([&] { return w.write_to(std::span{buffer}); }, iterations);
+  std::printf("%-10s %-16s %10zu %10.2f\n", "absolute", "reversed", buffer.size(), reversed);
+}
@@ -0,0 +1,126 @@
+// Measures the cold start of a back-end: loading its libraries, resolving their symbols,
+// creating the first objects and enumerating the ports for the first time.
+// Only the first run in a process is cold: run it once per back-end, e.g.
+//   startup_benchmark alsa_seq
+// Without argument the default back-end is used, as picked by the default constructors.
+
+#include <libremidi/libremidi.hpp>
+#include <libremidi/startup_profile.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace
+{
+const char* phase_name(libremidi::startup_phase p)
+{
+  switch (p)
+  {
+    case libremidi::startup_phase::library_load:
+      return "library load";
+    case libremidi::startup_phase::symbol_resolution:
+      return "symbol resolution";
+    case libremidi::startup_phase::client_creation:
+      return "client creation";
+    case libremidi::startup_phase::first_enumeration:
+      return "first enumeration";
+  }
+  return "";
+}
+
+struct step
+{
+  std::string name;
+  std::chrono::nanoseconds duration;
+};
+
+template <typename F>
+step measure(std::string name, F&& f)
+{
+  const auto t0 = std::chrono::steady_clock::now();
+  f();
+  const auto t1 = std::chrono::steady_clock::now();
+  return {std::move(name), std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0)};
+}
+
+std::vector<step> run(const libremidi::API* api)
+{
+  std::vector<step> steps;
+  if (api)
+  {
+    steps.push_back(measure("observer", [&] {
+      libremidi::observer obs{{}, libremidi::observer_configuration_for(*api)};
+      (void)obs.get_input_ports();
+      (void)obs.get_output_ports();
+    }));
+    steps.push_back(measure("midi_in", [&] {
+      libremidi::midi_in in{
+          {.on_message = [](const libremidi::message&) {}},
+          libremidi::midi_in_configuration_for(*api)};
+    }));
+    steps.push_back(measure("midi_out", [&] {
+      libremidi::midi_out out{{}, libremidi::midi_out_configuration_for(*api)};
+    }));
+  }
+  else
+  {
+    steps.push_back(measure("observer", [] {
+      libremidi::observer obs;
+      (void)obs.get_input_ports();
+      (void)obs.get_output_ports();
+    }));
+    steps.push_back(measure("midi_in", [] {
+      libremidi::midi_in in{{.on_message = [](const libremidi::message&) {}}};
+    }));
+    steps.push_back(measure("midi_out", [] { libremidi::midi_out out{}; }));
+  }
+  return steps;
+}
+
+void print(const char* title, const std::vector<step>& steps)
+{
+  std::printf("%s\n", title);
+  for (const auto& s : steps)
+    std::printf("  %-32s %12.1f us\n", s.name.c_str(), s.duration.count() / 1000.);
+}
+}
+
+int main(int argc, char** argv)
+{
+  std::mutex mtx;
+  std::vector<libremidi::startup_event> events;
+  libremidi::set_startup_profiler([&](const libremidi::startup_event& e) {
+    std::lock_guard _{mtx};
+    events.push_back(e);
+  });
+
+  libremidi::API api{};
+  if (argc > 1)
+  {
+    api = libremidi::get_compiled_api_by_name(argv[1]);
+    if (api == libremidi::API::UNSPECIFIED)
+    {
+      std::fprintf(stderr, "Unknown API: %s\n", argv[1]);
+      return 1;
+    }
+  }
+
+  const auto cold = run(argc > 1 ? &api : nullptr);
+  {
+    std::lock_guard _{mtx};
+    std::printf("Startup phases\n");
+    for (const auto& e : events)
+      std::printf(
+          "  %-18s %-24.*s %10.1f us\n", phase_name(e.phase), int(e.backend.size()),
+          e.backend.data(), e.duration.count() / 1000.);
+  }
+
+  libremidi::set_startup_profiler({});
+  const auto warm = run(argc > 1 ? &api : nullptr);
+
+  print("Cold", cold);
+  print("Warm", warm);
+}
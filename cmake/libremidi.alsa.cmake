@@ -3,6 +3,15 @@ find_package(ALSA)
 check_include_file_cxx("sys/eventfd.h" LIBREMIDI_HAS_EVENTFD)
 check_include_file_cxx("sys/timerfd.h" LIBREMIDI_HAS_TIMERFD)
 
+## Direct RawMIDI support: only needs the kernel headers ##
+if(NOT LIBREMIDI_NO_ALSA_RAW_DIRECT)
+  check_include_file_cxx("sound/asound.h" LIBREMIDI_HAS_SOUND_ASOUND_H)
+  if(LIBREMIDI_HAS_SOUND_ASOUND_H AND LIBREMIDI_HAS_EVENTFD)
+    message(STATUS "libremidi: using direct RawMIDI (experimental)")
+    target_compile_definitions(libremidi ${_public} LIBREMIDI_ALSA_RAW_DIRECT)
+  endif()
+endif()
+
 if(ALSA_FOUND AND LIBREMIDI_HAS_EVENTFD AND LIBREMIDI_HAS_TIMERFD)
   set(LIBREMIDI_HAS_ALSA 1)
 
@@ -0,0 +1,12 @@
+macro(add_benchmark _benchmark)
+  add_executable(${_benchmark}_benchmark benchmarks/${_benchmark}.cpp)
+  target_link_libraries(${_benchmark}_benchmark PRIVATE libremidi)
+endmacro()
+
+add_benchmark(loopback)
+add_benchmark(startup)
+add_benchmark(alsa_raw_direct)
+add_benchmark(midifile_read)
+add_benchmark(midifile_corpus)
+add_benchmark(midifile_write)
+target_compile_definitions(midifile_corpus_benchmark PRIVATE "LIBREMIDI_TEST_CORPUS=\"${CMAKE_CURRENT_SOURCE_DIR}/tests/corpus\"")
@@ -15,6 +15,7 @@ endmacro()
 add_example(midiobserve)
 add_example(echo)
 add_example(cmidiin)
+add_example(midifile_record)
 add_example(midiclock_in)
 add_example(midiclock_out)
 add_example(midiout)
@@ -11,6 +11,15 @@ target_sources(libremidi PRIVATE
     include/libremidi/backends/alsa_raw/midi_in.hpp
     include/libremidi/backends/alsa_raw/midi_out.hpp
     include/libremidi/backends/alsa_raw/observer.hpp
+    include/libremidi/backends/alsa_raw/shared_handler.hpp
+
+    include/libremidi/backends/alsa_raw_direct/config.hpp
+    include/libremidi/backends/alsa_raw_direct/helpers.hpp
+    include/libremidi/backends/alsa_raw_direct/io_uring.hpp
+    include/libremidi/backends/alsa_raw_direct/midi_in.hpp
+    include/libremidi/backends/alsa_raw_direct/midi_out.hpp
+    include/libremidi/backends/alsa_raw_direct/observer.hpp
+    include/libremidi/backends/alsa_raw_direct/reactor.hpp
 
     include/libremidi/backends/alsa_raw_ump/config.hpp
     include/libremidi/backends/alsa_raw_ump/helpers.hpp
@@ -49,6 +58,12 @@ target_sources(libremidi PRIVATE
     include/libremidi/backends/pipewire/observer.hpp
     include/libremidi/backends/pipewire/shared_handler.hpp
 
+    include/libremidi/backends/loopback/config.hpp
+    include/libremidi/backends/loopback/context.hpp
+    include/libremidi/backends/loopback/midi_in.hpp
+    include/libremidi/backends/loopback/midi_out.hpp
+    include/libremidi/backends/loopback/observer.hpp
+
     include/libremidi/backends/linux/alsa.hpp
     include/libremidi/backends/linux/dylib_loader.hpp
     include/libremidi/backends/linux/helpers.hpp
@@ -87,43 +102,65 @@ target_sources(libremidi PRIVATE
     include/libremidi/backends/alsa_seq.hpp
     include/libremidi/backends/alsa_seq_ump.hpp
     include/libremidi/backends/alsa_raw.hpp
+    include/libremidi/backends/alsa_raw_direct.hpp
     include/libremidi/backends/alsa_raw_ump.hpp
     include/libremidi/backends/coremidi.hpp
     include/libremidi/backends/coremidi_ump.hpp
     include/libremidi/backends/dummy.hpp
     include/libremidi/backends/emscripten.hpp
+    include/libremidi/backends/loopback.hpp
     include/libremidi/backends/jack.hpp
     include/libremidi/backends/winmm.hpp
     include/libremidi/backends/winuwp.hpp
 
+    include/libremidi/detail/mapped_file.hpp
     include/libremidi/detail/memory.hpp
     include/libremidi/detail/midi_api.hpp
     include/libremidi/detail/midi_in.hpp
     include/libremidi/detail/midi_out.hpp
     include/libremidi/detail/midi_stream_decoder.hpp
     include/libremidi/detail/observer.hpp
+    include/libremidi/detail/parallel_for.hpp
+    include/libremidi/detail/port_cache.hpp
+    include/libremidi/detail/port_debouncer.hpp
+    include/libremidi/detail/port_registry.hpp
     include/libremidi/detail/semaphore.hpp
+    include/libremidi/detail/spsc_byte_queue.hpp
+    include/libremidi/detail/smf_encoding.hpp
+    include/libremidi/detail/startup_profile.hpp
+    include/libremidi/detail/thread_policy.hpp
     include/libremidi/detail/ump_stream.hpp
 
     include/libremidi/api.hpp
+    include/libremidi/batch_reader.hpp
     include/libremidi/client.hpp
     include/libremidi/client.cpp
+    include/libremidi/clip_file.hpp
+    include/libremidi/columnar_tracks.hpp
     include/libremidi/config.hpp
     include/libremidi/configurations.hpp
     include/libremidi/error.hpp
     include/libremidi/error_handler.hpp
     include/libremidi/input_configuration.hpp
     include/libremidi/libremidi.hpp
+    include/libremidi/merged_tracks.hpp
     include/libremidi/message.hpp
     include/libremidi/output_configuration.hpp
+    include/libremidi/startup_profile.hpp
+    include/libremidi/tempo_map.hpp
+    include/libremidi/thread_policy.hpp
 
     include/libremidi/reader.hpp
+    include/libremidi/recorder.hpp
     include/libremidi/writer.hpp
 
+    include/libremidi/batch_reader.cpp
+    include/libremidi/clip_file.cpp
     include/libremidi/libremidi.cpp
     include/libremidi/midi_in.cpp
     include/libremidi/midi_out.cpp
     include/libremidi/observer.cpp
     include/libremidi/reader.cpp
+    include/libremidi/recorder.cpp
     include/libremidi/writer.cpp
 )
@@ -24,6 +24,9 @@ target_link_libraries(midiin_test PRIVATE libremidi Catch2::Catch2WithMain)
 add_executable(midiout_test tests/unit/midi_out.cpp)
 target_link_libraries(midiout_test PRIVATE libremidi Catch2::Catch2WithMain)
 
+add_executable(observer_test tests/unit/observer.cpp)
+target_link_libraries(observer_test PRIVATE libremidi Catch2::Catch2WithMain)
+
 add_executable(midifile_read_test tests/unit/midifile_read.cpp)
 target_link_libraries(midifile_read_test PRIVATE libremidi Catch2::Catch2WithMain)
 target_compile_definitions(midifile_read_test PRIVATE "LIBREMIDI_TEST_CORPUS=\"${CMAKE_CURRENT_SOURCE_DIR}/tests/corpus\"")
@@ -32,6 +35,9 @@ add_executable(midifile_write_test tests/unit/midifile_write.cpp)
 target_link_libraries(midifile_write_test PRIVATE libremidi Catch2::Catch2WithMain)
 target_compile_definitions(midifile_write_test PRIVATE "LIBREMIDI_TEST_CORPUS=\"${CMAKE_CURRENT_SOURCE_DIR}/tests/corpus\"")
 
+add_executable(clip_file_test tests/unit/clip_file.cpp)
+target_link_libraries(clip_file_test PRIVATE libremidi Catch2::Catch2WithMain)
+
 add_executable(midifile_write_tracks_test tests/integration/midifile_write_tracks.cpp)
 target_link_libraries(midifile_write_tracks_test PRIVATE libremidi Catch2::Catch2WithMain)
 
@@ -39,6 +45,8 @@ include(CTest)
 add_test(NAME error_test COMMAND error_test)
 add_test(NAME midiin_test COMMAND midiin_test)
 add_test(NAME midiout_test COMMAND midiout_test)
+add_test(NAME observer_test COMMAND observer_test)
 add_test(NAME midifile_read_test COMMAND midifile_read_test)
 add_test(NAME midifile_write_test COMMAND midifile_write_test)
+add_test(NAME clip_file_test COMMAND clip_file_test)
 add_test(NAME midifile_write_tracks_test COMMAND midifile_write_tracks_test)
@@ -1,8 +1,8 @@
 #include <libremidi/reader.hpp>
 
-#include <fstream>
+#include <cmath>
 #include <iomanip>
-#include <istream>
+#include <iostream>
 #include <vector>
 
 int main(int argc, char** argv)
@@ -13,22 +13,11 @@ int main(int argc, char** argv)
     return 1;
   }
 
-  // Read raw from a MIDI file
-  std::ifstream file{argv[1], std::ios::binary};
-  if (!file.is_open())
-  {
-    std::cerr << "Could not open " << argv[1] << std::endl;
-    return 1;
-  }
-
-  std::vector<uint8_t> bytes;
-  bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
-
   // Initialize our reader object
   libremidi::reader r{true};
 
-  // Parse
-  libremidi::reader::parse_result result = r.parse(bytes);
+  // Parse the file, which is mapped in memory instead of being read in a buffer
+  libremidi::reader::parse_result result = r.parse_file(argv[1]);
 
   switch (result)
   {
@@ -0,0 +1,52 @@
+// Records the messages of a MIDI input to a MIDI file, until <enter> is pressed.
+// The file is written as the messages arrive: if the program is interrupted,
+// libremidi::smf_recorder::recover makes the file valid again.
+
+#include "utils.hpp"
+
+#include <libremidi/libremidi.hpp>
+#include <libremidi/recorder.hpp>
+
+#include <cstdlib>
+#include <iostream>
+
+int main(int argc, char** argv)
+try
+{
+  if (argc < 2)
+  {
+    std::cout << "\nusage: midifile_record <file.mid>\n\n";
+    return EXIT_FAILURE;
+  }
+
+  libremidi::smf_recorder recorder;
+  if (!recorder.open(argv[1]))
+  {
+    std::cerr << "Could not create " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  libremidi::midi_in midiin{{
+      .on_message = recorder.callback(),
+      .ignore_sysex = false,
+  }};
+
+  if (chooseMidiPort(midiin) == false)
+    return 0;
+
+  std::cout << "\nRecording MIDI input ... press <enter> to quit.\n";
+  int c;
+  while ((c = getchar()) != '\n' && c != EOF)
+    ;
+
+  midiin.close_port();
+  if (!recorder.close())
+    std::cerr << "Could not write " << argv[1] << std::endl;
+  if (recorder.dropped() > 0)
+    std::cerr << recorder.dropped() << " messages were dropped" << std::endl;
+}
+catch (const std::exception& error)
+{
+  std::cerr << error.what() << std::endl;
+  return EXIT_FAILURE;
+}
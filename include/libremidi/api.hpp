@@ -29,6 +29,9 @@ enum class API
   COREMIDI_UMP,          /*!< macOS CoreMidi API for MIDI 2.0. Requires macOS 11+ */
   WINDOWS_MIDI_SERVICES, /*!< Windows API for MIDI 2.0. Requires Windows 11 */
 
+  LOOPBACK,        /*!< In-process loopback API, for testing and benchmarking */
+  ALSA_RAW_DIRECT, /*!< Experimental Linux RawMIDI API without alsa-lib, based on io_uring */
+
   DUMMY /*!< A compilable but non-functional API. */
 };
 
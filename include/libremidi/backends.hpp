@@ -55,6 +55,11 @@
 #endif
 
 #include <libremidi/backends/dummy.hpp>
+#include <libremidi/backends/loopback.hpp>
+
+#if defined(LIBREMIDI_ALSA_RAW_DIRECT)
+  #include <libremidi/backends/alsa_raw_direct.hpp>
+#endif
 
 namespace libremidi
 {
@@ -103,7 +108,15 @@ static constexpr auto available_backends = make_tl(
     pipewire::backend{}
 #endif
     ,
-    dummy_backend{});
+    dummy_backend{}
+    // Backends after the dummy one are never picked by the automatic API search
+    ,
+    loopback::backend{}
+#if defined(LIBREMIDI_ALSA_RAW_DIRECT)
+    ,
+    alsa_raw_direct::backend{}
+#endif
+);
 
 // There should always be at least one back-end.
 static_assert(std::tuple_size_v<decltype(available_backends)> >= 1);
@@ -114,6 +127,15 @@ auto for_all_backends(F&& f)
   std::apply([&](auto&&... x) { ((x.available() && (f(x), true)), ...); }, available_backends);
 }
 
+//! Stops at the first available back-end for which f returns true:
+//! the libraries of the following back-ends are not loaded.
+template <typename F>
+bool for_first_backend(F&& f)
+{
+  return std::apply(
+      [&](auto&&... x) { return ((x.available() && f(x)) || ...); }, available_backends);
+}
+
 template <typename F>
 auto for_backend(libremidi::API api, F&& f)
 {
@@ -25,7 +25,7 @@ struct backend
   static inline bool available() noexcept
   {
     static const libasound& snd = libasound::instance();
-    return snd.available && snd.rawmidi.available;
+    return snd.available && snd.rawmidi->available;
   }
 };
 }
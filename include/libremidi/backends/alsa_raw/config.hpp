@@ -61,6 +61,10 @@ struct manual_poll_parameters
 struct alsa_raw_input_configuration
 {
   std::function<bool(const manual_poll_parameters&)> manual_poll;
+
+  //! Called when a port registered through manual_poll is closed, with the same descriptors.
+  //! Once it returns, the callback passed to manual_poll must not be invoked anymore.
+  std::function<bool(std::span<poll_descriptors>)> stop_poll;
 };
 
 struct alsa_raw_output_configuration
@@ -74,6 +78,8 @@ struct alsa_raw_output_configuration
 
 struct alsa_raw_observer_configuration
 {
+  //! Unused: hotplug is driven by the udev events, which are sent once the devices are ready.
+  //! Kept for source compatibility.
   std::chrono::milliseconds poll_period{100};
 };
 }
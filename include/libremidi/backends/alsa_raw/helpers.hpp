@@ -71,7 +71,7 @@ struct snd_ctl_wrapper
   {
     if (ctl)
     {
-      snd.ctl.close(ctl);
+      snd.ctl->close(ctl);
     }
   }
 
@@ -102,11 +102,11 @@ struct enumerator
     snd_rawmidi_info_t* info;
 
     snd_rawmidi_info_alloca(&info);
-    snd.rawmidi.info_set_device(info, device);
-    snd.rawmidi.info_set_subdevice(info, sub);
-    snd.rawmidi.info_set_stream(info, stream);
+    snd.rawmidi->info_set_device(info, device);
+    snd.rawmidi->info_set_subdevice(info, sub);
+    snd.rawmidi->info_set_stream(info, stream);
 
-    const int status = snd.ctl.rawmidi.info(ctl, info);
+    const int status = snd.ctl->rawmidi->info(ctl, info);
     if (status == 0)
     {
       return 1;
@@ -137,7 +137,7 @@ struct enumerator
   std::string get_card_name(int card)
   {
     char* card_name{};
-    snd.card.get_name(card, &card_name);
+    snd.card->get_name(card, &card_name);
 
     std::string str = card_name;
     free(card_name);
@@ -162,7 +162,7 @@ struct enumerator
     using namespace std::literals;
     int card = -1;
 
-    int status = snd.card.next(&card);
+    int status = snd.card->next(&card);
     if (status < 0)
     {
       handler.libremidi_handle_error(
@@ -180,7 +180,7 @@ struct enumerator
     {
       enumerate_devices(card);
 
-      if ((status = snd.card.next(&card)) < 0)
+      if ((status = snd.card->next(&card)) < 0)
       {
         handler.libremidi_handle_error(
             configuration, "cannot determine card number: "s + snd.strerror(status));
@@ -197,7 +197,7 @@ inline snd_ctl_wrapper::snd_ctl_wrapper(enumerator& self, const char* name)
     : snd{self.snd}
 {
   using namespace std::literals;
-  int status = snd.ctl.open(&ctl, name, 0);
+  int status = snd.ctl->open(&ctl, name, 0);
   if (status < 0)
   {
     self.handler.libremidi_handle_error(
@@ -225,7 +225,7 @@ struct midi1_enumerator : enumerator
     int device = -1;
     do
     {
-      const int status = snd.ctl.rawmidi.next_device(ctl, &device);
+      const int status = snd.ctl->rawmidi->next_device(ctl, &device);
       if (device == -1)
         return;
 
@@ -246,34 +246,34 @@ struct midi1_enumerator : enumerator
   {
     snd_rawmidi_info_t* info;
     snd_rawmidi_info_alloca(&info);
-    snd.rawmidi.info_set_device(info, device);
+    snd.rawmidi->info_set_device(info, device);
 
-    snd.rawmidi.info_set_stream(info, SND_RAWMIDI_STREAM_INPUT);
-    snd.ctl.rawmidi.info(ctl, info);
-    const int subs_in = snd.rawmidi.info_get_subdevices_count(info);
+    snd.rawmidi->info_set_stream(info, SND_RAWMIDI_STREAM_INPUT);
+    snd.ctl->rawmidi->info(ctl, info);
+    const int subs_in = snd.rawmidi->info_get_subdevices_count(info);
 
-    snd.rawmidi.info_set_stream(info, SND_RAWMIDI_STREAM_OUTPUT);
-    snd.ctl.rawmidi.info(ctl, info);
-    const int subs_out = snd.rawmidi.info_get_subdevices_count(info);
+    snd.rawmidi->info_set_stream(info, SND_RAWMIDI_STREAM_OUTPUT);
+    snd.ctl->rawmidi->info(ctl, info);
+    const int subs_out = snd.rawmidi->info_get_subdevices_count(info);
 
     alsa_raw_port_info d;
     d.card = card;
     d.dev = device;
     d.card_name = get_card_name(card);
-    d.device_name = snd.rawmidi.info_get_name(info);
+    d.device_name = snd.rawmidi->info_get_name(info);
 
     auto read_subdevice_info = [&](int sub) {
-      snd.rawmidi.info_set_subdevice(info, sub);
-      snd.ctl.rawmidi.info(ctl, info);
+      snd.rawmidi->info_set_subdevice(info, sub);
+      snd.ctl->rawmidi->info(ctl, info);
 
       d.device = device_identifier(card, device, sub);
-      d.subdevice_name = snd.rawmidi.info_get_subdevice_name(info);
+      d.subdevice_name = snd.rawmidi->info_get_subdevice_name(info);
       d.sub = sub;
     };
 
     if (subs_in > 0)
     {
-      snd.rawmidi.info_set_stream(info, SND_RAWMIDI_STREAM_INPUT);
+      snd.rawmidi->info_set_stream(info, SND_RAWMIDI_STREAM_INPUT);
       for (int sub = 0; sub < subs_in; sub++)
       {
         read_subdevice_info(sub);
@@ -283,7 +283,7 @@ struct midi1_enumerator : enumerator
 
     if (subs_out > 0)
     {
-      snd.rawmidi.info_set_stream(info, SND_RAWMIDI_STREAM_OUTPUT);
+      snd.rawmidi->info_set_stream(info, SND_RAWMIDI_STREAM_OUTPUT);
       for (int sub = 0; sub < subs_out; sub++)
       {
         read_subdevice_info(sub);
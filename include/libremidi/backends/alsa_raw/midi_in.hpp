@@ -4,6 +4,7 @@
 #include <libremidi/backends/linux/helpers.hpp>
 #include <libremidi/detail/midi_in.hpp>
 #include <libremidi/detail/midi_stream_decoder.hpp>
+#include <libremidi/detail/thread_policy.hpp>
 
 #include <alsa/asoundlib.h>
 
@@ -39,7 +40,7 @@ public:
   [[nodiscard]] stdx::error do_init_port(const char* portname)
   {
     constexpr int mode = SND_RAWMIDI_NONBLOCK;
-    if (const int err = snd.rawmidi.open(&midiport_, nullptr, portname, mode); err < 0)
+    if (const int err = snd.rawmidi->open(&midiport_, nullptr, portname, mode); err < 0)
     {
       libremidi_handle_error(this->configuration, "cannot open device.");
       return from_errc(err);
@@ -48,36 +49,36 @@ public:
     snd_rawmidi_params_t* params{};
     snd_rawmidi_params_alloca(&params);
 
-    if (const int err = snd.rawmidi.params_current(midiport_, params); err < 0)
+    if (const int err = snd.rawmidi->params_current(midiport_, params); err < 0)
       return from_errc(err);
-    if (const int err = snd.rawmidi.params_set_no_active_sensing(midiport_, params, 1); err < 0)
+    if (const int err = snd.rawmidi->params_set_no_active_sensing(midiport_, params, 1); err < 0)
       return from_errc(err);
 #if LIBREMIDI_ALSA_HAS_RAWMIDI_TREAD
     if (configuration.timestamps == timestamp_mode::NoTimestamp)
     {
       if (const int err
-          = snd.rawmidi.params_set_read_mode(midiport_, params, SND_RAWMIDI_READ_STANDARD);
+          = snd.rawmidi->params_set_read_mode(midiport_, params, SND_RAWMIDI_READ_STANDARD);
           err < 0)
         return from_errc(err);
       if (const int err
-          = snd.rawmidi.params_set_clock_type(midiport_, params, SND_RAWMIDI_CLOCK_NONE);
+          = snd.rawmidi->params_set_clock_type(midiport_, params, SND_RAWMIDI_CLOCK_NONE);
           err < 0)
         return from_errc(err);
     }
     else
     {
       if (const int err
-          = snd.rawmidi.params_set_read_mode(midiport_, params, SND_RAWMIDI_READ_TSTAMP);
+          = snd.rawmidi->params_set_read_mode(midiport_, params, SND_RAWMIDI_READ_TSTAMP);
           err < 0)
         return from_errc(err);
       if (const int err
-          = snd.rawmidi.params_set_clock_type(midiport_, params, SND_RAWMIDI_CLOCK_MONOTONIC);
+          = snd.rawmidi->params_set_clock_type(midiport_, params, SND_RAWMIDI_CLOCK_MONOTONIC);
           err < 0)
         return from_errc(err);
     }
 #endif
 
-    if (const int err = snd.rawmidi.params(midiport_, params); err < 0)
+    if (const int err = snd.rawmidi->params(midiport_, params); err < 0)
       return from_errc(err);
 
     return init_pollfd();
@@ -90,12 +91,12 @@ public:
 
   [[nodiscard]] stdx::error init_pollfd()
   {
-    const int num_fds = snd.rawmidi.poll_descriptors_count(this->midiport_);
+    const int num_fds = snd.rawmidi->poll_descriptors_count(this->midiport_);
 
     this->fds_.clear();
     this->fds_.resize(num_fds);
 
-    int ret = snd.rawmidi.poll_descriptors(this->midiport_, fds_.data(), num_fds);
+    int ret = snd.rawmidi->poll_descriptors(this->midiport_, fds_.data(), num_fds);
     if (ret < 0)
       return from_errc(ret);
     return stdx::error{};
@@ -111,7 +112,7 @@ public:
     else
     {
       unsigned short res{};
-      const int err = snd.rawmidi.poll_descriptors_revents(
+      const int err = snd.rawmidi->poll_descriptors_revents(
           this->midiport_, fds.data(), static_cast<unsigned int>(fds.size()), &res);
       if (err < 0)
         return err;
@@ -141,7 +142,7 @@ public:
 
     ssize_t err = 0;
     // err is the amount of bytes read
-    while ((err = snd.rawmidi.read(this->midiport_, bytes, nbytes)) > 0)
+    while ((err = snd.rawmidi->read(this->midiport_, bytes, nbytes)) > 0)
     {
       const auto to_ns = [this] { return absolute_timestamp(); };
       decoder_.on_bytes({bytes, bytes + err}, decoder_.timestamp<timestamp_info>(to_ns, 0));
@@ -164,7 +165,7 @@ public:
 
     ssize_t err = 0;
     // err is the amount of bytes read
-    while ((err = snd.rawmidi.tread(this->midiport_, &ts, bytes, nbytes)) > 0)
+    while ((err = snd.rawmidi->tread(this->midiport_, &ts, bytes, nbytes)) > 0)
     {
       const auto to_ns = [ts] {
         return static_cast<int64_t>(ts.tv_sec) * 1'000'000'000 + static_cast<int64_t>(ts.tv_nsec);
@@ -180,7 +181,7 @@ public:
   stdx::error close_port() override
   {
     if (midiport_)
-      snd.rawmidi.close(midiport_);
+      snd.rawmidi->close(midiport_);
     midiport_ = nullptr;
     return stdx::error{};
   }
@@ -218,6 +219,7 @@ public:
 private:
   void run_thread(auto parse_func)
   {
+    apply_thread_policy(this->configuration.threading, "alsa_raw input");
     fds_.push_back(this->termination_event);
 
     for (;;)
@@ -334,6 +336,14 @@ private:
     send_poll_callback();
     return stdx::error{};
   }
+
+  stdx::error close_port() override
+  {
+    if (midiport_ && configuration.stop_poll)
+      configuration.stop_poll({this->fds_.data(), this->fds_.size()});
+
+    return midi_in_impl::close_port();
+  }
 };
 }
 
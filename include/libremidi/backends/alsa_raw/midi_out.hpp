@@ -41,7 +41,7 @@ public:
   stdx::error connect_port(const char* portname)
   {
     constexpr int mode = SND_RAWMIDI_SYNC;
-    int status = snd.rawmidi.open(NULL, &midiport_, portname, mode);
+    int status = snd.rawmidi->open(NULL, &midiport_, portname, mode);
     if (status < 0)
     {
       libremidi_handle_error(
@@ -59,7 +59,7 @@ public:
   stdx::error close_port() override
   {
     if (midiport_)
-      snd.rawmidi.close(midiport_);
+      snd.rawmidi->close(midiport_);
     midiport_ = nullptr;
 
     return stdx::error{};
@@ -85,7 +85,7 @@ public:
 
   stdx::error write(const unsigned char* message, size_t size)
   {
-    if (auto err = snd.rawmidi.write(midiport_, message, size); err < 0)
+    if (auto err = snd.rawmidi->write(midiport_, message, size); err < 0)
     {
       libremidi_handle_error(
           this->configuration, "cannot write message.");
@@ -99,9 +99,9 @@ public:
   {
     snd_rawmidi_params_t* param;
     snd_rawmidi_params_alloca(&param);
-    snd.rawmidi.params_current(midiport_, param);
+    snd.rawmidi->params_current(midiport_, param);
 
-    std::size_t buffer_size = snd.rawmidi.params_get_buffer_size(param);
+    std::size_t buffer_size = snd.rawmidi->params_get_buffer_size(param);
     return std::min(buffer_size, (std::size_t)configuration.chunking->size);
   }
 
@@ -109,9 +109,9 @@ public:
   {
     snd_rawmidi_status_t* st{};
     snd_rawmidi_status_alloca(&st);
-    snd.rawmidi.status(midiport_, st);
+    snd.rawmidi->status(midiport_, st);
 
-    return snd.rawmidi.status_get_avail(st);
+    return snd.rawmidi->status_get_avail(st);
   }
 
   // inspired from ALSA amidi.c source code
@@ -7,9 +7,46 @@
   #include <libremidi/backends/linux/helpers.hpp>
   #include <libremidi/backends/linux/udev.hpp>
   #include <libremidi/detail/observer.hpp>
+  #include <libremidi/detail/thread_policy.hpp>
+
+  #include <algorithm>
+  #include <cstdio>
+  #include <limits>
+  #include <map>
 
 namespace libremidi::alsa_raw
 {
+//! What a udev event of the "sound" subsystem is about, from the name of the device:
+//! card1, controlC1, midiC1D0, umpC1D0, pcmC1D0p...
+struct sound_device_event
+{
+  enum class type
+  {
+    card,
+    rawmidi,
+    other
+  } kind{type::other};
+  int card{-1};
+  int device{-1};
+
+  static sound_device_event parse(const char* sysname) noexcept
+  {
+    sound_device_event ev;
+    if (!sysname)
+      return ev;
+    if (std::sscanf(sysname, "midiC%dD%d", &ev.card, &ev.device) == 2
+        || std::sscanf(sysname, "umpC%dD%d", &ev.card, &ev.device) == 2)
+      ev.kind = type::rawmidi;
+    else if (
+        std::sscanf(sysname, "controlC%d", &ev.card) == 1
+        || std::sscanf(sysname, "card%d", &ev.card) == 1)
+      ev.kind = type::card;
+    else
+      ev.card = -1;
+    return ev;
+  }
+};
+
 template <typename Enumerator>
 class observer_impl_base
     : public observer_api
@@ -33,11 +70,10 @@ public:
 
     fds[0] = this->udev;
     fds[1] = termination_event;
-    fds[2] = timer_fd;
 
-    // Set-up initial state
-    if (configuration.notify_in_constructor)
-      this->check_devices();
+    // Set-up initial state. The ports are indexed even if they are not notified,
+    // so that later events only report what changed.
+    this->rescan_all(configuration.notify_in_constructor);
 
     // Start thread
     thread = std::thread{[this] { this->run(); }};
@@ -78,11 +114,31 @@ public:
   }
 
 private:
+  // Ordered by port handle, thus by card then device:
+  // the ports of a card or of a device are a contiguous range.
+  using port_index = std::map<port_handle, alsa_raw_port_info>;
+  struct handle_range
+  {
+    port_handle first, last;
+  };
+
+  static constexpr handle_range card_range(int card) noexcept
+  {
+    return {raw_to_port_handle({card, 0, 0}), raw_to_port_handle({card + 1, 0, 0})};
+  }
+
+  static constexpr handle_range device_range(int card, int device) noexcept
+  {
+    return {raw_to_port_handle({card, device, 0}), raw_to_port_handle({card, device + 1, 0})};
+  }
+
   void run()
   {
+    apply_thread_policy(this->configuration.threading, "alsa_raw observer");
+
     for (;;)
     {
-      if (int err = poll(fds, 3, -1); err < 0)
+      if (int err = poll(fds, 2, -1); err < 0)
       {
         if (err == -EAGAIN)
           continue;
@@ -90,46 +146,57 @@ private:
           return;
       }
 
+      // Check eventfd
+      if (fds[1].revents & POLLIN)
+        break;
+
       // Check udev
       if (fds[0].revents & POLLIN)
       {
-        udev_device* dev = udev.udev.monitor_receive_device(udev.monitor);
-        if (!dev)
-          continue;
-
-        std::string_view act = udev.udev.device_get_action(dev);
-        std::string_view ss = udev.udev.device_get_subsystem(dev);
-        if (!act.empty() && ss == "snd_seq")
-        {
-          if (act == "add" || act == "remove")
-          {
-            // Check every 100 milliseconds for ten seconds
-            this->timer_fd.restart(configuration.poll_period.count());
-            timer_check_counts = 100;
-          }
-        }
-
-        udev.udev.device_unref(dev);
-
+        process_udev_events();
         fds[0].revents = 0;
       }
+    }
+  }
 
-      // Check eventfd
-      if (fds[1].revents & POLLIN)
+  // udev only sends an event once the device node is created and its rules applied:
+  // when a rawmidi node is announced it can be opened right away.
+  // A card coming with multiple nodes sends a burst of events, which are all read
+  // before rescanning, so that each card is enumerated at most once.
+  void process_udev_events()
+  {
+    std::vector<int> to_rescan;
+    while (udev_device* dev = udev.udev.monitor_receive_device(udev.monitor))
+    {
+      const char* action = udev.udev.device_get_action(dev);
+      const auto ev = sound_device_event::parse(udev.udev.device_get_sysname(dev));
+      const std::string_view act = action ? action : "";
+
+      if (ev.kind == sound_device_event::type::rawmidi && (act == "add" || act == "change"))
       {
-        break;
+        to_rescan.push_back(ev.card);
       }
-
-      // Check timer
-      if (fds[2].revents & POLLIN)
+      else if (ev.kind == sound_device_event::type::card && act == "change")
       {
-        if (this->timer_check_counts-- <= 0)
-          this->timer_fd.cancel();
-        fds[2].revents = 0;
-
-        check_devices();
+        // Sent by udev once all the devices of a card are ready
+        if (udev.udev.device_get_property_value(dev, "SOUND_INITIALIZED"))
+          to_rescan.push_back(ev.card);
+      }
+      else if (act == "remove" && ev.kind != sound_device_event::type::other)
+      {
+        // Nothing to enumerate: the index says which ports were there
+        forget(ev.kind == sound_device_event::type::card ? card_range(ev.card)
+                                                   : device_range(ev.card, ev.device));
+        std::erase(to_rescan, ev.card);
       }
+
+      udev.udev.device_unref(dev);
     }
+
+    std::sort(to_rescan.begin(), to_rescan.end());
+    to_rescan.erase(std::unique(to_rescan.begin(), to_rescan.end()), to_rescan.end());
+    for (int card : to_rescan)
+      rescan_card(card);
   }
 
   template <bool Input>
@@ -145,72 +212,107 @@ private:
          .display_name = p.subdevice_name}};
   }
 
-  void check_devices()
+  template <bool Input>
+  void notify_added(const alsa_raw_port_info& p)
   {
-    Enumerator new_devs{*this};
-
-    new_devs.enumerate_cards();
+    if constexpr (Input)
+    {
+      if (auto& cb = this->configuration.input_added)
+        cb(to_port_info<true>(p));
+    }
+    else
+    {
+      if (auto& cb = this->configuration.output_added)
+        cb(to_port_info<false>(p));
+    }
+  }
 
-    for (auto& in_prev : current_inputs)
+  template <bool Input>
+  void notify_removed(const alsa_raw_port_info& p)
+  {
+    if constexpr (Input)
     {
-      if (auto it = std::find(new_devs.inputs.begin(), new_devs.inputs.end(), in_prev);
-          it == new_devs.inputs.end())
-      {
-        if (auto& cb = this->configuration.input_removed)
-        {
-          cb(to_port_info<true>(in_prev));
-        }
-      }
+      if (auto& cb = this->configuration.input_removed)
+        cb(to_port_info<true>(p));
     }
+    else
+    {
+      if (auto& cb = this->configuration.output_removed)
+        cb(to_port_info<false>(p));
+    }
+  }
 
-    for (auto& in_next : new_devs.inputs)
+  // Replaces the ports of the index within the range by the fresh ones,
+  // and reports the differences
+  template <bool Input>
+  void update(
+      port_index& index, handle_range range, std::vector<alsa_raw_port_info>& fresh, bool notify)
+  {
+    port_index next;
+    for (auto& p : fresh)
     {
-      if (auto it = std::find(current_inputs.begin(), current_inputs.end(), in_next);
-          it == current_inputs.end())
-      {
-        if (auto& cb = this->configuration.input_added)
-        {
-          cb(to_port_info<true>(in_next));
-        }
-      }
+      const auto handle = raw_to_port_handle({p.card, p.dev, p.sub});
+      next.emplace(handle, std::move(p));
     }
 
-    for (auto& out_prev : current_outputs)
+    for (auto it = index.lower_bound(range.first);
+         it != index.end() && it->first < range.last;)
     {
-      if (auto it = std::find(new_devs.outputs.begin(), new_devs.outputs.end(), out_prev);
-          it == new_devs.outputs.end())
+      if (auto n = next.find(it->first); n != next.end() && n->second == it->second)
+      {
+        next.erase(n);
+        ++it;
+      }
+      else
       {
-        if (auto& cb = this->configuration.output_removed)
-        {
-          cb(to_port_info<false>(out_prev));
-        }
+        if (notify)
+          notify_removed<Input>(it->second);
+        it = index.erase(it);
       }
     }
 
-    for (auto& out_next : new_devs.outputs)
+    // Only new or changed ports are left
+    for (auto& [handle, p] : next)
     {
-      if (auto it = std::find(current_outputs.begin(), current_outputs.end(), out_next);
-          it == current_outputs.end())
-      {
-        if (auto& cb = this->configuration.output_added)
-        {
-          cb(to_port_info<false>(out_next));
-        }
-      }
+      if (notify)
+        notify_added<Input>(p);
+      index.insert_or_assign(handle, std::move(p));
     }
-    current_inputs = std::move(new_devs.inputs);
-    current_outputs = std::move(new_devs.outputs);
   }
 
-  udev_helper udev{};
+  void rescan_all(bool notify)
+  {
+    Enumerator devs{*this};
+    devs.enumerate_cards();
+
+    const handle_range all{0, std::numeric_limits<port_handle>::max()};
+    update<true>(current_inputs, all, devs.inputs, notify);
+    update<false>(current_outputs, all, devs.outputs, notify);
+  }
+
+  void rescan_card(int card)
+  {
+    Enumerator devs{*this};
+    devs.enumerate_devices(card);
+
+    update<true>(current_inputs, card_range(card), devs.inputs, true);
+    update<false>(current_outputs, card_range(card), devs.outputs, true);
+  }
+
+  void forget(handle_range range)
+  {
+    std::vector<alsa_raw_port_info> none;
+    update<true>(current_inputs, range, none, true);
+    update<false>(current_outputs, range, none, true);
+  }
+
+  udev_helper udev{"sound"};
   eventfd_notifier termination_event{};
-  timerfd_timer timer_fd{};
-  int timer_check_counts = 0;
   std::thread thread;
-  std::vector<alsa_raw_port_info> current_inputs;
-  std::vector<alsa_raw_port_info> current_outputs;
+  port_index current_inputs;
+  port_index current_outputs;
 
-  pollfd fds[3]{};
+  pollfd fds[2]{};
 };
 }
 #else
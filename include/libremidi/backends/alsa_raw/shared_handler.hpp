@@ -0,0 +1,227 @@
+#pragma once
+#include <libremidi/backends/alsa_raw/config.hpp>
+#include <libremidi/backends/linux/helpers.hpp>
+#include <libremidi/detail/thread_policy.hpp>
+#include <libremidi/shared_context.hpp>
+
+#include <sys/epoll.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace libremidi::alsa_raw
+{
+//! Reads every RawMIDI input from a single epoll loop instead of one thread per port.
+//! The loop can be split into multiple shards, each running on its own thread:
+//! ports are then distributed across shards in a round-robin fashion.
+struct shared_handler : public libremidi::shared_context
+{
+  explicit shared_handler(int threads = 1, thread_policy policy = {})
+      : policy{std::move(policy)}
+  {
+    const int N = std::max(threads, 1);
+    shards.reserve(N);
+    for (int i = 0; i < N; i++)
+      shards.push_back(std::make_unique<shard>());
+  }
+
+  ~shared_handler() { stop_processing(); }
+
+  void start_processing() override
+  {
+    for (auto& s : shards)
+      if (!s->thread.joinable())
+        s->thread = std::thread{[this, s = s.get()] {
+          apply_thread_policy(policy, "alsa_raw shared context");
+          s->process();
+        }};
+  }
+
+  void stop_processing() override
+  {
+    for (auto& s : shards)
+    {
+      s->termination_event.notify();
+      if (s->thread.joinable())
+        s->thread.join();
+      s->termination_event.consume();
+    }
+  }
+
+  static shared_configurations
+  make(std::string_view /*client_name*/, int threads = 1, thread_policy policy = {})
+  {
+    auto clt = std::make_shared<shared_handler>(threads, std::move(policy));
+
+    auto cb = [client = std::weak_ptr{clt}](const manual_poll_parameters& params) {
+      if (auto clt = client.lock())
+        return clt->add(params);
+      return false;
+    };
+
+    auto stop_cb = [client = std::weak_ptr{clt}](std::span<poll_descriptors> fds) {
+      if (auto clt = client.lock())
+        return clt->remove(fds);
+      return false;
+    };
+
+    return {
+        .context = clt,
+        .observer = alsa_raw_observer_configuration{},
+        .in = alsa_raw_input_configuration{.manual_poll = cb, .stop_poll = stop_cb},
+        .out = alsa_raw_output_configuration{},
+    };
+  }
+
+  bool add(const manual_poll_parameters& params)
+  {
+    if (params.fds.empty() || params.fds.size() > max_fds_per_port)
+      return false;
+
+    auto& s = *shards[next_shard.fetch_add(1, std::memory_order_relaxed) % shards.size()];
+    return s.add(params);
+  }
+
+  bool remove(std::span<poll_descriptors> fds)
+  {
+    if (fds.empty())
+      return false;
+
+    for (auto& s : shards)
+      if (s->remove(fds.front().fd))
+        return true;
+    return false;
+  }
+
+private:
+  // The low bits of the epoll user data identify the descriptor inside a port's set
+  static constexpr uint64_t fd_index_bits = 8;
+  static constexpr std::size_t max_fds_per_port = 1 << fd_index_bits;
+  static constexpr uint64_t termination_key = UINT64_MAX;
+
+  struct registration
+  {
+    std::vector<pollfd> fds;
+    std::function<int64_t(std::span<poll_descriptors>)> callback;
+  };
+
+  struct shard
+  {
+    shard()
+    {
+      epoll_event ev{.events = EPOLLIN, .data = {.u64 = termination_key}};
+      ::epoll_ctl(epfd, EPOLL_CTL_ADD, termination_event, &ev);
+    }
+
+    ~shard() { ::close(epfd); }
+
+    bool add(const manual_poll_parameters& params)
+    {
+      std::lock_guard _{mutex};
+      const uint64_t id = ++last_id;
+      auto reg = std::make_shared<registration>(
+          registration{{params.fds.begin(), params.fds.end()}, params.callback});
+
+      for (std::size_t i = 0; i < reg->fds.size(); i++)
+      {
+        // Edge-triggered: the midi_in objects always drain their port until EAGAIN
+        epoll_event ev{
+            .events = static_cast<uint32_t>(reg->fds[i].events) | EPOLLET,
+            .data = {.u64 = (id << fd_index_bits) | i}};
+        if (::epoll_ctl(epfd, EPOLL_CTL_ADD, reg->fds[i].fd, &ev) < 0)
+        {
+          for (std::size_t j = 0; j < i; j++)
+            ::epoll_ctl(epfd, EPOLL_CTL_DEL, reg->fds[j].fd, nullptr);
+          return false;
+        }
+      }
+
+      ports.emplace(id, std::move(reg));
+      return true;
+    }
+
+    // Once this returns, the port's callback is not running and will not be called anymore
+    bool remove(int first_fd)
+    {
+      std::lock_guard _{mutex};
+      auto it = std::find_if(ports.begin(), ports.end(), [=](const auto& p) {
+        return p.second->fds.front().fd == first_fd;
+      });
+      if (it == ports.end())
+        return false;
+
+      unregister(it);
+      return true;
+    }
+
+    void unregister(std::unordered_map<uint64_t, std::shared_ptr<registration>>::iterator it)
+    {
+      for (auto& pfd : it->second->fds)
+        ::epoll_ctl(epfd, EPOLL_CTL_DEL, pfd.fd, nullptr);
+      ports.erase(it);
+    }
+
+    void process()
+    {
+      epoll_event events[64];
+      for (;;)
+      {
+        const int n = ::epoll_wait(epfd, events, std::size(events), -1);
+        if (n < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          return;
+        }
+
+        std::lock_guard _{mutex};
+        for (int i = 0; i < n; i++)
+        {
+          const uint64_t key = events[i].data.u64;
+          if (key == termination_key)
+            return;
+
+          // The port may have been removed by a previous callback of this batch
+          auto it = ports.find(key >> fd_index_bits);
+          if (it == ports.end())
+            continue;
+
+          // Keeps the callback alive if it closes its own port
+          auto reg = it->second;
+          for (auto& pfd : reg->fds)
+            pfd.revents = 0;
+          const auto index = key & (max_fds_per_port - 1);
+          reg->fds[index].revents = static_cast<short>(events[i].events);
+
+          const auto err = reg->callback({reg->fds.data(), reg->fds.size()});
+          if (err < 0 && err != -EAGAIN)
+          {
+            // The port is in an unrecoverable state, stop listening to it
+            if (it = ports.find(key >> fd_index_bits); it != ports.end())
+              unregister(it);
+          }
+        }
+      }
+    }
+
+    int epfd = ::epoll_create1(EPOLL_CLOEXEC);
+    eventfd_notifier termination_event{};
+    std::thread thread;
+
+    // Recursive as ports can be closed from their own callback
+    std::recursive_mutex mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<registration>> ports;
+    uint64_t last_id{};
+  };
+
+  thread_policy policy;
+  std::vector<std::unique_ptr<shard>> shards;
+  std::atomic_size_t next_shard{};
+};
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <libremidi/backends/alsa_raw_direct/midi_in.hpp>
+#include <libremidi/backends/alsa_raw_direct/midi_out.hpp>
+#include <libremidi/backends/alsa_raw_direct/observer.hpp>
+
+//*********************************************************************//
+//  API: Linux RawMIDI, without alsa-lib
+//
+//  Experimental: talks to /dev/snd/midiC*D* directly, and reads every
+//  open input from a single io_uring.
+//*********************************************************************//
+
+namespace libremidi::alsa_raw_direct
+{
+struct backend
+{
+  using midi_in = alsa_raw_direct::midi_in_impl;
+  using midi_out = alsa_raw_direct::midi_out_impl;
+  using midi_observer = alsa_raw_direct::observer_impl;
+  using midi_in_configuration = alsa_raw_direct::input_configuration;
+  using midi_out_configuration = alsa_raw_direct::output_configuration;
+  using midi_observer_configuration = alsa_raw_direct::observer_configuration;
+  static const constexpr auto API = libremidi::API::ALSA_RAW_DIRECT;
+  static const constexpr auto name = "alsa_raw_direct";
+  static const constexpr auto display_name = "ALSA (raw, direct)";
+
+  static constexpr inline bool available() noexcept { return true; }
+};
+}
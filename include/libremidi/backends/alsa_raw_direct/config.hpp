@@ -0,0 +1,25 @@
+#pragma once
+#include <libremidi/config.hpp>
+
+#include <string>
+
+namespace libremidi::alsa_raw_direct
+{
+struct input_configuration
+{
+  //! If not empty, this file is read instead of the device node of the port passed to
+  //! open_port, e.g. a FIFO for testing. FIFOs are opened read-write so that they
+  //! do not reach end-of-file when the writer goes away.
+  std::string device_path;
+};
+
+struct output_configuration
+{
+  //! If not empty, this file is written to instead of the device node of the port
+  std::string device_path;
+};
+
+struct observer_configuration
+{
+};
+}
@@ -0,0 +1,174 @@
+#pragma once
+#include <libremidi/config.hpp>
+#include <libremidi/observer_configuration.hpp>
+
+#include <sound/asound.h>
+
+#include <sys/ioctl.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace libremidi::alsa_raw_direct
+{
+//! Same layout as the alsa_raw port handles
+struct device_id
+{
+  int card{};
+  int device{};
+  int subdevice{};
+};
+
+inline constexpr port_handle to_port_handle(device_id id) noexcept
+{
+  return (uint64_t(id.card) << 32) + (uint64_t(id.device) << 16) + uint64_t(id.subdevice);
+}
+
+inline constexpr device_id from_port_handle(port_handle p) noexcept
+{
+  return {
+      .card = int((p >> 32) & 0xFFFF),
+      .device = int((p >> 16) & 0xFFFF),
+      .subdevice = int(p & 0xFFFF)};
+}
+static_assert(from_port_handle(to_port_handle({12, 7, 3})).card == 12);
+static_assert(from_port_handle(to_port_handle({12, 7, 3})).device == 7);
+static_assert(from_port_handle(to_port_handle({12, 7, 3})).subdevice == 3);
+
+inline std::string control_path(int card)
+{
+  return "/dev/snd/controlC" + std::to_string(card);
+}
+
+inline std::string device_path(device_id id)
+{
+  return "/dev/snd/midiC" + std::to_string(id.card) + "D" + std::to_string(id.device);
+}
+
+//! RAII file descriptor
+struct unique_fd
+{
+  unique_fd() = default;
+  explicit unique_fd(int fd) noexcept
+      : fd{fd}
+  {
+  }
+  unique_fd(const unique_fd&) = delete;
+  unique_fd(unique_fd&& other) noexcept
+      : fd{std::exchange(other.fd, -1)}
+  {
+  }
+  unique_fd& operator=(const unique_fd&) = delete;
+  unique_fd& operator=(unique_fd&& other) noexcept
+  {
+    reset(std::exchange(other.fd, -1));
+    return *this;
+  }
+  ~unique_fd() { reset(); }
+
+  void reset(int new_fd = -1) noexcept
+  {
+    if (fd >= 0)
+      ::close(fd);
+    fd = new_fd;
+  }
+
+  explicit operator bool() const noexcept { return fd >= 0; }
+  operator int() const noexcept { return fd; }
+  int fd{-1};
+};
+
+//! Opens the device node of a RawMIDI subdevice, like snd_rawmidi_open does:
+//! the subdevice is selected through the control device of the card beforehand.
+inline int open_device(device_id id, int flags)
+{
+  unique_fd ctl{::open(control_path(id.card).c_str(), O_RDWR | O_CLOEXEC)};
+  if (!ctl)
+    return -errno;
+
+  int sub = id.subdevice;
+  if (::ioctl(ctl, SNDRV_CTL_IOCTL_RAWMIDI_PREFER_SUBDEVICE, &sub) < 0)
+    return -errno;
+
+  const int fd = ::open(device_path(id).c_str(), flags | O_CLOEXEC);
+  return fd >= 0 ? fd : -errno;
+}
+
+struct device_info
+{
+  device_id id;
+  std::string card_name;
+  std::string device_name;
+  std::string subdevice_name;
+};
+
+struct device_list
+{
+  std::vector<device_info> inputs;
+  std::vector<device_info> outputs;
+};
+
+//! Lists the RawMIDI subdevices with ioctls on the control devices of the cards,
+//! thus the same information as alsa-lib without loading it.
+inline device_list enumerate_devices()
+{
+  device_list ret;
+  for (int card = 0; card < 32; card++)
+  {
+    unique_fd ctl{::open(control_path(card).c_str(), O_RDONLY | O_CLOEXEC)};
+    if (!ctl)
+      continue;
+
+    snd_ctl_card_info card_info{};
+    if (::ioctl(ctl, SNDRV_CTL_IOCTL_CARD_INFO, &card_info) < 0)
+      continue;
+    const auto card_name = std::string(reinterpret_cast<const char*>(card_info.name));
+
+    int device = -1;
+    while (::ioctl(ctl, SNDRV_CTL_IOCTL_RAWMIDI_NEXT_DEVICE, &device) >= 0 && device >= 0)
+    {
+      for (int stream : {SNDRV_RAWMIDI_STREAM_INPUT, SNDRV_RAWMIDI_STREAM_OUTPUT})
+      {
+        snd_rawmidi_info info{};
+        info.device = static_cast<unsigned>(device);
+        info.subdevice = 0;
+        info.stream = stream;
+        if (::ioctl(ctl, SNDRV_CTL_IOCTL_RAWMIDI_INFO, &info) < 0)
+          continue;
+
+        auto& list = stream == SNDRV_RAWMIDI_STREAM_INPUT ? ret.inputs : ret.outputs;
+        const auto device_name = std::string(reinterpret_cast<const char*>(info.name));
+        for (unsigned sub = 0; sub < info.subdevices_count; sub++)
+        {
+          info.subdevice = sub;
+          if (sub > 0 && ::ioctl(ctl, SNDRV_CTL_IOCTL_RAWMIDI_INFO, &info) < 0)
+            continue;
+
+          list.push_back(
+              {.id = {card, device, static_cast<int>(sub)},
+               .card_name = card_name,
+               .device_name = device_name,
+               .subdevice_name = std::string(reinterpret_cast<const char*>(info.subname))});
+        }
+      }
+    }
+  }
+  return ret;
+}
+
+inline port_information to_port_info(const device_info& d)
+{
+  return {
+      .client = 0,
+      .port = to_port_handle(d.id),
+      .manufacturer = d.card_name,
+      .device_name = d.device_name,
+      .port_name = d.subdevice_name,
+      .display_name = d.subdevice_name};
+}
+}
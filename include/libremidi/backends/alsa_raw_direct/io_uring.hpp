@@ -0,0 +1,245 @@
+#pragma once
+#include <libremidi/config.hpp>
+
+#if __has_include(<linux/io_uring.h>)
+  #include <linux/io_uring.h>
+  #include <sys/mman.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+
+  #include <algorithm>
+  #include <atomic>
+  #include <cerrno>
+  #include <cstdint>
+  #include <cstdlib>
+  #include <cstring>
+  #include <utility>
+
+  #define LIBREMIDI_HAS_IO_URING 1
+
+namespace libremidi::alsa_raw_direct
+{
+//! Just enough of io_uring to run multishot reads over a provided buffer ring,
+//! without depending on liburing.
+class io_uring
+{
+public:
+  // Not in the uapi headers of older distributions
+  static constexpr uint8_t op_read_multishot = 49; // Linux 6.7
+  static constexpr int register_pbuf_ring = 22;    // Linux 5.19
+
+  io_uring() = default;
+  io_uring(const io_uring&) = delete;
+  io_uring(io_uring&&) = delete;
+  io_uring& operator=(const io_uring&) = delete;
+  io_uring& operator=(io_uring&&) = delete;
+
+  ~io_uring()
+  {
+    if (m_buffers)
+      std::free(m_buffers);
+    if (m_buf_ring)
+      ::munmap(m_buf_ring, m_buf_ring_size);
+    if (m_sqes)
+      ::munmap(m_sqes, m_params.sq_entries * sizeof(io_uring_sqe));
+    if (m_cq_ring && m_cq_ring != m_sq_ring)
+      ::munmap(m_cq_ring, m_cq_ring_size);
+    if (m_sq_ring)
+      ::munmap(m_sq_ring, m_sq_ring_size);
+    if (m_fd >= 0)
+      ::close(m_fd);
+  }
+
+  //! Returns 0 or a negative errno, e.g. -ENOSYS or -EPERM when io_uring is disabled
+  int init(uint32_t entries)
+  {
+    m_fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &m_params));
+    if (m_fd < 0)
+      return -errno;
+
+    // Since 5.4 both rings live in a single mapping
+    if (!(m_params.features & IORING_FEAT_SINGLE_MMAP))
+      return -ENOSYS;
+
+    m_sq_ring_size = m_params.sq_off.array + m_params.sq_entries * sizeof(uint32_t);
+    m_cq_ring_size = m_params.cq_off.cqes + m_params.cq_entries * sizeof(io_uring_cqe);
+    m_sq_ring_size = m_cq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+
+    m_sq_ring = map(m_sq_ring_size, IORING_OFF_SQ_RING);
+    if (!m_sq_ring)
+      return -errno;
+    m_cq_ring = m_sq_ring;
+
+    m_sqes = static_cast<io_uring_sqe*>(
+        map(m_params.sq_entries * sizeof(io_uring_sqe), IORING_OFF_SQES));
+    if (!m_sqes)
+      return -errno;
+
+    auto sq = static_cast<char*>(m_sq_ring);
+    m_sq_tail = reinterpret_cast<uint32_t*>(sq + m_params.sq_off.tail);
+    m_sq_mask = *reinterpret_cast<uint32_t*>(sq + m_params.sq_off.ring_mask);
+    m_sq_array = reinterpret_cast<uint32_t*>(sq + m_params.sq_off.array);
+
+    auto cq = static_cast<char*>(m_cq_ring);
+    m_cq_head = reinterpret_cast<uint32_t*>(cq + m_params.cq_off.head);
+    m_cq_tail = reinterpret_cast<uint32_t*>(cq + m_params.cq_off.tail);
+    m_cq_mask = *reinterpret_cast<uint32_t*>(cq + m_params.cq_off.ring_mask);
+    m_cqes = reinterpret_cast<io_uring_cqe*>(cq + m_params.cq_off.cqes);
+
+    // The SQ index array is the identity, set it once
+    for (uint32_t i = 0; i < m_params.sq_entries; i++)
+      m_sq_array[i] = i;
+    return 0;
+  }
+
+  //! Registers `count` buffers of `size` bytes each, as buffer group `group`.
+  //! count must be a power of two.
+  int register_buffers(uint16_t group, uint16_t count, uint32_t size)
+  {
+    m_buf_count = count;
+    m_buf_size = size;
+    m_buf_group = group;
+
+    m_buf_ring_size = count * sizeof(io_uring_buf);
+    m_buf_ring = ::mmap(
+        nullptr, m_buf_ring_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (m_buf_ring == MAP_FAILED)
+    {
+      m_buf_ring = nullptr;
+      return -errno;
+    }
+
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(m_buf_ring);
+    reg.ring_entries = count;
+    reg.bgid = group;
+    if (::syscall(__NR_io_uring_register, m_fd, register_pbuf_ring, &reg, 1) < 0)
+      return -errno;
+
+    m_buffers = static_cast<uint8_t*>(std::aligned_alloc(64, std::size_t(count) * size));
+    if (!m_buffers)
+      return -ENOMEM;
+
+    for (uint16_t i = 0; i < count; i++)
+      recycle_buffer(i, false);
+    publish_buffers();
+    return 0;
+  }
+
+  uint8_t* buffer(uint16_t id) const noexcept { return m_buffers + std::size_t(id) * m_buf_size; }
+  uint16_t buffer_group() const noexcept { return m_buf_group; }
+
+  //! Gives a buffer back to the kernel; takes effect at the next publish_buffers()
+  void recycle_buffer(uint16_t id, bool publish = true) noexcept
+  {
+    auto bufs = static_cast<io_uring_buf*>(m_buf_ring);
+    auto& b = bufs[m_buf_tail & (m_buf_count - 1)];
+    b.addr = reinterpret_cast<uint64_t>(buffer(id));
+    b.len = m_buf_size;
+    b.bid = id;
+    m_buf_tail++;
+    if (publish)
+      publish_buffers();
+  }
+
+  void publish_buffers() noexcept
+  {
+    // The tail overlays the reserved field of the first entry
+    auto tail = reinterpret_cast<uint16_t*>(static_cast<char*>(m_buf_ring) + 14);
+    std::atomic_ref<uint16_t>{*tail}.store(m_buf_tail, std::memory_order_release);
+  }
+
+  //! Returns a zeroed SQE or nullptr if the queue is full; the caller must then submit()
+  io_uring_sqe* get_sqe() noexcept
+  {
+    const uint32_t tail = *m_sq_tail + m_pending;
+    const uint32_t head = std::atomic_ref<uint32_t>{
+        *reinterpret_cast<uint32_t*>(static_cast<char*>(m_sq_ring) + m_params.sq_off.head)}
+                              .load(std::memory_order_acquire);
+    if (tail - head >= m_params.sq_entries)
+      return nullptr;
+
+    auto sqe = &m_sqes[tail & m_sq_mask];
+    std::memset(sqe, 0, sizeof(*sqe));
+    m_pending++;
+    return sqe;
+  }
+
+  //! Hands the prepared SQEs to the kernel
+  int submit() noexcept
+  {
+    const uint32_t count = std::exchange(m_pending, 0);
+    if (count == 0)
+      return 0;
+
+    std::atomic_ref<uint32_t>{*m_sq_tail}.store(*m_sq_tail + count, std::memory_order_release);
+    for (;;)
+    {
+      const auto ret = ::syscall(__NR_io_uring_enter, m_fd, count, 0, 0, nullptr, 0);
+      if (ret < 0 && errno == EINTR)
+        continue;
+      return ret < 0 ? -errno : static_cast<int>(ret);
+    }
+  }
+
+  //! Blocks until at least one completion is available.
+  //! Does not touch the submission queue, thus can run concurrently with submit().
+  int wait() noexcept
+  {
+    const auto ret = ::syscall(__NR_io_uring_enter, m_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+    return ret < 0 ? -errno : 0;
+  }
+
+  //! Calls f(const io_uring_cqe&) for each available completion
+  template <typename F>
+  std::size_t for_each_completion(F&& f) noexcept(noexcept(f(std::declval<io_uring_cqe&>())))
+  {
+    uint32_t head = *m_cq_head;
+    const uint32_t tail = std::atomic_ref<uint32_t>{*m_cq_tail}.load(std::memory_order_acquire);
+    std::size_t n = 0;
+    for (; head != tail; head++, n++)
+      f(m_cqes[head & m_cq_mask]);
+    std::atomic_ref<uint32_t>{*m_cq_head}.store(head, std::memory_order_release);
+    return n;
+  }
+
+  int fd() const noexcept { return m_fd; }
+
+private:
+  void* map(std::size_t size, uint64_t offset) noexcept
+  {
+    void* ptr = ::mmap(
+        nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd,
+        static_cast<off_t>(offset));
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  }
+
+  int m_fd{-1};
+  io_uring_params m_params{};
+
+  void* m_sq_ring{};
+  void* m_cq_ring{};
+  std::size_t m_sq_ring_size{};
+  std::size_t m_cq_ring_size{};
+  io_uring_sqe* m_sqes{};
+
+  uint32_t* m_sq_tail{};
+  uint32_t* m_sq_array{};
+  uint32_t m_sq_mask{};
+  uint32_t m_pending{};
+
+  uint32_t* m_cq_head{};
+  uint32_t* m_cq_tail{};
+  uint32_t m_cq_mask{};
+  io_uring_cqe* m_cqes{};
+
+  void* m_buf_ring{};
+  std::size_t m_buf_ring_size{};
+  uint8_t* m_buffers{};
+  uint32_t m_buf_size{};
+  uint16_t m_buf_count{};
+  uint16_t m_buf_group{};
+  uint16_t m_buf_tail{};
+};
+}
+#endif
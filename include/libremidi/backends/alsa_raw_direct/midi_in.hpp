@@ -0,0 +1,111 @@
+#pragma once
+#include <libremidi/backends/alsa_raw_direct/config.hpp>
+#include <libremidi/backends/alsa_raw_direct/helpers.hpp>
+#include <libremidi/backends/alsa_raw_direct/reactor.hpp>
+#include <libremidi/detail/memory.hpp>
+#include <libremidi/detail/midi_in.hpp>
+#include <libremidi/detail/midi_stream_decoder.hpp>
+
+#include <sys/stat.h>
+
+namespace libremidi::alsa_raw_direct
+{
+class midi_in_impl final
+    : public midi1::in_api
+    , public reactor::reader
+    , public error_handler
+{
+public:
+  struct
+      : libremidi::input_configuration
+      , alsa_raw_direct::input_configuration
+  {
+  } configuration;
+
+  explicit midi_in_impl(
+      libremidi::input_configuration&& conf, alsa_raw_direct::input_configuration&& apiconf)
+      : configuration{std::move(conf), std::move(apiconf)}
+      , m_reactor{libremidi::instance<reactor>()}
+  {
+    client_open_ = stdx::error{};
+  }
+
+  ~midi_in_impl() override
+  {
+    close_port();
+    client_open_ = std::errc::not_connected;
+  }
+
+  libremidi::API get_current_api() const noexcept override
+  {
+    return libremidi::API::ALSA_RAW_DIRECT;
+  }
+
+  stdx::error open_port(const input_port& port, std::string_view) override
+  {
+    int fd = -1;
+    if (configuration.device_path.empty())
+    {
+      fd = open_device(from_port_handle(port.port), O_RDONLY | O_NONBLOCK);
+    }
+    else
+    {
+      struct stat st{};
+      const bool fifo = ::stat(configuration.device_path.c_str(), &st) == 0 && S_ISFIFO(st.st_mode);
+      fd = ::open(
+          configuration.device_path.c_str(), (fifo ? O_RDWR : O_RDONLY) | O_NONBLOCK | O_CLOEXEC);
+      if (fd < 0)
+        fd = -errno;
+    }
+
+    if (fd < 0)
+    {
+      libremidi_handle_error(configuration, "cannot open device: " + port.port_name);
+      return from_errc(fd);
+    }
+
+    m_fd.reset(fd);
+    if (!configuration.threading.empty())
+      m_reactor->set_thread_policy(configuration.threading);
+    m_reactor->add(m_fd, *this);
+    return stdx::error{};
+  }
+
+  stdx::error close_port() override
+  {
+    if (m_fd)
+    {
+      m_reactor->remove(*this);
+      m_fd.reset();
+    }
+    return stdx::error{};
+  }
+
+  timestamp absolute_timestamp() const noexcept override { return system_ns(); }
+
+  void on_bytes(std::span<const uint8_t> bytes) override
+  {
+    static constexpr timestamp_backend_info timestamp_info{
+        .has_absolute_timestamps = false,
+        .absolute_is_monotonic = false,
+        .has_samples = false,
+    };
+
+    // A read can return several messages, e.g. from a multishot read which completed
+    // while the previous completions were being processed
+    const auto to_ns = [this] { return absolute_timestamp(); };
+    m_processing.on_bytes_multi(bytes, m_processing.timestamp<timestamp_info>(to_ns, 0));
+  }
+
+  void on_error(int err) override
+  {
+    libremidi_handle_warning(
+        configuration, "device stopped: " + std::string(std::strerror(-err)));
+  }
+
+private:
+  std::shared_ptr<reactor> m_reactor;
+  unique_fd m_fd;
+  midi1::input_state_machine m_processing{this->configuration};
+};
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <libremidi/backends/alsa_raw_direct/config.hpp>
+#include <libremidi/backends/alsa_raw_direct/helpers.hpp>
+#include <libremidi/detail/midi_out.hpp>
+
+namespace libremidi::alsa_raw_direct
+{
+class midi_out_impl final
+    : public midi1::out_api
+    , public error_handler
+{
+public:
+  struct
+      : libremidi::output_configuration
+      , alsa_raw_direct::output_configuration
+  {
+  } configuration;
+
+  explicit midi_out_impl(
+      libremidi::output_configuration&& conf, alsa_raw_direct::output_configuration&& apiconf)
+      : configuration{std::move(conf), std::move(apiconf)}
+  {
+    client_open_ = stdx::error{};
+  }
+
+  ~midi_out_impl() override
+  {
+    close_port();
+    client_open_ = std::errc::not_connected;
+  }
+
+  libremidi::API get_current_api() const noexcept override
+  {
+    return libremidi::API::ALSA_RAW_DIRECT;
+  }
+
+  stdx::error open_port(const output_port& port, std::string_view) override
+  {
+    // Blocking writes, like SND_RAWMIDI_SYNC in alsa_raw
+    int fd = -1;
+    if (configuration.device_path.empty())
+    {
+      fd = open_device(from_port_handle(port.port), O_WRONLY);
+    }
+    else
+    {
+      fd = ::open(configuration.device_path.c_str(), O_WRONLY | O_CLOEXEC);
+      if (fd < 0)
+        fd = -errno;
+    }
+
+    if (fd < 0)
+    {
+      libremidi_handle_error(configuration, "cannot open device: " + port.port_name);
+      return from_errc(fd);
+    }
+
+    m_fd.reset(fd);
+    return stdx::error{};
+  }
+
+  stdx::error close_port() override
+  {
+    m_fd.reset();
+    return stdx::error{};
+  }
+
+  stdx::error send_message(const unsigned char* message, std::size_t size) override
+  {
+    if (!m_fd)
+    {
+      libremidi_handle_error(configuration, "trying to send a message without an open port.");
+      return std::errc::not_connected;
+    }
+
+    while (size > 0)
+    {
+      const auto res = ::write(m_fd, message, size);
+      if (res < 0)
+      {
+        if (errno == EINTR)
+          continue;
+
+        const int err = errno;
+        libremidi_handle_error(configuration, "cannot write message.");
+        return from_errc(-err);
+      }
+      message += res;
+      size -= static_cast<std::size_t>(res);
+    }
+    return stdx::error{};
+  }
+
+private:
+  unique_fd m_fd;
+};
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <libremidi/backends/alsa_raw_direct/config.hpp>
+#include <libremidi/backends/alsa_raw_direct/helpers.hpp>
+#include <libremidi/detail/observer.hpp>
+
+namespace libremidi::alsa_raw_direct
+{
+//! Enumeration only: hot-plug notifications are not supported yet.
+class observer_impl final
+    : public observer_api
+    , public error_handler
+{
+public:
+  struct
+      : libremidi::observer_configuration
+      , alsa_raw_direct::observer_configuration
+  {
+  } configuration;
+
+  explicit observer_impl(
+      libremidi::observer_configuration&& conf, alsa_raw_direct::observer_configuration&& apiconf)
+      : configuration{std::move(conf), std::move(apiconf)}
+  {
+    if (!configuration.track_hardware)
+      return;
+
+    if (configuration.notify_in_constructor)
+    {
+      auto devices = enumerate_devices();
+      if (configuration.input_added)
+        for (const auto& d : devices.inputs)
+          configuration.input_added({to_port_info(d)});
+      if (configuration.output_added)
+        for (const auto& d : devices.outputs)
+          configuration.output_added({to_port_info(d)});
+    }
+  }
+
+  libremidi::API get_current_api() const noexcept override
+  {
+    return libremidi::API::ALSA_RAW_DIRECT;
+  }
+
+  std::vector<libremidi::input_port> get_input_ports() const noexcept override
+  {
+    std::vector<libremidi::input_port> ret;
+    for (const auto& d : enumerate_devices().inputs)
+      ret.push_back({to_port_info(d)});
+    return ret;
+  }
+
+  std::vector<libremidi::output_port> get_output_ports() const noexcept override
+  {
+    std::vector<libremidi::output_port> ret;
+    for (const auto& d : enumerate_devices().outputs)
+      ret.push_back({to_port_info(d)});
+    return ret;
+  }
+};
+}
@@ -0,0 +1,401 @@
+#pragma once
+#include <libremidi/backends/alsa_raw_direct/io_uring.hpp>
+#include <libremidi/backends/linux/helpers.hpp>
+#include <libremidi/detail/thread_policy.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace libremidi::alsa_raw_direct
+{
+//! Reads every open port of the process from a single thread.
+//! With io_uring, each port has one multishot read in flight, all of them sharing
+//! one ring of provided buffers: a burst on any number of ports costs a single wakeup
+//! and no read() system call. When io_uring is not usable (old kernel, seccomp filter),
+//! it falls back to a poll() loop.
+class reactor
+{
+public:
+  //! Implemented by the midi_in objects. Called from the reactor thread.
+  class reader
+  {
+  public:
+    virtual ~reader() = default;
+    virtual void on_bytes(std::span<const uint8_t> bytes) = 0;
+
+    //! The port cannot be read anymore, e.g. the device was unplugged
+    virtual void on_error(int err) = 0;
+  };
+
+  reactor()
+  {
+#if LIBREMIDI_HAS_IO_URING
+    if (m_ring.init(queue_depth) == 0
+        && m_ring.register_buffers(buffer_group, buffer_count, buffer_size) == 0)
+    {
+      m_uses_io_uring = true;
+      m_thread = std::thread{[this] { run_io_uring(); }};
+      return;
+    }
+#endif
+    m_thread = std::thread{[this] { run_poll(); }};
+  }
+
+  reactor(const reactor&) = delete;
+  reactor(reactor&&) = delete;
+  reactor& operator=(const reactor&) = delete;
+  reactor& operator=(reactor&&) = delete;
+
+  ~reactor()
+  {
+    {
+      std::lock_guard _{m_mutex};
+      m_stop = true;
+#if LIBREMIDI_HAS_IO_URING
+      // If the queue is full, the thread sees m_stop after the completions it waits for
+      if (m_uses_io_uring)
+      {
+        submit_one([](io_uring_sqe& sqe) {
+          sqe.opcode = IORING_OP_NOP;
+          sqe.user_data = termination_tag;
+        });
+      }
+#endif
+    }
+    m_wakeup.notify();
+
+    if (m_thread.joinable())
+      m_thread.join();
+  }
+
+  bool uses_io_uring() const noexcept { return m_uses_io_uring; }
+
+  //! Starts reading a non-blocking file descriptor
+  void add(int fd, reader& r)
+  {
+    std::lock_guard _{m_mutex};
+    const uint64_t id = ++m_last_id;
+    m_ports.push_back({.id = id, .fd = fd, .target = &r});
+
+#if LIBREMIDI_HAS_IO_URING
+    if (m_uses_io_uring)
+    {
+      if (!arm(m_ports.back()))
+        m_unarmed.push_back(id);
+      m_ring.submit();
+      return;
+    }
+#endif
+    m_wakeup.notify();
+  }
+
+  //! The reactor thread is shared by all the inputs: the last policy set wins
+  void set_thread_policy(const thread_policy& policy)
+  {
+    std::lock_guard _{m_mutex};
+    m_policy = policy;
+    m_policy_changed = true;
+
+#if LIBREMIDI_HAS_IO_URING
+    if (m_uses_io_uring)
+    {
+      submit_one([](io_uring_sqe& sqe) {
+        sqe.opcode = IORING_OP_NOP;
+        sqe.user_data = wakeup_tag;
+      });
+      return;
+    }
+#endif
+    m_wakeup.notify();
+  }
+
+  //! Once this returns, the reader will not be called anymore
+  void remove(reader& r)
+  {
+    std::lock_guard _{m_mutex};
+    auto it = std::find_if(
+        m_ports.begin(), m_ports.end(), [&](const port& p) { return p.target == &r; });
+    if (it == m_ports.end())
+      return;
+
+    [[maybe_unused]] const uint64_t id = it->id;
+    m_ports.erase(it);
+
+#if LIBREMIDI_HAS_IO_URING
+    if (m_uses_io_uring)
+    {
+      // Buffers of the reads which complete in-between are recycled when reaped
+      if (!cancel(id))
+        m_uncancelled.push_back(id);
+      return;
+    }
+#endif
+    m_wakeup.notify();
+  }
+
+private:
+  static constexpr uint32_t queue_depth = 64;
+  static constexpr uint16_t buffer_group = 0;
+  static constexpr uint16_t buffer_count = 128;
+  static constexpr uint32_t buffer_size = 512;
+
+  static constexpr uint64_t termination_tag = 0;
+  static constexpr uint64_t cancel_tag = UINT64_MAX;
+  static constexpr uint64_t wakeup_tag = UINT64_MAX - 1;
+
+  struct port
+  {
+    uint64_t id{};
+    int fd{-1};
+    reader* target{};
+    bool multishot{true};
+  };
+
+  port* find(uint64_t id) noexcept
+  {
+    auto it = std::find_if(
+        m_ports.begin(), m_ports.end(), [=](const port& p) { return p.id == id; });
+    return it != m_ports.end() ? &*it : nullptr;
+  }
+
+  // Called from the reactor thread with the mutex held
+  void update_thread_policy()
+  {
+    if (std::exchange(m_policy_changed, false))
+      apply_thread_policy(m_policy, "alsa_raw_direct reactor");
+  }
+
+  // The port is unregistered before the reader is notified, so that it can be closed from there
+  void fail(uint64_t id, int err)
+  {
+    auto it = std::find_if(
+        m_ports.begin(), m_ports.end(), [=](const port& p) { return p.id == id; });
+    if (it == m_ports.end())
+      return;
+
+    auto target = it->target;
+    m_ports.erase(it);
+    target->on_error(err);
+  }
+
+#if LIBREMIDI_HAS_IO_URING
+  // Returns nullptr if the submission queue is still full after submitting it,
+  // e.g. when the kernel refuses new submissions until completions are reaped
+  io_uring_sqe* next_sqe() noexcept
+  {
+    io_uring_sqe* sqe = m_ring.get_sqe();
+    if (!sqe)
+    {
+      m_ring.submit();
+      sqe = m_ring.get_sqe();
+    }
+    return sqe;
+  }
+
+  template <typename F>
+  bool submit_one(F&& prepare)
+  {
+    io_uring_sqe* sqe = next_sqe();
+    if (!sqe)
+      return false;
+    prepare(*sqe);
+    m_ring.submit();
+    return true;
+  }
+
+  bool cancel(uint64_t id)
+  {
+    return submit_one([id](io_uring_sqe& sqe) {
+      sqe.opcode = IORING_OP_ASYNC_CANCEL;
+      sqe.addr = id;
+      sqe.user_data = cancel_tag;
+    });
+  }
+
+  // Queues a read, submitted at the next m_ring.submit().
+  // Returns false if there was no room for it: the caller must retry later.
+  bool arm(const port& p)
+  {
+    io_uring_sqe* sqe = next_sqe();
+    if (!sqe)
+      return false;
+
+    sqe->opcode = p.multishot ? io_uring::op_read_multishot : uint8_t(IORING_OP_READ);
+    sqe->fd = p.fd;
+    sqe->off = static_cast<uint64_t>(-1);
+    sqe->len = p.multishot ? 0 : buffer_size;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = m_ring.buffer_group();
+    sqe->user_data = p.id;
+    return true;
+  }
+
+  // Called after each completion batch, once the kernel had a chance to free the queue.
+  // A port which still cannot be armed then is reported instead of staying silent.
+  void retry_submissions()
+  {
+    for (const uint64_t id : std::exchange(m_unarmed, {}))
+    {
+      if (auto p = find(id); p && !arm(*p))
+        fail(id, -EBUSY);
+    }
+
+    std::erase_if(m_uncancelled, [this](uint64_t id) { return cancel(id); });
+    m_ring.submit();
+  }
+
+  void on_completion(const io_uring_cqe& cqe)
+  {
+    if (cqe.user_data == cancel_tag || cqe.user_data == wakeup_tag)
+      return;
+    if (cqe.user_data == termination_tag)
+    {
+      m_stop = true;
+      return;
+    }
+
+    const bool has_buffer = cqe.flags & IORING_CQE_F_BUFFER;
+    const auto bid = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+
+    auto p = find(cqe.user_data);
+    if (!p)
+    {
+      // The port was closed while a read was in flight
+      if (has_buffer)
+        m_ring.recycle_buffer(bid);
+      return;
+    }
+
+    bool rearm = !(cqe.flags & IORING_CQE_F_MORE);
+    if (cqe.res > 0 && has_buffer)
+    {
+      p->target->on_bytes({m_ring.buffer(bid), static_cast<std::size_t>(cqe.res)});
+      m_ring.recycle_buffer(bid);
+    }
+    else if ((cqe.res == -EINVAL || cqe.res == -EBADFD) && p->multishot)
+    {
+      // Multishot reads need Linux 6.7 and a pollable file: use one-shot reads instead
+      p->multishot = false;
+    }
+    else if (cqe.res == 0)
+    {
+      // End of file
+      fail(cqe.user_data, -ENODEV);
+      return;
+    }
+    else if (cqe.res < 0 && cqe.res != -ENOBUFS && cqe.res != -EAGAIN && cqe.res != -EINTR)
+    {
+      fail(cqe.user_data, cqe.res);
+      return;
+    }
+
+    // The callbacks may have closed the port
+    if (rearm)
+      if (auto p = find(cqe.user_data); p && !arm(*p))
+        m_unarmed.push_back(p->id);
+  }
+
+  void run_io_uring()
+  {
+    for (;;)
+    {
+      if (int err = m_ring.wait(); err < 0 && err != -EINTR && err != -EAGAIN)
+        return;
+
+      std::lock_guard _{m_mutex};
+      m_ring.for_each_completion([this](const io_uring_cqe& cqe) { on_completion(cqe); });
+      m_ring.submit();
+      if (m_stop)
+        return;
+      retry_submissions();
+      update_thread_policy();
+    }
+  }
+#endif
+
+  void run_poll()
+  {
+    std::vector<pollfd> fds;
+    std::vector<uint64_t> ids;
+    uint8_t bytes[buffer_size];
+
+    for (;;)
+    {
+      {
+        std::lock_guard _{m_mutex};
+        if (m_stop)
+          return;
+        update_thread_policy();
+
+        fds.clear();
+        ids.clear();
+        fds.push_back(m_wakeup);
+        for (const auto& p : m_ports)
+        {
+          fds.push_back({.fd = p.fd, .events = POLLIN, .revents = 0});
+          ids.push_back(p.id);
+        }
+      }
+
+      if (::poll(fds.data(), fds.size(), -1) < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        return;
+      }
+
+      if (eventfd_notifier::ready(fds[0]))
+        m_wakeup.consume();
+
+      std::lock_guard _{m_mutex};
+      for (std::size_t i = 1; i < fds.size(); i++)
+      {
+        if (!fds[i].revents)
+          continue;
+
+        // Looked up again as the callbacks may have closed ports
+        for (auto p = find(ids[i - 1]); p; p = find(ids[i - 1]))
+        {
+          const auto n = ::read(p->fd, bytes, sizeof(bytes));
+          if (n > 0)
+          {
+            p->target->on_bytes({bytes, static_cast<std::size_t>(n)});
+            continue;
+          }
+
+          if (n == 0 || (errno != EAGAIN && errno != EINTR))
+            fail(ids[i - 1], n == 0 ? -ENODEV : -errno);
+          break;
+        }
+      }
+    }
+  }
+
+#if LIBREMIDI_HAS_IO_URING
+  io_uring m_ring;
+
+  // Ports whose read could not be queued, and closed ports whose read could not be
+  // cancelled, for lack of submission queue entries
+  std::vector<uint64_t> m_unarmed;
+  std::vector<uint64_t> m_uncancelled;
+#endif
+  bool m_uses_io_uring{};
+
+  // Recursive as ports can be closed from the callbacks
+  std::recursive_mutex m_mutex;
+  std::vector<port> m_ports;
+  uint64_t m_last_id{};
+  bool m_stop{};
+
+  thread_policy m_policy;
+  bool m_policy_changed{};
+
+  eventfd_notifier m_wakeup{false};
+  std::thread m_thread;
+};
+}
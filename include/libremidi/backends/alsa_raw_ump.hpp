@@ -24,7 +24,7 @@ struct backend
   static inline bool available() noexcept
   {
     static const libasound& snd = libasound::instance();
-    return snd.available && snd.rawmidi.available && snd.ump.available;
+    return snd.available && snd.rawmidi->available && snd.ump->available;
   }
 };
 }
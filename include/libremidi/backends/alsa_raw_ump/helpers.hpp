@@ -24,7 +24,7 @@ struct midi2_enumerator : alsa_raw::enumerator
     int device = -1;
     do
     {
-      const int status = snd.ctl.ump.next_device(ctl, &device);
+      const int status = snd.ctl->ump->next_device(ctl, &device);
       if (device == -1)
         return;
 
@@ -48,18 +48,18 @@ struct midi2_enumerator : alsa_raw::enumerator
   {
     snd_ump_endpoint_info_t* info{};
     snd_ump_endpoint_info_alloca(&info);
-    snd.ctl.ump.endpoint_info(ctl, info);
+    snd.ctl->ump->endpoint_info(ctl, info);
 
-    fprintf(stderr, "UMP endpoint: %s", snd.ump.endpoint_info_get_name(info));
+    fprintf(stderr, "UMP endpoint: %s", snd.ump->endpoint_info_get_name(info));
   }
 
   void enumerate_blocks(snd_ctl_t* ctl, [[maybe_unused]] int card, [[maybe_unused]] int device)
   {
     snd_ump_block_info_t* info{};
     snd_ump_block_info_alloca(&info);
-    snd.ctl.ump.block_info(ctl, info);
+    snd.ctl->ump->block_info(ctl, info);
 
-    fprintf(stderr, "UMP block: %s", snd.ump.block_info_get_name(info));
+    fprintf(stderr, "UMP block: %s", snd.ump->block_info_get_name(info));
   }
 };
 
@@ -4,6 +4,7 @@
 #include <libremidi/backends/linux/helpers.hpp>
 #include <libremidi/detail/midi_in.hpp>
 #include <libremidi/detail/midi_stream_decoder.hpp>
+#include <libremidi/detail/thread_policy.hpp>
 
 #include <alsa/asoundlib.h>
 
@@ -30,7 +31,7 @@ public:
       : configuration{std::move(conf), std::move(apiconf)}
   {
     fds_.reserve(4);
-    assert(snd.ump.available);
+    assert(snd.ump->available);
   }
 
   ~midi_in_impl() override { }
@@ -42,7 +43,7 @@ public:
   {
     constexpr int mode = 0;
     SND_RAWMIDI_NONBLOCK; // fixme
-    if (int err = snd.ump.open(&midiport_, 0, portname, mode); err < 0)
+    if (int err = snd.ump->open(&midiport_, 0, portname, mode); err < 0)
     {
       libremidi_handle_error(this->configuration, "alsa_raw_ump::ump::open_port: cannot open device.");
       return from_errc(err);
@@ -51,34 +52,34 @@ public:
     snd_rawmidi_params_t* params{};
     snd_rawmidi_params_alloca(&params);
 
-    auto rawmidi = snd.ump.rawmidi(midiport_);
+    auto rawmidi = snd.ump->rawmidi(midiport_);
 
-    if (int err = snd.ump.rawmidi_params_current(midiport_, params); err < 0)
+    if (int err = snd.ump->rawmidi_params_current(midiport_, params); err < 0)
       return from_errc(err);
-    if (int err = snd.rawmidi.params_set_no_active_sensing(rawmidi, params, 1); err < 0)
+    if (int err = snd.rawmidi->params_set_no_active_sensing(rawmidi, params, 1); err < 0)
       return from_errc(err);
 
     if (configuration.timestamps == timestamp_mode::NoTimestamp)
     {
-      if (int err = snd.rawmidi.params_set_read_mode(rawmidi, params, SND_RAWMIDI_READ_STANDARD);
+      if (int err = snd.rawmidi->params_set_read_mode(rawmidi, params, SND_RAWMIDI_READ_STANDARD);
           err < 0)
         return from_errc(err);
-      if (int err = snd.rawmidi.params_set_clock_type(rawmidi, params, SND_RAWMIDI_CLOCK_NONE);
+      if (int err = snd.rawmidi->params_set_clock_type(rawmidi, params, SND_RAWMIDI_CLOCK_NONE);
           err < 0)
         return from_errc(err);
     }
     else
     {
-      if (int err = snd.rawmidi.params_set_read_mode(rawmidi, params, SND_RAWMIDI_READ_TSTAMP);
+      if (int err = snd.rawmidi->params_set_read_mode(rawmidi, params, SND_RAWMIDI_READ_TSTAMP);
           err < 0)
         return from_errc(err);
       if (int err
-          = snd.rawmidi.params_set_clock_type(rawmidi, params, SND_RAWMIDI_CLOCK_MONOTONIC);
+          = snd.rawmidi->params_set_clock_type(rawmidi, params, SND_RAWMIDI_CLOCK_MONOTONIC);
           err < 0)
         return from_errc(err);
     }
 
-    if (int err = snd.ump.rawmidi_params(midiport_, params); err < 0)
+    if (int err = snd.ump->rawmidi_params(midiport_, params); err < 0)
       return from_errc(err);
 
     return init_pollfd();
@@ -91,12 +92,12 @@ public:
 
   [[nodiscard]] stdx::error init_pollfd()
   {
-    int num_fds = snd.ump.poll_descriptors_count(this->midiport_);
+    int num_fds = snd.ump->poll_descriptors_count(this->midiport_);
 
     this->fds_.clear();
     this->fds_.resize(num_fds);
 
-    int ret = snd.ump.poll_descriptors(this->midiport_, fds_.data(), num_fds);
+    int ret = snd.ump->poll_descriptors(this->midiport_, fds_.data(), num_fds);
     if (ret < 0)
       return from_errc(ret);
     return stdx::error{};
@@ -112,7 +113,7 @@ public:
     else
     {
       unsigned short res{};
-      ssize_t err = snd.ump.poll_descriptors_revents(
+      ssize_t err = snd.ump->poll_descriptors_revents(
           this->midiport_, fds.data(), static_cast<unsigned int>(fds.size()), &res);
       if (err < 0)
         return err;
@@ -140,7 +141,7 @@ public:
     uint32_t words[nwords];
 
     ssize_t err = 0;
-    while ((err = snd.ump.read(this->midiport_, words, nwords * 4)) > 0)
+    while ((err = snd.ump->read(this->midiport_, words, nwords * 4)) > 0)
     {
       const auto to_ns = [this] { return absolute_timestamp(); };
       m_processing.on_bytes({words, words + err / 4}, m_processing.timestamp<timestamp_info>(to_ns, 0));
@@ -161,7 +162,7 @@ public:
     struct timespec ts;
 
     ssize_t err = 0;
-    while ((err = snd.ump.tread(this->midiport_, &ts, words, nwords * 4)) > 0)
+    while ((err = snd.ump->tread(this->midiport_, &ts, words, nwords * 4)) > 0)
     {
       const auto to_ns = [ts] {
         return static_cast<int64_t>(ts.tv_sec) * 1'000'000'000 + static_cast<int64_t>(ts.tv_nsec);
@@ -174,7 +175,7 @@ public:
   stdx::error close_port() override
   {
     if (midiport_)
-      snd.ump.close(midiport_);
+      snd.ump->close(midiport_);
     midiport_ = nullptr;
 
     return stdx::error{};
@@ -213,6 +214,7 @@ public:
 private:
   void run_thread(auto parse_func)
   {
+    apply_thread_policy(this->configuration.threading, "alsa_raw_ump input");
     fds_.push_back(this->termination_event);
 
     for (;;)
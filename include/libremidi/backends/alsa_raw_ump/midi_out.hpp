@@ -28,7 +28,7 @@ public:
       libremidi::alsa_raw_ump::output_configuration&& apiconf)
       : configuration{std::move(conf), std::move(apiconf)}
   {
-    assert(snd.ump.available);
+    assert(snd.ump->available);
     client_open_ = stdx::error{};
   }
 
@@ -44,7 +44,7 @@ public:
   stdx::error connect_port(const char* portname)
   {
     constexpr int mode = SND_RAWMIDI_SYNC;
-    int ret = snd.ump.open(NULL, &midiport_, portname, mode);
+    int ret = snd.ump->open(NULL, &midiport_, portname, mode);
     if (ret < 0)
     {
       libremidi_handle_error(this->configuration, "cannot open device.");
@@ -61,7 +61,7 @@ public:
   stdx::error close_port() override
   {
     if (midiport_)
-      snd.ump.close(midiport_);
+      snd.ump->close(midiport_);
     midiport_ = nullptr;
     return stdx::error{};
   }
@@ -79,7 +79,7 @@ public:
 
   stdx::error write(const uint32_t* ump_stream, size_t bytes)
   {
-    if (auto err = snd.ump.write(midiport_, ump_stream, bytes); err < 0)
+    if (auto err = snd.ump->write(midiport_, ump_stream, bytes); err < 0)
     {
       libremidi_handle_error(this->configuration, "cannot write message.");
       return from_errc(err);
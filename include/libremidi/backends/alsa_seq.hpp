@@ -35,7 +35,7 @@ struct backend
   static inline bool available() noexcept
   {
     static const libasound& snd = libasound::instance();
-    return snd.available && snd.seq.available;
+    return snd.available && snd.seq->available;
   }
 };
 
@@ -35,11 +35,11 @@ struct event_handle
   void reset(snd_seq_event_t* new_ev) noexcept
   {
     if (ev)
-      snd.seq.free_event(ev);
+      snd.seq->free_event(ev);
     ev = new_ev;
   }
 
-  ~event_handle() { snd.seq.free_event(ev); }
+  ~event_handle() { snd.seq->free_event(ev); }
 };
 
 namespace
@@ -65,17 +65,17 @@ inline void for_all_ports(
   snd_seq_port_info_t* pinfo{};
   snd_seq_port_info_alloca(&pinfo);
 
-  snd.seq.client_info_set_client(cinfo, -1);
-  while (snd.seq.query_next_client(seq, cinfo) >= 0)
+  snd.seq->client_info_set_client(cinfo, -1);
+  while (snd.seq->query_next_client(seq, cinfo) >= 0)
   {
-    int client = snd.seq.client_info_get_client(cinfo);
+    int client = snd.seq->client_info_get_client(cinfo);
     if (client == 0)
       continue;
 
     // Reset query info
-    snd.seq.port_info_set_client(pinfo, client);
-    snd.seq.port_info_set_port(pinfo, -1);
-    while (snd.seq.query_next_port(seq, pinfo) >= 0)
+    snd.seq->port_info_set_client(pinfo, client);
+    snd.seq->port_info_set_port(pinfo, -1);
+    while (snd.seq->query_next_port(seq, pinfo) >= 0)
     {
       func(*cinfo, *pinfo);
     }
@@ -92,24 +92,24 @@ inline unsigned int iterate_port_info(
   int count = 0;
   snd_seq_client_info_alloca(&cinfo);
 
-  snd.seq.client_info_set_client(cinfo, -1);
-  while (snd.seq.query_next_client(seq, cinfo) >= 0)
+  snd.seq->client_info_set_client(cinfo, -1);
+  while (snd.seq->query_next_client(seq, cinfo) >= 0)
   {
-    const int client = snd.seq.client_info_get_client(cinfo);
+    const int client = snd.seq->client_info_get_client(cinfo);
     if (client == 0)
       continue;
 
     // Reset query info
-    snd.seq.port_info_set_client(pinfo, client);
-    snd.seq.port_info_set_port(pinfo, -1);
-    while (snd.seq.query_next_port(seq, pinfo) >= 0)
+    snd.seq->port_info_set_client(pinfo, client);
+    snd.seq->port_info_set_port(pinfo, -1);
+    while (snd.seq->query_next_port(seq, pinfo) >= 0)
     {
-      const unsigned int atyp = snd.seq.port_info_get_type(pinfo);
+      const unsigned int atyp = snd.seq->port_info_get_type(pinfo);
       if (((atyp & SND_SEQ_PORT_TYPE_MIDI_GENERIC) == 0) && ((atyp & SND_SEQ_PORT_TYPE_SYNTH) == 0)
           && ((atyp & SND_SEQ_PORT_TYPE_APPLICATION) == 0))
         continue;
 
-      const unsigned int caps = snd.seq.port_info_get_capability(pinfo);
+      const unsigned int caps = snd.seq->port_info_get_capability(pinfo);
       if ((caps & type) != type)
         continue;
       if ((caps & SND_SEQ_PORT_CAP_NO_EXPORT) != 0)
@@ -150,24 +150,24 @@ struct alsa_data
     else
     {
       // Set up the ALSA sequencer client.
-      int ret = snd.seq.open(&seq, "default", SND_SEQ_OPEN_DUPLEX, SND_SEQ_NONBLOCK);
+      int ret = snd.seq->open(&seq, "default", SND_SEQ_OPEN_DUPLEX, SND_SEQ_NONBLOCK);
       if (ret < 0)
         return ret;
 
       // Set client name.
       if (!configuration.client_name.empty())
-        snd.seq.set_client_name(seq, configuration.client_name.data());
+        snd.seq->set_client_name(seq, configuration.client_name.data());
 
 #if __has_include(<alsa/ump.h>)
-      if (snd.seq.ump.set_client_midi_version)
+      if (snd.seq->ump->set_client_midi_version)
       {
         switch (configuration.midi_version)
         {
           case 1:
-            snd.seq.ump.set_client_midi_version(seq, SND_SEQ_CLIENT_LEGACY_MIDI);
+            snd.seq->ump->set_client_midi_version(seq, SND_SEQ_CLIENT_LEGACY_MIDI);
             break;
           case 2:
-            snd.seq.ump.set_client_midi_version(seq, SND_SEQ_CLIENT_UMP_MIDI_2_0);
+            snd.seq->ump->set_client_midi_version(seq, SND_SEQ_CLIENT_UMP_MIDI_2_0);
             break;
         }
       }
@@ -179,7 +179,7 @@ struct alsa_data
 
   stdx::error set_client_name(std::string_view clientName)
   {
-    int ret = snd.seq.set_client_name(seq, clientName.data());
+    int ret = snd.seq->set_client_name(seq, clientName.data());
     return from_errc(ret);
   }
 
@@ -187,9 +187,9 @@ struct alsa_data
   {
     snd_seq_port_info_t* pinfo;
     snd_seq_port_info_alloca(&pinfo);
-    snd.seq.get_port_info(seq, vport, pinfo);
-    snd.seq.port_info_set_name(pinfo, portName.data());
-    int ret = snd.seq.set_port_info(seq, vport, pinfo);
+    snd.seq->get_port_info(seq, vport, pinfo);
+    snd.seq->port_info_set_name(pinfo, portName.data());
+    int ret = snd.seq->set_port_info(seq, vport, pinfo);
     return from_errc(ret);
   }
 
@@ -207,8 +207,8 @@ struct alsa_data
     // FIXME check that the {client, port} pair actually exists
     // snd_seq_port_info_t* src_pinfo{};
     // snd_seq_port_info_alloca(&src_pinfo);
-    // snd.seq.port_info_set_client(src_pinfo, client);
-    // snd.seq.port_info_set_port(src_pinfo, port);
+    // snd.seq->port_info_set_client(src_pinfo, client);
+    // snd.seq->port_info_set_port(src_pinfo, port);
 
     // {
     //   self.libremidi_handle_error(
@@ -231,32 +231,32 @@ struct alsa_data
       snd_seq_port_info_t* pinfo{};
       snd_seq_port_info_alloca(&pinfo);
 
-      snd.seq.port_info_set_name(pinfo, portName.data());
-      snd.seq.port_info_set_client(pinfo, 0);
-      snd.seq.port_info_set_port(pinfo, 0);
-      snd.seq.port_info_set_capability(pinfo, caps);
-      snd.seq.port_info_set_type(pinfo, type);
+      snd.seq->port_info_set_name(pinfo, portName.data());
+      snd.seq->port_info_set_client(pinfo, 0);
+      snd.seq->port_info_set_port(pinfo, 0);
+      snd.seq->port_info_set_capability(pinfo, caps);
+      snd.seq->port_info_set_type(pinfo, type);
 
       if (type & SND_SEQ_PORT_TYPE_MIDI_GENERIC)
       {
-        snd.seq.port_info_set_midi_channels(pinfo, 16);
+        snd.seq->port_info_set_midi_channels(pinfo, 16);
       }
 
       if (queue)
       {
-        snd.seq.port_info_set_timestamping(pinfo, 1);
-        snd.seq.port_info_set_timestamp_real(pinfo, 1);
-        snd.seq.port_info_set_timestamp_queue(pinfo, *queue);
+        snd.seq->port_info_set_timestamping(pinfo, 1);
+        snd.seq->port_info_set_timestamp_real(pinfo, 1);
+        snd.seq->port_info_set_timestamp_queue(pinfo, *queue);
       }
 
-      if (int err = snd.seq.create_port(this->seq, pinfo); err < 0)
+      if (int err = snd.seq->create_port(this->seq, pinfo); err < 0)
         return err;
 
-      this->vport = snd.seq.port_info_get_port(pinfo);
-      if (int err = snd.seq.get_port_info(this->seq, this->vport, pinfo); err < 0)
+      this->vport = snd.seq->port_info_get_port(pinfo);
+      if (int err = snd.seq->get_port_info(this->seq, this->vport, pinfo); err < 0)
         return err;
 
-      if (auto addr = snd.seq.port_info_get_addr(pinfo))
+      if (auto addr = snd.seq->port_info_get_addr(pinfo))
         this->vaddr = *addr;
       else
         return -1;
@@ -270,25 +270,25 @@ struct alsa_data
   {
     // Create the connection between ports
     // Make subscription
-    if (int err = snd.seq.port_subscribe_malloc(&this->subscription); err < 0)
+    if (int err = snd.seq->port_subscribe_malloc(&this->subscription); err < 0)
     {
       self.libremidi_handle_error(
           self.configuration, "ALSA error allocation port subscription.");
       return err;
     }
 
-    snd.seq.port_subscribe_set_sender(this->subscription, &sender);
-    snd.seq.port_subscribe_set_dest(this->subscription, &receiver);
+    snd.seq->port_subscribe_set_sender(this->subscription, &sender);
+    snd.seq->port_subscribe_set_dest(this->subscription, &receiver);
 
     if (realtime)
     {
-      snd.seq.port_subscribe_set_time_update(this->subscription, 1);
-      snd.seq.port_subscribe_set_time_real(this->subscription, 1);
+      snd.seq->port_subscribe_set_time_update(this->subscription, 1);
+      snd.seq->port_subscribe_set_time_real(this->subscription, 1);
     }
 
-    if (int err = snd.seq.subscribe_port(this->seq, this->subscription); err != 0)
+    if (int err = snd.seq->subscribe_port(this->seq, this->subscription); err != 0)
     {
-      snd.seq.port_subscribe_free(this->subscription);
+      snd.seq->port_subscribe_free(this->subscription);
       this->subscription = nullptr;
       return err;
     }
@@ -299,8 +299,8 @@ struct alsa_data
   {
     if (this->subscription)
     {
-      snd.seq.unsubscribe_port(this->seq, this->subscription);
-      snd.seq.port_subscribe_free(this->subscription);
+      snd.seq->unsubscribe_port(this->seq, this->subscription);
+      snd.seq->port_subscribe_free(this->subscription);
       this->subscription = nullptr;
     }
   }
@@ -4,6 +4,7 @@
 #include <libremidi/backends/linux/helpers.hpp>
 #include <libremidi/detail/midi_in.hpp>
 #include <libremidi/detail/midi_stream_decoder.hpp>
+#include <libremidi/detail/thread_policy.hpp>
 
 namespace libremidi::alsa_seq
 {
@@ -65,26 +66,26 @@ public:
     // Create the input queue
     if (require_timestamps())
     {
-      this->queue_id = snd.seq.alloc_queue(seq);
+      this->queue_id = snd.seq->alloc_queue(seq);
       // Set arbitrary tempo (mm=100) and resolution (240)
       snd_seq_queue_tempo_t* qtempo{};
       snd_seq_queue_tempo_alloca(&qtempo);
-      snd.seq.queue_tempo_set_tempo(qtempo, 600000);
-      snd.seq.queue_tempo_set_ppq(qtempo, 240);
-      snd.seq.set_queue_tempo(this->seq, this->queue_id, qtempo);
-      snd.seq.drain_output(this->seq);
+      snd.seq->queue_tempo_set_tempo(qtempo, 600000);
+      snd.seq->queue_tempo_set_ppq(qtempo, 240);
+      snd.seq->set_queue_tempo(this->seq, this->queue_id, qtempo);
+      snd.seq->drain_output(this->seq);
     }
 
     // Create the event -> midi encoder
     {
-      int result = snd.midi.event_new(0, &coder);
+      int result = snd.midi->event_new(0, &coder);
       if (result < 0)
       {
         libremidi_handle_error(this->configuration, "error during snd_midi_event_new.");
         return;
       }
-      snd.midi.event_init(coder);
-      snd.midi.event_no_status(coder, 1);
+      snd.midi->event_init(coder);
+      snd.midi->event_no_status(coder, 1);
     }
   }
 
@@ -92,16 +93,16 @@ public:
   {
     // Cleanup.
     if (this->vport >= 0)
-      snd.seq.delete_port(this->seq, this->vport);
+      snd.seq->delete_port(this->seq, this->vport);
 
     if (require_timestamps())
-      snd.seq.free_queue(this->seq, this->queue_id);
+      snd.seq->free_queue(this->seq, this->queue_id);
 
-    snd.midi.event_free(coder);
+    snd.midi->event_free(coder);
 
     // Close if we do not have an user-provided client object
     if (!configuration.context)
-      snd.seq.close(this->seq);
+      snd.seq->close(this->seq);
   }
 
   libremidi::API get_current_api() const noexcept override { return libremidi::API::ALSA_SEQ; }
@@ -118,9 +119,9 @@ public:
   {
     if (require_timestamps())
     {
-      snd.seq.control_queue(this->seq, this->queue_id, SND_SEQ_EVENT_START, 0, nullptr);
+      snd.seq->control_queue(this->seq, this->queue_id, SND_SEQ_EVENT_START, 0, nullptr);
       this->queue_creation_time = std::chrono::steady_clock::now();
-      snd.seq.drain_output(this->seq);
+      snd.seq->drain_output(this->seq);
     }
   }
 
@@ -128,15 +129,15 @@ public:
   {
     if (require_timestamps())
     {
-      snd.seq.control_queue(this->seq, this->queue_id, SND_SEQ_EVENT_STOP, 0, nullptr);
-      snd.seq.drain_output(this->seq);
+      snd.seq->control_queue(this->seq, this->queue_id, SND_SEQ_EVENT_STOP, 0, nullptr);
+      snd.seq->drain_output(this->seq);
     }
   }
 
   int connect_port(snd_seq_addr_t sender)
   {
     snd_seq_addr_t receiver{};
-    receiver.client = snd.seq.client_id(this->seq);
+    receiver.client = snd.seq->client_id(this->seq);
     receiver.port = this->vport;
 
     return create_connection(*this, sender, receiver, false);
@@ -237,7 +238,7 @@ public:
       auto buf_space = decoding_buffer.size();
 
       // FIXME according to the doc snd_midi_event_decode can apparently return multiple events????
-      const auto avail = snd.midi.event_decode(coder, buf, buf_space, &ev);
+      const auto avail = snd.midi->event_decode(coder, buf, buf_space, &ev);
       if (avail > 0)
       {
         m_processing.on_bytes(
@@ -259,7 +260,7 @@ public:
       snd_seq_event_t* ev{};
       event_handle handle{snd};
       int result = 0;
-      if ((result = snd.seq.event_input(seq, &ev)) > 0)
+      if ((result = snd.seq->event_input(seq, &ev)) > 0)
       {
         handle.reset(ev);
         if (int err = process_event(*ev); err < 0)
@@ -323,7 +324,7 @@ public:
     snd_seq_ump_event_t* ev{};
     event_handle handle{snd};
     int result = 0;
-    while ((result = snd.seq.ump.event_input(seq, &ev)) > 0)
+    while ((result = snd.seq->ump->event_input(seq, &ev)) > 0)
     {
       handle.reset((snd_seq_event_t*)ev);
       if (int err = process_ump_event(*ev); err < 0)
@@ -420,14 +421,16 @@ private:
 
   void thread_handler()
   {
-    int poll_fd_count = alsa_data::snd.seq.poll_descriptors_count(this->seq, POLLIN) + 1;
+    apply_thread_policy(this->configuration.threading, "alsa_seq input");
+
+    int poll_fd_count = alsa_data::snd.seq->poll_descriptors_count(this->seq, POLLIN) + 1;
     auto poll_fds = (struct pollfd*)alloca(poll_fd_count * sizeof(struct pollfd));
     poll_fds[0] = this->termination_event;
-    alsa_data::snd.seq.poll_descriptors(this->seq, poll_fds + 1, poll_fd_count - 1, POLLIN);
+    alsa_data::snd.seq->poll_descriptors(this->seq, poll_fds + 1, poll_fd_count - 1, POLLIN);
 
     for (;;)
     {
-      if (alsa_data::snd.seq.event_input_pending(this->seq, 1) == 0)
+      if (alsa_data::snd.seq->event_input_pending(this->seq, 1) == 0)
       {
         // No data pending
         if (poll(poll_fds, poll_fd_count, 0) >= 0)
@@ -30,12 +30,12 @@ public:
       return;
     }
 
-    if (snd.midi.event_new(this->bufferSize, &this->coder) < 0)
+    if (snd.midi->event_new(this->bufferSize, &this->coder) < 0)
     {
       libremidi_handle_error(this->configuration, "error initializing MIDI event parser.");
       return;
     }
-    snd.midi.event_init(this->coder);
+    snd.midi->event_init(this->coder);
 
     this->client_open_ = stdx::error{};
   }
@@ -47,12 +47,12 @@ public:
 
     // Cleanup.
     if (this->vport >= 0)
-      snd.seq.delete_port(this->seq, this->vport);
+      snd.seq->delete_port(this->seq, this->vport);
     if (this->coder)
-      snd.midi.event_free(this->coder);
+      snd.midi->event_free(this->coder);
 
     if (!configuration.context)
-      snd.seq.close(this->seq);
+      snd.seq->close(this->seq);
 
     client_open_ = std::errc::not_connected;
   }
@@ -86,7 +86,8 @@ public:
     }
 
     snd_seq_addr_t source{
-        .client = (unsigned char)snd.seq.client_id(this->seq), .port = (unsigned char)this->vport};
+        .client = (unsigned char)snd.seq->client_id(this->seq),
+        .port = (unsigned char)this->vport};
     if (int err = create_connection(*this, source, *sink, true); err < 0)
     {
       libremidi_handle_error(configuration, "ALSA error making port connection.");
@@ -125,7 +126,7 @@ public:
     if (size > this->bufferSize)
     {
       this->bufferSize = size;
-      result = snd.midi.event_resize_buffer(this->coder, size);
+      result = snd.midi->event_resize_buffer(this->coder, size);
       if (result != 0)
       {
         libremidi_handle_error(
@@ -147,7 +148,7 @@ public:
       snd_seq_ev_set_direct(&ev);
 
       const int64_t nBytes = size; // signed to avoir potential overflow with size - offset below
-      result = snd.midi.event_encode(this->coder, message + offset, (long)(nBytes - offset), &ev);
+      result = snd.midi->event_encode(this->coder, message + offset, (long)(nBytes - offset), &ev);
       if (result < 0)
       {
         libremidi_handle_warning(this->configuration, "event parsing error!");
@@ -162,14 +163,14 @@ public:
 
       offset += result;
 
-      result = snd.seq.event_output(this->seq, &ev);
+      result = snd.seq->event_output(this->seq, &ev);
       if (result < 0)
       {
         libremidi_handle_warning(this->configuration, "error sending MIDI message to port.");
         return std::errc::io_error;
       }
     }
-    snd.seq.drain_output(this->seq);
+    snd.seq->drain_output(this->seq);
     return stdx::error{};
   }
 
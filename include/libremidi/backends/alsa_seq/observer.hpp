@@ -4,6 +4,7 @@
 #include <libremidi/backends/linux/helpers.hpp>
 #include <libremidi/detail/midi_api.hpp>
 #include <libremidi/detail/observer.hpp>
+#include <libremidi/detail/thread_policy.hpp>
 
 #include <alsa/asoundlib.h>
 
@@ -79,7 +80,7 @@ public:
     // Connect the ALSA server events to our port
     {
       int err
-          = snd.seq.connect_from(seq, vport, SND_SEQ_CLIENT_SYSTEM, SND_SEQ_PORT_SYSTEM_ANNOUNCE);
+          = snd.seq->connect_from(seq, vport, SND_SEQ_CLIENT_SYSTEM, SND_SEQ_PORT_SYSTEM_ANNOUNCE);
       if (err < 0)
       {
         libremidi_handle_error(this->configuration, "error connecting to ALSA sequencer.");
@@ -96,15 +97,15 @@ public:
 
     snd_seq_client_info_t* cinfo;
     snd_seq_client_info_alloca(&cinfo);
-    if (int err = snd.seq.get_any_client_info(seq, client, cinfo); err < 0)
+    if (int err = snd.seq->get_any_client_info(seq, client, cinfo); err < 0)
       return std::nullopt;
 
     snd_seq_port_info_t* pinfo;
     snd_seq_port_info_alloca(&pinfo);
-    if (int err = snd.seq.get_any_port_info(seq, client, port, pinfo); err < 0)
+    if (int err = snd.seq->get_any_port_info(seq, client, port, pinfo); err < 0)
       return std::nullopt;
 
-    const auto tp = snd.seq.port_info_get_type(pinfo);
+    const auto tp = snd.seq->port_info_get_type(pinfo);
     bool ok = this->configuration.track_any;
     if ((tp & SND_SEQ_PORT_TYPE_HARDWARE) && this->configuration.track_hardware)
       ok = true;
@@ -113,13 +114,13 @@ public:
     if (!ok)
       return {};
 
-    if (auto name = snd.seq.client_info_get_name(cinfo))
+    if (auto name = snd.seq->client_info_get_name(cinfo))
       p.client_name = name;
 
-    if (auto name = snd.seq.port_info_get_name(pinfo))
+    if (auto name = snd.seq->port_info_get_name(pinfo))
       p.port_name = name;
 
-    auto cap = snd.seq.port_info_get_capability(pinfo);
+    auto cap = snd.seq->port_info_get_capability(pinfo);
     p.isInput = (cap & SND_SEQ_PORT_CAP_DUPLEX) | (cap & SND_SEQ_PORT_CAP_READ);
     p.isOutput = (cap & SND_SEQ_PORT_CAP_DUPLEX) | (cap & SND_SEQ_PORT_CAP_WRITE);
 
@@ -145,8 +146,8 @@ public:
   {
     alsa_seq::for_all_ports(
         snd, this->seq, [this](snd_seq_client_info_t& client, snd_seq_port_info_t& port) {
-          int clt = snd.seq.client_info_get_client(&client);
-          int pt = snd.seq.port_info_get_port(&port);
+          int clt = snd.seq->client_info_get_client(&client);
+          int pt = snd.seq->port_info_get_port(&port);
           register_port(clt, pt);
         });
   }
@@ -164,8 +165,8 @@ public:
     std::vector<libremidi::input_port> ret;
     alsa_seq::for_all_ports(
         snd, this->seq, [this, &ret](snd_seq_client_info_t& client, snd_seq_port_info_t& port) {
-          int clt = snd.seq.client_info_get_client(&client);
-          int pt = snd.seq.port_info_get_port(&port);
+          int clt = snd.seq->client_info_get_client(&client);
+          int pt = snd.seq->port_info_get_port(&port);
           if (auto p = get_info(clt, pt))
             if (p->isInput)
               ret.push_back(to_port_info<true>(*p));
@@ -178,8 +179,8 @@ public:
     std::vector<libremidi::output_port> ret;
     alsa_seq::for_all_ports(
         snd, this->seq, [this, &ret](snd_seq_client_info_t& client, snd_seq_port_info_t& port) {
-          int clt = snd.seq.client_info_get_client(&client);
-          int pt = snd.seq.port_info_get_port(&port);
+          int clt = snd.seq->client_info_get_client(&client);
+          int pt = snd.seq->port_info_get_port(&port);
           if (auto p = get_info(clt, pt))
             if (p->isOutput)
               ret.push_back(to_port_info<false>(*p));
@@ -193,7 +194,7 @@ public:
     if (!pp)
       return;
     auto& p = *pp;
-    if (p.client == snd.seq.client_id(seq))
+    if (p.client == snd.seq->client_id(seq))
       return;
 
     knownClients_[{p.client, p.port}] = p;
@@ -251,10 +252,10 @@ public:
     if (seq)
     {
       if (vport)
-        snd.seq.delete_port(seq, vport);
+        snd.seq->delete_port(seq, vport);
 
       if (!configuration.context)
-        snd.seq.close(seq);
+        snd.seq->close(seq);
     }
   }
 
@@ -271,13 +272,15 @@ public:
   {
     // Create relevant descriptors
     auto& snd = alsa_data::snd;
-    const auto N = snd.seq.poll_descriptors_count(this->seq, POLLIN);
+    const auto N = snd.seq->poll_descriptors_count(this->seq, POLLIN);
     descriptors_.resize(N + 1);
-    snd.seq.poll_descriptors(this->seq, descriptors_.data(), N, POLLIN);
+    snd.seq->poll_descriptors(this->seq, descriptors_.data(), N, POLLIN);
     descriptors_.back() = this->termination_event;
 
     // Start the listening thread
     thread = std::thread{[this] {
+      apply_thread_policy(this->configuration.threading, "alsa_seq observer");
+
       auto& snd = alsa_data::snd;
       for (;;)
       {
@@ -290,7 +293,7 @@ public:
 
           snd_seq_event_t* ev{};
           event_handle handle{snd};
-          while (snd.seq.event_input(this->seq, &ev) >= 0)
+          while (snd.seq->event_input(this->seq, &ev) >= 0)
           {
             handle.reset(ev);
             this->handle_event(*ev);
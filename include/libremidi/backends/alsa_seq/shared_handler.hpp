@@ -1,13 +1,16 @@
 #pragma once
-#if __has_include(<boost/lockfree/spsc_queue.hpp>)
-  #include <libremidi/backends/alsa_seq/config.hpp>
-  #include <libremidi/backends/alsa_seq/helpers.hpp>
-  #include <libremidi/backends/linux/helpers.hpp>
-  #include <libremidi/shared_context.hpp>
-
-  #include <boost/lockfree/spsc_queue.hpp>
-
-  #include <variant>
+#include <libremidi/backends/alsa_seq/config.hpp>
+#include <libremidi/backends/alsa_seq/helpers.hpp>
+#include <libremidi/backends/linux/helpers.hpp>
+#include <libremidi/detail/thread_policy.hpp>
+#include <libremidi/shared_context.hpp>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
 
 namespace libremidi::alsa_seq
 {
@@ -15,17 +18,12 @@ namespace libremidi::alsa_seq
 struct shared_handler : public libremidi::shared_context
 {
   const libasound& snd = libasound::instance();
-  struct equals_addr
-  {
-    constexpr bool operator()(const snd_seq_addr_t& lhs, const snd_seq_addr_t& rhs) noexcept
-    {
-      return lhs.client == rhs.client && lhs.port == rhs.port;
-    }
-  };
 
-  explicit shared_handler(std::string_view v)
+  explicit shared_handler(std::string_view v, thread_policy policy = {})
+      : policy{std::move(policy)}
   {
-    if (int err = snd.seq.open(&client, "default", SND_SEQ_OPEN_DUPLEX, SND_SEQ_NONBLOCK); err < 0)
+    if (int err = snd.seq->open(&client, "default", SND_SEQ_OPEN_DUPLEX, SND_SEQ_NONBLOCK);
+        err < 0)
     {
       client = nullptr;
       // fixme throw?
@@ -33,20 +31,23 @@ struct shared_handler : public libremidi::shared_context
     }
 
     if (!v.empty())
-      snd.seq.set_client_name(client, v.data());
+      snd.seq->set_client_name(client, v.data());
+    client_id = snd.seq->client_id(client);
 
     // Last descriptor is the eventfd one
-    int fds_size = snd.seq.poll_descriptors_count(client, POLLIN);
-    fds.reserve(fds_size + 2);
+    int fds_size = snd.seq->poll_descriptors_count(client, POLLIN);
+    fds.reserve(fds_size + 1);
     fds.resize(fds_size);
-    snd.seq.poll_descriptors(client, fds.data(), fds_size, POLLIN);
+    snd.seq->poll_descriptors(client, fds.data(), fds_size, POLLIN);
     fds.push_back(termination_event);
-    fds.push_back(queue_event);
   }
 
   void start_processing() override
   {
-    thread = std::thread{[this] { process(); }};
+    thread = std::thread{[this] {
+      apply_thread_policy(policy, "alsa_seq shared context");
+      process();
+    }};
   }
 
   void stop_processing() override
@@ -57,28 +58,20 @@ struct shared_handler : public libremidi::shared_context
     termination_event.consume();
   }
 
-  static shared_configurations make(std::string_view client_name)
+  static shared_configurations make(std::string_view client_name, thread_policy policy = {})
   {
-    auto clt = std::make_shared<shared_handler>(client_name);
+    auto clt = std::make_shared<shared_handler>(client_name, std::move(policy));
 
     auto cb = [client = std::weak_ptr{clt}](const libremidi::alsa_seq::poll_parameters& params) {
       if (auto clt = client.lock())
-      {
-        clt->events.push(
-            {.type = shared_handler::event_type::callback_added, .payload = std::move(params)});
-        clt->queue_event.notify();
-      }
-      return true;
+        return clt->add(params);
+      return false;
     };
 
     auto stop_cb = [client = std::weak_ptr{clt}](snd_seq_addr_t id) {
       if (auto clt = client.lock())
-      {
-        clt->events.push(
-            {.type = shared_handler::event_type::callback_removed, .payload = std::move(id)});
-        clt->queue_event.notify();
-      }
-      return true;
+        return clt->remove(id);
+      return false;
     };
     return {
         .context = clt,
@@ -90,19 +83,38 @@ struct shared_handler : public libremidi::shared_context
     };
   }
 
-  int64_t index_of_address(snd_seq_addr_t addr)
+  // Registrations are applied immediately: there is no queue which could fill up,
+  // and once remove() returns the callback will not be invoked anymore.
+  bool add(const libremidi::alsa_seq::poll_parameters& params)
   {
-    auto it = std::find_if(addresses.begin(), addresses.end(), [=](snd_seq_addr_t other) {
-      return equals_addr{}(addr, other);
-    });
-    if (it != addresses.end())
-    {
-      return std::distance(addresses.begin(), it);
-    }
-    else
-    {
-      return -1;
-    }
+    if (params.addr.client != client_id)
+      return false;
+
+    std::lock_guard _{mutex};
+    callbacks[params.addr.port]
+        = std::make_shared<std::function<int(const snd_seq_event_t&)>>(params.callback);
+    return true;
+  }
+
+  bool remove(snd_seq_addr_t addr)
+  {
+    if (addr.client != client_id)
+      return false;
+
+    std::lock_guard _{mutex};
+    return std::exchange(callbacks[addr.port], nullptr) != nullptr;
+  }
+
+  // Dispatch the event to the correct observer or midi_in object
+  int dispatch(const snd_seq_event_t& ev)
+  {
+    if (ev.dest.client != client_id)
+      return 0;
+
+    // Keeps the callback alive if it closes its own port
+    if (auto cb = callbacks[ev.dest.port])
+      return (*cb)(ev);
+    return 0;
   }
 
   void process()
@@ -113,85 +125,59 @@ struct shared_handler : public libremidi::shared_context
       if (err < 0)
         return;
       // Check for termination signal
-      if (termination_event.ready(fds[fds.size() - 2]))
+      if (termination_event.ready(fds.back()))
         return;
 
-      // Check for queue processing signal
-      if (queue_event.ready(fds[fds.size() - 1]))
-      {
-        this->queue_event.consume();
+      if (!std::any_of(fds.begin(), fds.end() - 1, [](const pollfd& p) {
+            return p.revents & POLLIN;
+          }))
+        continue;
 
-        event ev;
-        while (this->events.pop(ev))
-        {
-          switch (ev.type)
-          {
-            case callback_added: {
-              auto [addr, cb]
-                  = std::move(*std::get_if<libremidi::alsa_seq::poll_parameters>(&ev.payload));
-              addresses.push_back(addr);
-              callbacks.push_back(std::move(cb));
-              break;
-            }
-            case callback_removed:
-              auto addr = std::move(*std::get_if<snd_seq_addr_t>(&ev.payload));
-              if (auto index = index_of_address(addr); index >= 0)
-              {
-                addresses.erase(addresses.begin() + index);
-                callbacks.erase(callbacks.begin() + index);
-              }
-              break;
-          }
-        }
-      }
+      std::lock_guard _{mutex};
 
-      // Look for who's ready
-      for (int64_t i = 0, N = std::ssize(fds) - 2; i < N; i++)
+      // Fetch everything the kernel has for us at once, then empty the userspace buffer
+      snd_seq_event_t* ev{};
+      event_handle handle{snd};
+      while (snd.seq->event_input_pending(client, 1) > 0)
       {
-        if (fds[i].revents & POLLIN)
+        do
         {
-          // Read alsa event
-          snd_seq_event_t* ev{};
-          event_handle handle{snd};
-          int result = 0;
-          while ((result = snd.seq.event_input(client, &ev)) > 0)
+          // -ENOSPC: the kernel queue overflowed, the events we got are still valid
+          if (int res = snd.seq->event_input(client, &ev); res < 0)
           {
-            handle.reset(ev);
-
-            if (auto index = index_of_address(ev->dest); index >= 0)
-            {
-              // Dispatch the event to the correct observer or midi_in object
-              int err = callbacks[index](*ev);
-              if (err < 0 && err != -EAGAIN)
-                return;
-            }
+            if (res == -ENOSPC)
+              continue;
+            break;
           }
-        }
+          handle.reset(ev);
+
+          int err = dispatch(*ev);
+          if (err < 0 && err != -EAGAIN)
+            return;
+        } while (snd.seq->event_input_pending(client, 0) > 0);
       }
     }
   }
 
-  ~shared_handler() { snd.seq.close(client); }
-
-  enum event_type
+  ~shared_handler()
   {
-    callback_added,
-    callback_removed,
-  };
-  struct event
-  {
-    event_type type;
-    std::variant<libremidi::alsa_seq::poll_parameters, snd_seq_addr_t> payload;
-  };
+    stop_processing();
+    if (client)
+      snd.seq->close(client);
+  }
 
   snd_seq_t* client{};
+  int client_id{-1};
+  thread_policy policy;
+
+  // Recursive as ports can be opened and closed from the callbacks
+  std::recursive_mutex mutex;
+
+  // All the ports belong to our client: the port number is enough to find the recipient
+  std::array<std::shared_ptr<std::function<int(const snd_seq_event_t&)>>, 256> callbacks;
 
-  boost::lockfree::spsc_queue<event> events{16};
-  std::vector<snd_seq_addr_t> addresses;
-  std::vector<std::function<int(const snd_seq_event_t&)>> callbacks;
   std::vector<pollfd> fds;
-  eventfd_notifier termination_event, queue_event{false};
+  eventfd_notifier termination_event;
   std::thread thread;
 };
 }
-#endif
@@ -56,7 +56,7 @@ struct backend
   static inline bool available() noexcept
   {
     static const libasound& snd = libasound::instance();
-    return snd.available && snd.seq.available && snd.seq.ump.available && snd.ump.available;
+    return snd.available && snd.seq->available && snd.seq->ump->available && snd.ump->available;
   }
 };
 }
@@ -24,7 +24,7 @@ public:
       libremidi::output_configuration&& conf, alsa_seq_ump::output_configuration&& apiconf)
       : configuration{std::move(conf), std::move(apiconf)}
   {
-    assert(snd.seq.ump.available);
+    assert(snd.seq->ump->available);
     if (init_client(configuration) < 0)
     {
       libremidi_handle_error(
@@ -44,10 +44,10 @@ public:
 
     // Cleanup.
     if (this->vport >= 0)
-      snd.seq.delete_port(this->seq, this->vport);
+      snd.seq->delete_port(this->seq, this->vport);
 
     if (!configuration.context)
-      snd.seq.close(this->seq);
+      snd.seq->close(this->seq);
 
     client_open_ = std::errc::not_connected;
   }
@@ -82,7 +82,8 @@ public:
     }
 
     snd_seq_addr_t source{
-        .client = (unsigned char)snd.seq.client_id(this->seq), .port = (unsigned char)this->vport};
+        .client = (unsigned char)snd.seq->client_id(this->seq),
+        .port = (unsigned char)this->vport};
     if (int err = create_connection(*this, source, *sink, true); err < 0)
     {
       libremidi_handle_error(configuration, "ALSA error making port connection.");
@@ -127,7 +128,7 @@ public:
 
     auto write_func = [this, &ev](const uint32_t* ump, int64_t bytes) -> std::errc {
       std::memcpy(ev.ump, ump, bytes);
-      const int ret = snd.seq.ump.event_output_direct(this->seq, &ev);
+      const int ret = snd.seq->ump->event_output_direct(this->seq, &ev);
       if (ret < 0)
       {
         libremidi_handle_warning(this->configuration, "error sending MIDI message to port.");
@@ -137,7 +138,7 @@ public:
     };
     segment_ump_stream(ump_stream, count, write_func, []() {});
 
-    snd.seq.drain_output(this->seq);
+    snd.seq->drain_output(this->seq);
     return stdx::error{};
   }
 
@@ -18,6 +18,9 @@
 namespace libremidi
 {
 
+//! The symbols of each subsystem (sequencer, rawmidi, ump, ctl...) are only
+//! resolved the first time the subsystem is used, e.g. snd.seq->open(...):
+//! opening a sequencer client does not pay for the rawmidi and UMP functions.
 struct libasound
 {
   // Useful one-liner:
@@ -64,14 +67,15 @@ struct libasound
 
     LIBREMIDI_SYMBOL_DEF(snd_card, get_name);
     LIBREMIDI_SYMBOL_DEF(snd_card, next);
-  } card{library};
+  };
+  lazy_symbols<card_t> card{library, "alsa card"};
 
   struct ctl_t
   {
     explicit ctl_t(const dylib_loader& library)
-        : rawmidi{library}
+        : rawmidi{library, "alsa ctl rawmidi"}
 #if LIBREMIDI_ALSA_HAS_UMP
-        , ump{library}
+        , ump{library, "alsa ctl ump"}
 #endif
     {
       if (!library)
@@ -104,7 +108,8 @@ struct libasound
       bool available{true};
       LIBREMIDI_SYMBOL_DEF(snd_ctl_rawmidi, info);
       LIBREMIDI_SYMBOL_DEF(snd_ctl_rawmidi, next_device);
-    } rawmidi;
+    };
+    lazy_symbols<rawmidi_t> rawmidi;
 
 #if LIBREMIDI_ALSA_HAS_UMP
     struct ump_t
@@ -125,9 +130,11 @@ struct libasound
       LIBREMIDI_SYMBOL_DEF(snd_ctl_ump, block_info);
       LIBREMIDI_SYMBOL_DEF(snd_ctl_ump, endpoint_info);
       LIBREMIDI_SYMBOL_DEF(snd_ctl_ump, next_device);
-    } ump;
+    };
+    lazy_symbols<ump_t> ump;
 #endif
-  } ctl{library};
+  };
+  lazy_symbols<ctl_t> ctl{library, "alsa ctl"};
 
   struct midi_t
   {
@@ -156,7 +163,8 @@ struct libasound
     LIBREMIDI_SYMBOL_DEF(snd_midi, event_new);
     LIBREMIDI_SYMBOL_DEF(snd_midi, event_no_status);
     LIBREMIDI_SYMBOL_DEF(snd_midi, event_resize_buffer);
-  } midi{library};
+  };
+  lazy_symbols<midi_t> midi{library, "alsa midi"};
 
 #if LIBREMIDI_ALSA_HAS_RAMWIDI
   struct rawmidi_t
@@ -221,14 +229,15 @@ struct libasound
     LIBREMIDI_SYMBOL_DEF(snd_rawmidi, status_sizeof);
     LIBREMIDI_SYMBOL_DEF(snd_rawmidi, tread);
     LIBREMIDI_SYMBOL_DEF(snd_rawmidi, write);
-  } rawmidi{library};
+  };
+  lazy_symbols<rawmidi_t> rawmidi{library, "alsa rawmidi"};
 #endif
 
   struct seq_t
   {
     explicit seq_t(const dylib_loader& library)
 #if LIBREMIDI_ALSA_HAS_UMP
-        : ump{library}
+        : ump{library, "alsa seq ump"}
 #endif
     {
       if (!library)
@@ -372,9 +381,11 @@ struct libasound
       LIBREMIDI_SYMBOL_DEF(snd_seq_ump, event_input);
       LIBREMIDI_SYMBOL_DEF(snd_seq_ump, event_output);
       LIBREMIDI_SYMBOL_DEF(snd_seq_ump, event_output_direct);
-    } ump;
+    };
+    lazy_symbols<ump_t> ump;
 #endif
-  } seq{library};
+  };
+  lazy_symbols<seq_t> seq{library, "alsa seq"};
 
 #if LIBREMIDI_ALSA_HAS_UMP
   struct ump_t
@@ -420,20 +431,22 @@ struct libasound
     LIBREMIDI_SYMBOL_DEF(snd_ump, read);
     LIBREMIDI_SYMBOL_DEF(snd_ump, tread);
     LIBREMIDI_SYMBOL_DEF(snd_ump, write);
-  } ump{library};
+  };
+  lazy_symbols<ump_t> ump{library, "alsa ump"};
 #endif
 };
 
 #undef snd_dylib_alloca
-#define snd_dylib_alloca(ptr, access, type)                                \
-  {                                                                        \
-    *ptr = (snd_##access##_##type##_t*)alloca(snd.access.type##_sizeof()); \
-    memset(*ptr, 0, snd.access.type##_sizeof());                           \
+#define snd_dylib_alloca(ptr, access, type)                                 \
+  {                                                                         \
+    *ptr = (snd_##access##_##type##_t*)alloca(snd.access->type##_sizeof()); \
+    memset(*ptr, 0, snd.access->type##_sizeof());                           \
   }
-#define snd_dylib_alloca2(ptr, access1, access2, type)                                         \
-  {                                                                                            \
-    *ptr = (snd_##access1##_access2##_##type##_t*)alloca(snd.access1.access2.type##_sizeof()); \
-    memset(*ptr, 0, snd.access1.access2.type##_sizeof());                                      \
+#define snd_dylib_alloca2(ptr, access1, access2, type)                  \
+  {                                                                     \
+    *ptr = (snd_##access1##_access2##_##type##_t*)alloca(               \
+        snd.access1->access2->type##_sizeof());                         \
+    memset(*ptr, 0, snd.access1->access2->type##_sizeof());             \
   }
 
 #undef snd_rawmidi_info_alloca
@@ -1,8 +1,12 @@
 #pragma once
 #if __has_include(<dlfcn.h>)
+  #include <libremidi/detail/startup_profile.hpp>
+
   #include <dlfcn.h>
 
   #include <cassert>
+  #include <mutex>
+  #include <optional>
 
 namespace libremidi
 {
@@ -11,6 +15,7 @@ class dylib_loader
 public:
   explicit dylib_loader(const char* const so)
   {
+    detail::startup_timer _{startup_phase::library_load, so};
     impl = dlopen(so, RTLD_LAZY | RTLD_LOCAL | RTLD_NODELETE);
   }
 
@@ -50,6 +55,39 @@ private:
   void* impl{};
 };
 
+//! Resolves a group of symbols the first time it is accessed, instead of when the
+//! library is loaded: T is a struct resolving its symbols in its constructor,
+//! and setting its "available" member to false if one of them is missing.
+template <typename T>
+class lazy_symbols
+{
+public:
+  lazy_symbols(const dylib_loader& library, std::string_view name) noexcept
+      : m_library{library}
+      , m_name{name}
+  {
+  }
+
+  lazy_symbols(const lazy_symbols&) = delete;
+  lazy_symbols& operator=(const lazy_symbols&) = delete;
+
+  const T& get() const
+  {
+    std::call_once(m_once, [this] {
+      detail::startup_timer _{startup_phase::symbol_resolution, m_name};
+      m_symbols.emplace(m_library);
+    });
+    return *m_symbols;
+  }
+
+  const T* operator->() const { return &get(); }
+
+private:
+  const dylib_loader& m_library;
+  std::string_view m_name;
+  mutable std::once_flag m_once;
+  mutable std::optional<T> m_symbols;
+};
 }
 
   #define LIBREMIDI_SYMBOL_NAME_S(prefix, name) #prefix "_" #name
@@ -11,6 +11,9 @@ namespace libremidi
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 class libpipewire
 {
+  // Declared first: the lazy symbol groups refer to it
+  dylib_loader library;
+
 public:
   decltype(&::pw_init) init{};
   decltype(&::pw_deinit) deinit{};
@@ -43,20 +46,50 @@ public:
   decltype(&::pw_properties_free) properties_free{};
   decltype(&::pw_properties_get) properties_get{};
 
-  decltype(&::pw_filter_new_simple) filter_new_simple{};
-  decltype(&::pw_filter_get_node_id) filter_get_node_id{};
-  decltype(&::pw_filter_get_properties) filter_get_properties{};
-  decltype(&::pw_filter_add_port) filter_add_port{};
-  decltype(&::pw_filter_remove_port) filter_remove_port{};
-  decltype(&::pw_filter_update_properties) filter_update_properties{};
-  decltype(&::pw_filter_update_params) filter_update_params{};
-  decltype(&::pw_filter_get_time) filter_get_time{};
-  decltype(&::pw_filter_destroy) filter_destroy{};
-  decltype(&::pw_filter_connect) filter_connect{};
-  decltype(&::pw_filter_get_dsp_buffer) filter_get_dsp_buffer{};
-  decltype(&::pw_filter_queue_buffer) filter_queue_buffer{};
-  decltype(&::pw_filter_dequeue_buffer) filter_dequeue_buffer{};
-  decltype(&::pw_filter_flush) filter_flush{};
+  //! Only needed by the inputs and outputs, resolved on first use, e.g. pw.filter->connect(...)
+  struct filter_t
+  {
+    explicit filter_t(const dylib_loader& library)
+    {
+      if (!library)
+      {
+        available = false;
+        return;
+      }
+
+      LIBREMIDI_SYMBOL_INIT(pw_filter, new_simple);
+      LIBREMIDI_SYMBOL_INIT(pw_filter, get_node_id);
+      LIBREMIDI_SYMBOL_INIT(pw_filter, get_properties);
+      LIBREMIDI_SYMBOL_INIT(pw_filter, add_port);
+      LIBREMIDI_SYMBOL_INIT(pw_filter, remove_port);
+      LIBREMIDI_SYMBOL_INIT(pw_filter, update_properties);
+      LIBREMIDI_SYMBOL_INIT(pw_filter, update_params);
+      LIBREMIDI_SYMBOL_INIT(pw_filter, get_time);
+      LIBREMIDI_SYMBOL_INIT(pw_filter, destroy);
+      LIBREMIDI_SYMBOL_INIT(pw_filter, connect);
+      LIBREMIDI_SYMBOL_INIT(pw_filter, get_dsp_buffer);
+      LIBREMIDI_SYMBOL_INIT(pw_filter, queue_buffer);
+      LIBREMIDI_SYMBOL_INIT(pw_filter, dequeue_buffer);
+      LIBREMIDI_SYMBOL_INIT(pw_filter, flush);
+    }
+    bool available{true};
+
+    LIBREMIDI_SYMBOL_DEF(pw_filter, new_simple);
+    LIBREMIDI_SYMBOL_DEF(pw_filter, get_node_id);
+    LIBREMIDI_SYMBOL_DEF(pw_filter, get_properties);
+    LIBREMIDI_SYMBOL_DEF(pw_filter, add_port);
+    LIBREMIDI_SYMBOL_DEF(pw_filter, remove_port);
+    LIBREMIDI_SYMBOL_DEF(pw_filter, update_properties);
+    LIBREMIDI_SYMBOL_DEF(pw_filter, update_params);
+    LIBREMIDI_SYMBOL_DEF(pw_filter, get_time);
+    LIBREMIDI_SYMBOL_DEF(pw_filter, destroy);
+    LIBREMIDI_SYMBOL_DEF(pw_filter, connect);
+    LIBREMIDI_SYMBOL_DEF(pw_filter, get_dsp_buffer);
+    LIBREMIDI_SYMBOL_DEF(pw_filter, queue_buffer);
+    LIBREMIDI_SYMBOL_DEF(pw_filter, dequeue_buffer);
+    LIBREMIDI_SYMBOL_DEF(pw_filter, flush);
+  };
+  lazy_symbols<filter_t> filter{library, "pipewire filter"};
 
   static const libpipewire& instance()
   {
@@ -67,8 +100,6 @@ public:
   bool available{true};
 
 private:
-  dylib_loader library;
-
   libpipewire()
       : library("libpipewire-0.3.so.0")
   {
@@ -105,28 +136,6 @@ private:
     properties_free = library.symbol<decltype(&::pw_properties_free)>("pw_properties_free");
     properties_get = library.symbol<decltype(&::pw_properties_get)>("pw_properties_get");
 
-    filter_new_simple = library.symbol<decltype(&::pw_filter_new_simple)>("pw_filter_new_simple");
-    filter_get_node_id
-        = library.symbol<decltype(&::pw_filter_get_node_id)>("pw_filter_get_node_id");
-    filter_get_properties
-        = library.symbol<decltype(&::pw_filter_get_properties)>("pw_filter_get_properties");
-    filter_add_port = library.symbol<decltype(&::pw_filter_add_port)>("pw_filter_add_port");
-    filter_remove_port
-        = library.symbol<decltype(&::pw_filter_remove_port)>("pw_filter_remove_port");
-    filter_update_properties
-        = library.symbol<decltype(&::pw_filter_update_properties)>("pw_filter_update_properties");
-    filter_update_params
-        = library.symbol<decltype(&::pw_filter_update_params)>("pw_filter_update_params");
-    filter_get_time = library.symbol<decltype(&::pw_filter_get_time)>("pw_filter_get_time");
-    filter_destroy = library.symbol<decltype(&::pw_filter_destroy)>("pw_filter_destroy");
-    filter_connect = library.symbol<decltype(&::pw_filter_connect)>("pw_filter_connect");
-    filter_get_dsp_buffer
-        = library.symbol<decltype(&::pw_filter_get_dsp_buffer)>("pw_filter_get_dsp_buffer");
-    filter_dequeue_buffer
-        = library.symbol<decltype(&::pw_filter_dequeue_buffer)>("pw_filter_dequeue_buffer");
-    filter_queue_buffer
-        = library.symbol<decltype(&::pw_filter_queue_buffer)>("pw_filter_queue_buffer");
-    filter_flush = library.symbol<decltype(&::pw_filter_flush)>("pw_filter_flush");
 
     assert(init);
     assert(deinit);
@@ -149,20 +158,6 @@ private:
     assert(properties_free);
     assert(properties_get);
 
-    assert(filter_new_simple);
-    assert(filter_get_node_id);
-    assert(filter_get_properties);
-    assert(filter_add_port);
-    assert(filter_remove_port);
-    assert(filter_update_properties);
-    assert(filter_update_params);
-    assert(filter_get_time);
-    assert(filter_destroy);
-    assert(filter_connect);
-    assert(filter_get_dsp_buffer);
-    assert(filter_dequeue_buffer);
-    assert(filter_queue_buffer);
-    assert(filter_flush);
   }
 };
 #pragma GCC diagnostic pop
@@ -24,9 +24,12 @@ struct libudev
     }
 
     LIBREMIDI_SYMBOL_INIT(udev, device_get_action);
+    LIBREMIDI_SYMBOL_INIT(udev, device_get_property_value);
     LIBREMIDI_SYMBOL_INIT(udev, device_get_subsystem);
+    LIBREMIDI_SYMBOL_INIT(udev, device_get_sysname);
     LIBREMIDI_SYMBOL_INIT(udev, device_unref);
     LIBREMIDI_SYMBOL_INIT(udev, monitor_enable_receiving);
+    LIBREMIDI_SYMBOL_INIT(udev, monitor_filter_add_match_subsystem_devtype);
     LIBREMIDI_SYMBOL_INIT(udev, monitor_get_fd);
     LIBREMIDI_SYMBOL_INIT(udev, monitor_new_from_netlink);
     LIBREMIDI_SYMBOL_INIT(udev, monitor_receive_device);
@@ -45,9 +48,12 @@ struct libudev
   bool available{true};
 
   LIBREMIDI_SYMBOL_DEF(udev, device_get_action);
+  LIBREMIDI_SYMBOL_DEF(udev, device_get_property_value);
   LIBREMIDI_SYMBOL_DEF(udev, device_get_subsystem);
+  LIBREMIDI_SYMBOL_DEF(udev, device_get_sysname);
   LIBREMIDI_SYMBOL_DEF(udev, device_unref);
   LIBREMIDI_SYMBOL_DEF(udev, monitor_enable_receiving);
+  LIBREMIDI_SYMBOL_DEF(udev, monitor_filter_add_match_subsystem_devtype);
   LIBREMIDI_SYMBOL_DEF(udev, monitor_get_fd);
   LIBREMIDI_SYMBOL_DEF(udev, monitor_new_from_netlink);
   LIBREMIDI_SYMBOL_DEF(udev, monitor_receive_device);
@@ -58,13 +64,16 @@ struct libudev
 
 struct udev_helper
 {
-  udev_helper()
+  //! If a subsystem is given, the kernel only wakes us up for the events of this subsystem
+  explicit udev_helper(const char* subsystem = nullptr)
   {
     instance = udev.create();
     assert(instance);
 
     monitor = udev.monitor_new_from_netlink(instance, "udev");
     assert(monitor);
+    if (subsystem)
+      udev.monitor_filter_add_match_subsystem_devtype(monitor, subsystem, nullptr);
     udev.monitor_enable_receiving(monitor);
   }
 
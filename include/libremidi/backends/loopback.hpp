@@ -0,0 +1,29 @@
+#pragma once
+#include <libremidi/backends/loopback/midi_in.hpp>
+#include <libremidi/backends/loopback/midi_out.hpp>
+#include <libremidi/backends/loopback/observer.hpp>
+
+//*********************************************************************//
+//  API: in-process loopback
+//
+//  Fully functional without any hardware or sound server: useful for
+//  testing and benchmarking applications and libremidi itself.
+//*********************************************************************//
+
+namespace libremidi::loopback
+{
+struct backend
+{
+  using midi_in = loopback::midi_in_impl;
+  using midi_out = loopback::midi_out_impl;
+  using midi_observer = loopback::observer_impl;
+  using midi_in_configuration = loopback::input_configuration;
+  using midi_out_configuration = loopback::output_configuration;
+  using midi_observer_configuration = loopback::observer_configuration;
+  static const constexpr auto API = libremidi::API::LOOPBACK;
+  static const constexpr auto name = "loopback";
+  static const constexpr auto display_name = "Loopback";
+
+  static constexpr inline bool available() noexcept { return true; }
+};
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <libremidi/config.hpp>
+#include <libremidi/thread_policy.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace libremidi::loopback
+{
+class context;
+
+struct context_configuration
+{
+  //! Fixed delay between the moment a message is sent and the moment it is received
+  std::chrono::nanoseconds latency{};
+
+  //! Random delay added to the latency, uniformly distributed in [0; jitter].
+  //! Messages going to a given input are never reordered, like on a real MIDI cable.
+  std::chrono::nanoseconds jitter{};
+
+  //! Seed of the jitter generator, for reproducible runs
+  uint64_t seed = 0x9E3779B97F4A7C15ULL;
+
+  //! Maximum number of in-flight messages per input, 0 for unbounded.
+  //! Sending to a full input fails with std::errc::no_buffer_space.
+  std::size_t capacity{};
+
+  //! If true, time only moves forward when context::advance is called,
+  //! and delayed messages are delivered from inside advance().
+  //! Otherwise, the steady clock is used and delayed messages are delivered
+  //! from a thread created on demand.
+  bool virtual_clock{};
+
+  //! Scheduling of the delivery thread
+  thread_policy threading{};
+};
+
+//! All the loopback objects created with the same context can see each other.
+//! If no context is given, a process-wide default one is used.
+struct input_configuration
+{
+  std::shared_ptr<loopback::context> context{};
+};
+
+struct output_configuration
+{
+  std::shared_ptr<loopback::context> context{};
+};
+
+struct observer_configuration
+{
+  std::shared_ptr<loopback::context> context{};
+};
+}
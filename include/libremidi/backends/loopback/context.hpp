@@ -0,0 +1,358 @@
+#pragma once
+#include <libremidi/backends/loopback/config.hpp>
+#include <libremidi/detail/midi_stream_decoder.hpp>
+#include <libremidi/detail/thread_policy.hpp>
+#include <libremidi/error.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace libremidi::loopback
+{
+//! An in-process MIDI "server".
+//! Outputs opened as virtual ports are seen as inputs by the observer and vice versa,
+//! exactly like with e.g. the ALSA sequencer or JACK.
+class context
+{
+public:
+  struct endpoint
+  {
+    uint64_t id{};
+    std::string name;
+
+    // A source is written to by a midi_out and read by midi_in's which subscribe to it.
+    // A sink is created by a midi_in and written to by midi_out's.
+    bool is_source{};
+  };
+
+  //! Implemented by the midi_in objects
+  class receiver
+  {
+  public:
+    virtual ~receiver() = default;
+    virtual void deliver(std::span<const uint8_t> bytes, int64_t timestamp) = 0;
+
+  private:
+    friend class context;
+    std::size_t in_flight{};
+    int64_t last_due{};
+  };
+
+  //! Implemented by the observer objects
+  class listener
+  {
+  public:
+    virtual ~listener() = default;
+    virtual void on_endpoint_added(const endpoint&) = 0;
+    virtual void on_endpoint_removed(const endpoint&) = 0;
+  };
+
+  context()
+      : context{context_configuration{}}
+  {
+  }
+
+  explicit context(context_configuration conf)
+      : m_conf{conf}
+      , m_rng_state{conf.seed}
+  {
+  }
+
+  context(const context&) = delete;
+  context(context&&) = delete;
+  context& operator=(const context&) = delete;
+  context& operator=(context&&) = delete;
+
+  ~context()
+  {
+    {
+      std::lock_guard _{m_mutex};
+      m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable())
+      m_thread.join();
+  }
+
+  const context_configuration& configuration() const noexcept { return m_conf; }
+
+  //! Current time of the context in nanoseconds.
+  //! With a virtual clock, this starts at zero.
+  int64_t now() const noexcept
+  {
+    if (m_conf.virtual_clock)
+      return m_now.load(std::memory_order_acquire);
+    else
+      return system_ns();
+  }
+
+  //! Virtual clock only: move time forward and deliver the messages which became due,
+  //! in order, from the calling thread.
+  void advance(std::chrono::nanoseconds duration)
+  {
+    if (!m_conf.virtual_clock)
+      return;
+
+    std::lock_guard _{m_mutex};
+    const int64_t target = m_now.load(std::memory_order_relaxed) + duration.count();
+    while (!m_pending.empty() && m_pending.front().due <= target)
+    {
+      // Messages sent from a callback during delivery see the time of the delivered message
+      m_now.store(m_pending.front().due, std::memory_order_release);
+      deliver_one();
+    }
+    m_now.store(target, std::memory_order_release);
+  }
+
+  //! Number of messages sent but not delivered yet
+  std::size_t pending() const
+  {
+    std::lock_guard _{m_mutex};
+    return m_pending.size();
+  }
+
+  std::vector<endpoint> endpoints() const
+  {
+    std::lock_guard _{m_mutex};
+    std::vector<endpoint> ret;
+    ret.reserve(m_endpoints.size());
+    for (auto& e : m_endpoints)
+      ret.push_back(e.ep);
+    return ret;
+  }
+
+  uint64_t add_endpoint(std::string_view name, bool is_source, receiver* owner)
+  {
+    std::lock_guard _{m_mutex};
+    endpoint ep{.id = ++m_last_id, .name = std::string(name), .is_source = is_source};
+    m_endpoints.push_back({.ep = ep, .owner = owner});
+
+    // Copied as listeners may be added or removed from the callbacks
+    for (auto* l : std::vector<listener*>(m_listeners))
+      l->on_endpoint_added(ep);
+    return ep.id;
+  }
+
+  void remove_endpoint(uint64_t id)
+  {
+    std::lock_guard _{m_mutex};
+    auto it = std::find_if(
+        m_endpoints.begin(), m_endpoints.end(), [=](auto& e) { return e.ep.id == id; });
+    if (it == m_endpoints.end())
+      return;
+
+    const auto ep = std::move(it->ep);
+    m_endpoints.erase(it);
+    std::erase_if(m_subscriptions, [=](auto& s) { return s.source == id; });
+
+    for (auto* l : std::vector<listener*>(m_listeners))
+      l->on_endpoint_removed(ep);
+  }
+
+  bool subscribe(uint64_t source, receiver& r)
+  {
+    std::lock_guard _{m_mutex};
+    auto e = find_endpoint(source);
+    if (!e || !e->ep.is_source)
+      return false;
+    m_subscriptions.push_back({source, &r});
+    return true;
+  }
+
+  //! Removes all the subscriptions and in-flight messages of a receiver.
+  //! Once this returns, the receiver will not be called anymore.
+  void unsubscribe(receiver& r)
+  {
+    std::lock_guard _{m_mutex};
+    std::erase_if(m_subscriptions, [&](auto& s) { return s.target == &r; });
+    if (std::erase_if(m_pending, [&](auto& p) { return p.target == &r; }) > 0)
+      std::make_heap(m_pending.begin(), m_pending.end(), pending_compare{});
+    r.in_flight = 0;
+  }
+
+  void add_listener(listener& l)
+  {
+    std::lock_guard _{m_mutex};
+    m_listeners.push_back(&l);
+  }
+
+  void remove_listener(listener& l)
+  {
+    std::lock_guard _{m_mutex};
+    std::erase(m_listeners, &l);
+  }
+
+  //! Send to every midi_in subscribed to a source.
+  //! If timestamp is non-negative, the message is scheduled for this time instead of now.
+  stdx::error send_from(uint64_t source, std::span<const uint8_t> bytes, int64_t timestamp = -1)
+  {
+    std::lock_guard _{m_mutex};
+    if (m_conf.capacity > 0)
+    {
+      for (auto& s : m_subscriptions)
+        if (s.source == source && s.target->in_flight >= m_conf.capacity)
+          return std::errc::no_buffer_space;
+    }
+
+    const auto t = timestamp < 0 ? now() : timestamp;
+    // Indexing as subscriptions may be modified by a synchronous delivery
+    for (std::size_t i = 0; i < m_subscriptions.size(); i++)
+    {
+      if (m_subscriptions[i].source == source)
+        push(*m_subscriptions[i].target, bytes, t);
+    }
+    return stdx::error{};
+  }
+
+  //! Send to the midi_in which created a sink
+  stdx::error send_to(uint64_t sink, std::span<const uint8_t> bytes, int64_t timestamp = -1)
+  {
+    std::lock_guard _{m_mutex};
+    auto e = find_endpoint(sink);
+    if (!e || e->ep.is_source || !e->owner)
+      return std::errc::not_connected;
+
+    auto& target = *e->owner;
+    if (m_conf.capacity > 0 && target.in_flight >= m_conf.capacity)
+      return std::errc::no_buffer_space;
+
+    push(target, bytes, timestamp < 0 ? now() : timestamp);
+    return stdx::error{};
+  }
+
+private:
+  struct endpoint_entry
+  {
+    endpoint ep;
+    receiver* owner{};
+  };
+
+  struct subscription
+  {
+    uint64_t source{};
+    receiver* target{};
+  };
+
+  struct pending_message
+  {
+    int64_t due{};
+    uint64_t sequence{};
+    receiver* target{};
+    std::vector<uint8_t> bytes;
+  };
+
+  // std::*_heap build a max-heap, thus the inverted comparison
+  struct pending_compare
+  {
+    bool operator()(const pending_message& lhs, const pending_message& rhs) const noexcept
+    {
+      if (lhs.due != rhs.due)
+        return lhs.due > rhs.due;
+      return lhs.sequence > rhs.sequence;
+    }
+  };
+
+  endpoint_entry* find_endpoint(uint64_t id)
+  {
+    auto it = std::find_if(
+        m_endpoints.begin(), m_endpoints.end(), [=](auto& e) { return e.ep.id == id; });
+    return it != m_endpoints.end() ? &*it : nullptr;
+  }
+
+  // splitmix64: the same sequence on every platform unlike std:: distributions
+  uint64_t next_random() noexcept
+  {
+    uint64_t z = (m_rng_state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  void push(receiver& target, std::span<const uint8_t> bytes, int64_t send_time)
+  {
+    int64_t due = send_time + m_conf.latency.count();
+    if (const auto jitter = m_conf.jitter.count(); jitter > 0)
+      due += static_cast<int64_t>(next_random() % (static_cast<uint64_t>(jitter) + 1));
+
+    // No reordering on a given input
+    due = std::max(due, target.last_due);
+    target.last_due = due;
+
+    // Fast path: nothing in flight for this input and nothing to wait for
+    if (target.in_flight == 0 && due <= now())
+    {
+      target.deliver(bytes, due);
+      return;
+    }
+
+    target.in_flight++;
+    m_pending.push_back({due, m_sequence++, &target, {bytes.begin(), bytes.end()}});
+    std::push_heap(m_pending.begin(), m_pending.end(), pending_compare{});
+
+    if (!m_conf.virtual_clock)
+    {
+      if (!m_thread.joinable())
+        m_thread = std::thread{[this] { run(); }};
+      m_cv.notify_one();
+    }
+  }
+
+  // Must be called with the lock held
+  void deliver_one()
+  {
+    std::pop_heap(m_pending.begin(), m_pending.end(), pending_compare{});
+    auto msg = std::move(m_pending.back());
+    m_pending.pop_back();
+
+    msg.target->in_flight--;
+    msg.target->deliver(msg.bytes, msg.due);
+  }
+
+  void run()
+  {
+    apply_thread_policy(m_conf.threading, "loopback");
+
+    std::unique_lock lock{m_mutex};
+    while (!m_stop)
+    {
+      if (m_pending.empty())
+      {
+        m_cv.wait(lock);
+        continue;
+      }
+
+      const auto due = m_pending.front().due;
+      const auto t = now();
+      if (due > t)
+        m_cv.wait_for(lock, std::chrono::nanoseconds(due - t));
+      else
+        deliver_one();
+    }
+  }
+
+  const context_configuration m_conf;
+
+  // Recursive as callbacks are invoked with the lock held, and may send messages,
+  // open or close ports, etc.
+  mutable std::recursive_mutex m_mutex;
+  std::condition_variable_any m_cv;
+  std::thread m_thread;
+  bool m_stop{};
+
+  std::atomic<int64_t> m_now{0};
+  uint64_t m_rng_state{};
+  uint64_t m_sequence{};
+  uint64_t m_last_id{};
+
+  std::vector<endpoint_entry> m_endpoints;
+  std::vector<subscription> m_subscriptions;
+  std::vector<listener*> m_listeners;
+  std::vector<pending_message> m_pending;
+};
+}
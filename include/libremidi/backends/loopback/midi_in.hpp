@@ -0,0 +1,81 @@
+#pragma once
+#include <libremidi/backends/loopback/context.hpp>
+#include <libremidi/detail/memory.hpp>
+#include <libremidi/detail/midi_in.hpp>
+#include <libremidi/detail/midi_stream_decoder.hpp>
+
+namespace libremidi::loopback
+{
+class midi_in_impl final
+    : public midi1::in_api
+    , public context::receiver
+    , public error_handler
+{
+public:
+  struct
+      : libremidi::input_configuration
+      , loopback::input_configuration
+  {
+  } configuration;
+
+  explicit midi_in_impl(
+      libremidi::input_configuration&& conf, loopback::input_configuration&& apiconf)
+      : configuration{std::move(conf), std::move(apiconf)}
+  {
+    if (!configuration.context)
+      configuration.context = libremidi::instance<loopback::context>();
+
+    client_open_ = stdx::error{};
+  }
+
+  ~midi_in_impl() override { close_port(); }
+
+  libremidi::API get_current_api() const noexcept override { return libremidi::API::LOOPBACK; }
+
+  stdx::error open_port(const input_port& port, std::string_view) override
+  {
+    if (!configuration.context->subscribe(port.port, *this))
+    {
+      libremidi_handle_error(configuration, "no such loopback port: " + port.port_name);
+      return std::errc::invalid_argument;
+    }
+    return stdx::error{};
+  }
+
+  stdx::error open_virtual_port(std::string_view name) override
+  {
+    m_sink = configuration.context->add_endpoint(name, false, this);
+    return stdx::error{};
+  }
+
+  stdx::error close_port() override
+  {
+    configuration.context->unsubscribe(*this);
+    if (m_sink)
+    {
+      configuration.context->remove_endpoint(m_sink);
+      m_sink = 0;
+    }
+    return stdx::error{};
+  }
+
+  timestamp absolute_timestamp() const noexcept override { return configuration.context->now(); }
+
+  void deliver(std::span<const uint8_t> bytes, int64_t timestamp) override
+  {
+    // With a virtual clock the timestamps are virtual too, which is what makes them testable
+    static constexpr timestamp_backend_info timestamp_info{
+        .has_absolute_timestamps = true,
+        .absolute_is_monotonic = true,
+        .has_samples = false,
+    };
+
+    m_processing.on_bytes(
+        bytes, m_processing.timestamp<timestamp_info>([=] { return timestamp; }, 0));
+  }
+
+private:
+  midi1::input_state_machine m_processing{this->configuration};
+  uint64_t m_sink{};
+};
+}
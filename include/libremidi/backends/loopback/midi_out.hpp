@@ -0,0 +1,85 @@
+#pragma once
+#include <libremidi/backends/loopback/context.hpp>
+#include <libremidi/detail/memory.hpp>
+#include <libremidi/detail/midi_out.hpp>
+
+namespace libremidi::loopback
+{
+class midi_out_impl final
+    : public midi1::out_api
+    , public error_handler
+{
+public:
+  struct
+      : libremidi::output_configuration
+      , loopback::output_configuration
+  {
+  } configuration;
+
+  explicit midi_out_impl(
+      libremidi::output_configuration&& conf, loopback::output_configuration&& apiconf)
+      : configuration{std::move(conf), std::move(apiconf)}
+  {
+    if (!configuration.context)
+      configuration.context = libremidi::instance<loopback::context>();
+
+    client_open_ = stdx::error{};
+  }
+
+  ~midi_out_impl() override { close_port(); }
+
+  libremidi::API get_current_api() const noexcept override { return libremidi::API::LOOPBACK; }
+
+  stdx::error open_port(const output_port& port, std::string_view) override
+  {
+    for (const auto& ep : configuration.context->endpoints())
+    {
+      if (ep.id == port.port && !ep.is_source)
+      {
+        m_target = ep.id;
+        return stdx::error{};
+      }
+    }
+
+    libremidi_handle_error(configuration, "no such loopback port: " + port.port_name);
+    return std::errc::invalid_argument;
+  }
+
+  stdx::error open_virtual_port(std::string_view name) override
+  {
+    m_source = configuration.context->add_endpoint(name, true, nullptr);
+    return stdx::error{};
+  }
+
+  stdx::error close_port() override
+  {
+    if (m_source)
+      configuration.context->remove_endpoint(m_source);
+    m_source = 0;
+    m_target = 0;
+    return stdx::error{};
+  }
+
+  int64_t current_time() const noexcept override { return configuration.context->now(); }
+
+  stdx::error send_message(const unsigned char* message, std::size_t size) override
+  {
+    return schedule_message(-1, message, size);
+  }
+
+  stdx::error
+  schedule_message(int64_t ts, const unsigned char* message, std::size_t size) override
+  {
+    const std::span<const uint8_t> bytes{message, size};
+    if (m_source)
+      return configuration.context->send_from(m_source, bytes, ts);
+    else if (m_target)
+      return configuration.context->send_to(m_target, bytes, ts);
+    return std::errc::not_connected;
+  }
+
+private:
+  uint64_t m_source{};
+  uint64_t m_target{};
+};
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <libremidi/backends/loopback/context.hpp>
+#include <libremidi/detail/memory.hpp>
+#include <libremidi/detail/observer.hpp>
+
+namespace libremidi::loopback
+{
+//! All the loopback ports are virtual: they are reported irrespective of
+//! the track_hardware / track_virtual flags.
+class observer_impl final
+    : public observer_api
+    , public context::listener
+    , public error_handler
+{
+public:
+  struct
+      : libremidi::observer_configuration
+      , loopback::observer_configuration
+  {
+  } configuration;
+
+  explicit observer_impl(
+      libremidi::observer_configuration&& conf, loopback::observer_configuration&& apiconf)
+      : configuration{std::move(conf), std::move(apiconf)}
+  {
+    if (!configuration.context)
+      configuration.context = libremidi::instance<loopback::context>();
+
+    if (configuration.notify_in_constructor)
+    {
+      for (const auto& ep : configuration.context->endpoints())
+        on_endpoint_added(ep);
+    }
+
+    if (configuration.has_callbacks())
+      configuration.context->add_listener(*this);
+  }
+
+  ~observer_impl() override { configuration.context->remove_listener(*this); }
+
+  libremidi::API get_current_api() const noexcept override { return libremidi::API::LOOPBACK; }
+
+  std::vector<libremidi::input_port> get_input_ports() const noexcept override
+  {
+    std::vector<libremidi::input_port> ret;
+    for (const auto& ep : configuration.context->endpoints())
+      if (ep.is_source)
+        ret.push_back({to_port_info(ep)});
+    return ret;
+  }
+
+  std::vector<libremidi::output_port> get_output_ports() const noexcept override
+  {
+    std::vector<libremidi::output_port> ret;
+    for (const auto& ep : configuration.context->endpoints())
+      if (!ep.is_source)
+        ret.push_back({to_port_info(ep)});
+    return ret;
+  }
+
+  void on_endpoint_added(const context::endpoint& ep) override
+  {
+    if (ep.is_source)
+    {
+      if (configuration.input_added)
+        configuration.input_added({to_port_info(ep)});
+    }
+    else
+    {
+      if (configuration.output_added)
+        configuration.output_added({to_port_info(ep)});
+    }
+  }
+
+  void on_endpoint_removed(const context::endpoint& ep) override
+  {
+    if (ep.is_source)
+    {
+      if (configuration.input_removed)
+        configuration.input_removed({to_port_info(ep)});
+    }
+    else
+    {
+      if (configuration.output_removed)
+        configuration.output_removed({to_port_info(ep)});
+    }
+  }
+
+private:
+  static port_information to_port_info(const context::endpoint& ep)
+  {
+    return {
+        .client = 0,
+        .port = ep.id,
+        .manufacturer = "",
+        .device_name = "loopback",
+        .port_name = ep.name,
+        .display_name = ep.name};
+  }
+};
+}
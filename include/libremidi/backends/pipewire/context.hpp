@@ -469,7 +469,7 @@ struct pipewire_filter
 
     auto& pw = libpipewire::instance();
     // clang-format off
-    this->filter = pw.filter_new_simple(
+    this->filter = pw.filter->new_simple(
         loop->lp,
         filter_name.data(),
         pw.properties_new(
@@ -495,13 +495,13 @@ struct pipewire_filter
   void destroy()
   {
     if (this->filter)
-      pw.filter_destroy(this->filter);
+      pw.filter->destroy(this->filter);
   }
 
   stdx::error create_local_port(std::string_view port_name, spa_direction direction)
   {
     // clang-format off
-    this->port = (struct port*)pw.filter_add_port(
+    this->port = (struct port*)pw.filter->add_port(
         this->filter,
         direction,
         PW_FILTER_PORT_FLAG_MAP_BUFFERS,
@@ -536,13 +536,13 @@ struct pipewire_filter
     };
     // clang-format on
 
-    pw.filter_update_params(this->filter, this->port, params, 1);
+    pw.filter->update_params(this->filter, this->port, params, 1);
   }
 
   stdx::error remove_port()
   {
     assert(this->port);
-    int ret = pw.filter_remove_port(this->port);
+    int ret = pw.filter->remove_port(this->port);
     this->port = nullptr;
     return from_errc(ret);
   }
@@ -556,7 +556,7 @@ struct pipewire_filter
       };
 
       auto properties = SPA_DICT_INIT(items, 1);
-      int ret = pw.filter_update_properties(this->filter, this->port, &properties);
+      int ret = pw.filter->update_properties(this->filter, this->port, &properties);
       return from_errc(ret);
     }
     else
@@ -567,7 +567,7 @@ struct pipewire_filter
 
   [[nodiscard]] stdx::error start_filter()
   {
-    if (int ret = pw.filter_connect(this->filter, PW_FILTER_FLAG_RT_PROCESS, NULL, 0); ret < 0)
+    if (int ret = pw.filter->connect(this->filter, PW_FILTER_FLAG_RT_PROCESS, NULL, 0); ret < 0)
     {
       return from_errc(ret);
     }
@@ -577,7 +577,7 @@ struct pipewire_filter
     }
   }
 
-  uint32_t filter_node_id() { return this->loop->pw.filter_get_node_id(this->filter); }
+  uint32_t filter_node_id() { return this->loop->pw.filter->get_node_id(this->filter); }
 
   void synchronize_node()
   {
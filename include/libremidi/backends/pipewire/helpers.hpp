@@ -7,6 +7,7 @@
 #include <libremidi/detail/memory.hpp>
 #include <libremidi/detail/midi_in.hpp>
 #include <libremidi/detail/semaphore.hpp>
+#include <libremidi/detail/thread_policy.hpp>
 
 #include <atomic>
 #include <semaphore>
@@ -266,13 +267,16 @@ struct pipewire_helpers
     };
   }
 
-  void start_thread()
+  void start_thread(const thread_policy& policy)
   {
     if (!this->global_context->owns_main_loop)
       return;
 
     current_state = poll_state::start_poll;
-    main_loop_thread = std::jthread{[this]() { run_poll_loop(); }};
+    main_loop_thread = std::jthread{[this, policy]() {
+      apply_thread_policy(policy, "pipewire");
+      run_poll_loop();
+    }};
   }
 
   void stop_thread()
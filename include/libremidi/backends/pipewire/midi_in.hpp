@@ -53,7 +53,7 @@ public:
     if (auto err = link_ports(*this, in_port); err != stdx::error{})
       return err;
 
-    start_thread();
+    start_thread(configuration.threading);
     return stdx::error{};
   }
 
@@ -62,7 +62,7 @@ public:
     if (auto err = create_local_port(*this, name, SPA_DIRECTION_INPUT); err != stdx::error{})
       return err;
 
-    start_thread();
+    start_thread(configuration.threading);
     return stdx::error{};
   }
 
@@ -89,7 +89,7 @@ public:
 
     assert(this->filter);
     assert(this->filter->port);
-    const auto b = pw.filter_dequeue_buffer(this->filter->port);
+    const auto b = pw.filter->dequeue_buffer(this->filter->port);
     if (!b)
       return;
 
@@ -123,7 +123,7 @@ public:
           {data, data + size}, m_processing.timestamp<timestamp_info>(to_ns, c->offset));
     }
 
-    pw.filter_queue_buffer(this->filter->port, b);
+    pw.filter->queue_buffer(this->filter->port, b);
   }
 
   midi1::input_state_machine m_processing{this->configuration};
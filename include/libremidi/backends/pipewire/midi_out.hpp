@@ -58,7 +58,7 @@ public:
     if (auto err = link_ports(*this, out_port); err != stdx::error{})
       return err;
 
-    start_thread();
+    start_thread(configuration.threading);
     return stdx::error{};
   }
 
@@ -69,7 +69,7 @@ public:
 
     this->filter->set_port_buffer(configuration.output_buffer_size);
 
-    start_thread();
+    start_thread(configuration.threading);
     return stdx::error{};
   }
 
@@ -87,7 +87,7 @@ public:
   int process(spa_io_position* pos)
   {
     m_process_clock.store(pos->clock.nsec, std::memory_order_relaxed);
-    const auto b = pw.filter_dequeue_buffer(this->filter->port);
+    const auto b = pw.filter->dequeue_buffer(this->filter->port);
     if (!b)
       return 1;
 
@@ -142,11 +142,11 @@ public:
       d->chunk->size = n_fill_frames;
       b->size = n_fill_frames;
 
-      pw.filter_queue_buffer(this->filter->port, b);
+      pw.filter->queue_buffer(this->filter->port, b);
       return 0;
     }
 
-    pw.filter_flush(this->filter->filter, true);
+    pw.filter->flush(this->filter->filter, true);
 
     return 0;
   }
@@ -37,7 +37,7 @@ public:
 #endif
     {
       this->add_callbacks(configuration);
-      this->start_thread();
+      this->start_thread(configuration.threading);
     }
   }
 
@@ -2,6 +2,7 @@
 #include <libremidi/backends/winmm/config.hpp>
 #include <libremidi/backends/winmm/helpers.hpp>
 #include <libremidi/detail/observer.hpp>
+#include <libremidi/detail/thread_policy.hpp>
 
 #include <condition_variable>
 #include <mutex>
@@ -182,6 +183,7 @@ public:
       : observer_winmm{std::move(conf), std::move(apiconf)}
   {
     thread = std::jthread([this](std::stop_token tk) {
+      apply_thread_policy(observer_winmm::configuration.threading, "winmm observer");
       while (!tk.stop_requested())
       {
         check_new_ports<true>();
@@ -213,6 +215,7 @@ public:
       , sema{0}
   {
     thread = std::thread([this] {
+      apply_thread_policy(observer_winmm::configuration.threading, "winmm observer");
       while (!stop_flag.test(std::memory_order_acquire))
       {
         check_new_ports<true>();
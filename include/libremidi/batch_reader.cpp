@@ -0,0 +1,136 @@
+#if !defined(LIBREMIDI_HEADER_ONLY)
+  #include <libremidi/batch_reader.hpp>
+#endif
+
+#include <libremidi/detail/mapped_file.hpp>
+#include <libremidi/detail/parallel_for.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <optional>
+#include <thread>
+
+namespace libremidi
+{
+LIBREMIDI_INLINE
+batch_statistics& batch_statistics::operator+=(const batch_statistics& other) noexcept
+{
+  files += other.files;
+  bytes += other.bytes;
+  unreadable += other.unreadable;
+  invalid += other.invalid;
+  incomplete += other.incomplete;
+  complete += other.complete;
+  validated += other.validated;
+  for (std::size_t i = 0; i < errors.size(); i++)
+    errors[i] += other.errors[i];
+  return *this;
+}
+
+LIBREMIDI_INLINE
+batch_statistics
+batch_reader::run(std::span<const std::filesystem::path> paths, const callback& on_file)
+{
+  const auto t0 = std::chrono::steady_clock::now();
+
+  int threads = threadCount > 0 ? threadCount
+                                : std::max(1, int(std::thread::hardware_concurrency()));
+  threads = int(std::min(std::size_t(threads), std::max(paths.size(), std::size_t(1))));
+
+  // Each worker only touches its own mapping, reader and statistics.
+  // They are created by the worker, so that an allocation failure there is rethrown
+  // by parallel_for like the exceptions of the callback.
+  struct worker_state
+  {
+    explicit worker_state(bool absolute_ticks)
+        : view{absolute_ticks}
+    {
+    }
+    mapped_file mapping;
+    reader_view view;
+  };
+  std::vector<std::optional<worker_state>> states(threads);
+  std::vector<batch_statistics> stats(threads);
+
+  detail::parallel_for(paths.size(), threads, [&](std::size_t i, int worker) {
+    auto& state = states[worker];
+    if (!state)
+      state.emplace(useAbsoluteTicks);
+    auto& mapping = state->mapping;
+    auto& view = state->view;
+    auto& s = stats[worker];
+
+    batch_file f{.path = paths[i], .index = i, .worker = worker, .file = view};
+    f.opened = mapping.open(paths[i]);
+    if (f.opened)
+    {
+      f.size = mapping.size();
+      f.result = view.parse(mapping.data(), mapping.size());
+    }
+    else
+    {
+      // Nothing to report but that the file could not be opened
+      f.result = view.parse(nullptr, 0);
+      view.diagnostics.clear();
+    }
+
+    s.files++;
+    s.bytes += f.size;
+    if (!f.opened)
+      s.unreadable++;
+    else if (f.result == reader::invalid)
+      s.invalid++;
+    else if (f.result == reader::incomplete)
+      s.incomplete++;
+    else if (f.result == reader::complete)
+      s.complete++;
+    else
+      s.validated++;
+    for (const auto& d : view.diagnostics)
+      s.errors[std::size_t(d.error)]++;
+
+    on_file(f);
+  });
+
+  batch_statistics res;
+  for (const auto& s : stats)
+    res += s;
+  res.elapsed = std::chrono::steady_clock::now() - t0;
+  return res;
+}
+
+LIBREMIDI_INLINE
+batch_statistics batch_reader::run(const std::filesystem::path& folder, const callback& on_file)
+{
+  const auto t0 = std::chrono::steady_clock::now();
+  const auto paths = list_files(folder);
+  auto res = run(paths, on_file);
+  res.elapsed = std::chrono::steady_clock::now() - t0;
+  return res;
+}
+
+LIBREMIDI_INLINE
+std::vector<std::filesystem::path> batch_reader::list_files(const std::filesystem::path& folder)
+{
+  std::vector<std::filesystem::path> res;
+
+  // Unreadable folders are skipped instead of throwing
+  std::error_code ec;
+  const auto options = std::filesystem::directory_options::follow_directory_symlink
+                       | std::filesystem::directory_options::skip_permission_denied;
+  std::filesystem::recursive_directory_iterator it{folder, options, ec}, end;
+  for (; !ec && it != end; it.increment(ec))
+  {
+    if (std::error_code file_ec; !it->is_regular_file(file_ec))
+      continue;
+
+    auto ext = it->path().extension().string();
+    std::ranges::transform(ext, ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (ext == ".mid" || ext == ".midi")
+      res.push_back(it->path());
+  }
+
+  std::ranges::sort(res);
+  return res;
+}
+}
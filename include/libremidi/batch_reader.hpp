@@ -0,0 +1,112 @@
+#pragma once
+#include <libremidi/reader.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace libremidi
+{
+//! A file parsed by batch_reader
+struct batch_file
+{
+  const std::filesystem::path& path;
+  std::size_t index{}; //! In the list of files
+  int worker{};        //! Index of the thread which parsed it, from 0 to the thread count
+
+  //! False if the file could not be opened: nothing was parsed
+  bool opened{};
+  std::size_t size{}; //! In bytes
+
+  reader::parse_result result{};
+
+  //! The parsed file, which is only valid during the callback.
+  //! Its diagnostics say what could not be parsed or validated.
+  const reader_view& file;
+};
+
+//! Totals of a batch_reader::run
+struct batch_statistics
+{
+  std::size_t files{};
+  std::size_t bytes{};
+  std::size_t unreadable{}; //! Files which could not be opened
+
+  //! Number of files for each parse_result
+  std::size_t invalid{};
+  std::size_t incomplete{};
+  std::size_t complete{};
+  std::size_t validated{};
+
+  //! Number of diagnostics of each kind, indexed by parse_error
+  std::array<std::size_t, std::size_t(parse_error::out_of_memory) + 1> errors{};
+
+  std::chrono::nanoseconds elapsed{}; //! Wall-clock time of the run
+
+  [[nodiscard]] std::size_t error_count(parse_error e) const noexcept
+  {
+    return errors[std::size_t(e)];
+  }
+
+  [[nodiscard]] double files_per_second() const noexcept
+  {
+    return elapsed.count() > 0 ? double(files) * 1e9 / double(elapsed.count()) : 0.;
+  }
+
+  [[nodiscard]] double bytes_per_second() const noexcept
+  {
+    return elapsed.count() > 0 ? double(bytes) * 1e9 / double(elapsed.count()) : 0.;
+  }
+
+  //! Adds the counts, but not the elapsed time
+  batch_statistics& operator+=(const batch_statistics& other) noexcept;
+};
+
+/**
+ * @brief Parses many MIDI files on a pool of threads.
+ *
+ * Each thread takes the next file which has not been parsed yet, maps it in memory
+ * and parses it with its own reader_view, whose storage is reused from one file to the
+ * next: after the first files, parsing does not allocate anymore.
+ *
+ * The callback is called from the worker threads, concurrently for different files:
+ * batch_file::worker can index per-thread state to avoid locking.
+ * If it throws, or a worker cannot allocate its reader, the files not started yet are
+ * skipped and the exception is rethrown by run once every thread is done.
+ *
+ * ```
+ * libremidi::batch_reader batch;
+ * auto stats = batch.run("dataset/", [](const libremidi::batch_file& f) {
+ *   if (f.result != libremidi::reader::invalid)
+ *     process(f.file);
+ * });
+ * ```
+ */
+class LIBREMIDI_EXPORT batch_reader
+{
+public:
+  using callback = std::function<void(const batch_file&)>;
+
+  //! 1 parses the files in the calling thread, 0 uses one thread per hardware thread
+  int threadCount{0};
+
+  //! See reader_view
+  bool useAbsoluteTicks{false};
+
+  batch_statistics run(std::span<const std::filesystem::path> paths, const callback& on_file);
+
+  //! Parses the .mid and .midi files of the folder and its subfolders, in path order
+  batch_statistics run(const std::filesystem::path& folder, const callback& on_file);
+
+  //! The .mid and .midi files of the folder and its subfolders, sorted
+  static std::vector<std::filesystem::path> list_files(const std::filesystem::path& folder);
+};
+}
+
+#if defined(LIBREMIDI_HEADER_ONLY)
+  #include <libremidi/batch_reader.cpp>
+#endif
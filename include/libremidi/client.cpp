@@ -5,6 +5,7 @@
 #include <libremidi/shared_context.hpp>
 
 #ifdef LIBREMIDI_ALSA
+  #include <libremidi/backends/alsa_raw/shared_handler.hpp>
   #include <libremidi/backends/alsa_seq/shared_handler.hpp>
 #endif
 #ifdef LIBREMIDI_JACK
@@ -14,16 +15,29 @@ namespace libremidi
 {
 LIBREMIDI_INLINE
 shared_configurations
-create_shared_context(const libremidi::API api, [[maybe_unused]] std::string_view client_name)
+create_shared_context(const libremidi::API api, std::string_view client_name)
+{
+  return create_shared_context(api, client_name, thread_policy{});
+}
+
+LIBREMIDI_INLINE
+shared_configurations create_shared_context(
+    const libremidi::API api, [[maybe_unused]] std::string_view client_name,
+    [[maybe_unused]] const thread_policy& policy)
 {
   switch (api)
   {
-#if __has_include(<boost/lockfree/spsc_queue.hpp>)
-  #if defined(LIBREMIDI_ALSA)
-    case libremidi::API::ALSA_SEQ:
-      return alsa_seq::shared_handler::make(client_name);
+#if defined(LIBREMIDI_ALSA)
+  #if LIBREMIDI_ALSA_HAS_RAMWIDI
+    case libremidi::API::ALSA_RAW:
+      return alsa_raw::shared_handler::make(client_name, 1, policy);
   #endif
 
+    case libremidi::API::ALSA_SEQ:
+      return alsa_seq::shared_handler::make(client_name, policy);
+#endif
+
+#if __has_include(<boost/lockfree/spsc_queue.hpp>)
   #if defined(LIBREMIDI_JACK)
     case libremidi::API::JACK_MIDI:
       return jack::shared_handler::make(client_name);
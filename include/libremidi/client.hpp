@@ -3,7 +3,7 @@
 #include <libremidi/libremidi.hpp>
 #include <libremidi/shared_context.hpp>
 
-#include <map>
+#include <unordered_map>
 
 namespace libremidi::midi1
 {
@@ -55,13 +55,16 @@ struct client_configuration
 
   //! Observe software (virtual) ports if the API provides it
   uint32_t track_virtual : 1 = false;
+
+  //! Scheduling of the threads started for the client: shared context, inputs, observer
+  thread_policy threading{};
 };
 
 class client
 {
 public:
   explicit client(const client_configuration& conf)
-      : client{conf, create_shared_context(conf.api, conf.client_name)}
+      : client{conf, create_shared_context(conf.api, conf.client_name, conf.threading)}
   {
   }
 
@@ -80,7 +83,8 @@ public:
 
                 .track_hardware = conf.track_hardware,
                 .track_virtual = conf.track_virtual,
-                .notify_in_constructor = false},
+                .notify_in_constructor = false,
+                .threading = conf.threading},
             context.observer}
   {
     if (context.context)
@@ -106,13 +110,16 @@ public:
     return m_observer.get_output_ports();
   }
 
-  void add_input(const input_port& port, std::string_view name)
+  //! Open an input port.
+  //! Returns the identifier under which the port is known to this client.
+  port_id add_input(const input_port& port, std::string_view name)
   {
-    if (m_inputs.find(port) != m_inputs.end())
-      return;
+    const auto id = m_observer.get_port_id(port);
+    if (m_inputs.find(id) != m_inputs.end())
+      return id;
 
     auto res = m_inputs.try_emplace(
-        port,
+        id,
         input_configuration{
             .on_message
             = [this, port](libremidi::message&& m) {
@@ -127,31 +134,50 @@ public:
             .ignore_timing = configuration.ignore_timing,
             .ignore_sensing = configuration.ignore_sensing,
 
-            .timestamps = configuration.timestamps},
+            .timestamps = configuration.timestamps,
+            .threading = configuration.threading},
         context.in);
 
     res.first->second.open_port(port, name);
+    return id;
   }
 
-  void add_output(const output_port& port, std::string_view name)
+  //! Open an output port.
+  //! Returns the identifier under which the port is known to this client.
+  port_id add_output(const output_port& port, std::string_view name)
   {
-    if (m_outputs.find(port) != m_outputs.end())
-      return;
+    const auto id = m_observer.get_port_id(port);
+    if (m_outputs.find(id) != m_outputs.end())
+      return id;
 
     auto res = m_outputs.try_emplace(
-        port,
+        id,
         output_configuration{
             .on_error = configuration.on_error,
             .on_warning = configuration.on_warning,
 
-            .timestamps = configuration.timestamps},
+            .timestamps = configuration.timestamps,
+            .threading = configuration.threading},
         context.out);
 
     res.first->second.open_port(port, name);
+    return id;
   }
 
-  void remove_input(const input_port& port) { m_inputs.erase(port); }
-  void remove_output(const output_port& port) { m_outputs.erase(port); }
+  void remove_input(const input_port& port) { remove_input(m_observer.get_port_id(port)); }
+  void remove_output(const output_port& port) { remove_output(m_observer.get_port_id(port)); }
+  void remove_input(port_id port) { m_inputs.erase(port); }
+  void remove_output(port_id port) { m_outputs.erase(port); }
+
+  //! Return the identifier of a port, which can be used for the port_id overloads
+  port_id get_port_id(const input_port& port) const
+  {
+    return m_observer.get_port_id(port);
+  }
+  port_id get_port_id(const output_port& port) const
+  {
+    return m_observer.get_port_id(port);
+  }
 
   stdx::error send_message(const unsigned char* message, size_t size)
   {
@@ -174,6 +200,16 @@ public:
   }
 
   stdx::error send_message(const output_port& port, const unsigned char* message, size_t size)
+  {
+    return send_message(m_observer.get_port_id(port), message, size);
+  }
+
+  stdx::error send_ump(const output_port& port, const uint32_t* message, size_t size)
+  {
+    return send_ump(m_observer.get_port_id(port), message, size);
+  }
+
+  stdx::error send_message(port_id port, const unsigned char* message, size_t size)
   {
     if (auto it = m_outputs.find(port); it != m_outputs.end())
       return it->second.send_message(message, size);
@@ -181,7 +217,7 @@ public:
     return stdx::error{};
   }
 
-  stdx::error send_ump(const output_port& port, const uint32_t* message, size_t size)
+  stdx::error send_ump(port_id port, const uint32_t* message, size_t size)
   {
     if (auto it = m_outputs.find(port); it != m_outputs.end())
       return it->second.send_ump(message, size);
@@ -193,8 +229,8 @@ private:
   client_configuration configuration;
   shared_configurations context;
 
-  std::map<input_port, midi_in> m_inputs;
-  std::map<output_port, midi_out> m_outputs;
+  std::unordered_map<port_id, midi_in> m_inputs;
+  std::unordered_map<port_id, midi_out> m_outputs;
 
   observer m_observer;
 };
@@ -0,0 +1,489 @@
+#if !defined(LIBREMIDI_HEADER_ONLY)
+  #include <libremidi/clip_file.hpp>
+#endif
+
+#include <libremidi/detail/mapped_file.hpp>
+#include <libremidi/detail/smf_encoding.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <ostream>
+
+namespace libremidi
+{
+namespace util
+{
+// Layout of a clip file: the header, followed by the clip header
+// (delta clockstamps and configuration messages, including the ticks per quarter note),
+// then by the clip itself between the Start of Clip and End of Clip messages.
+// Every message of the clip follows a delta clockstamp.
+static constexpr uint8_t clip_file_header[8]{'S', 'M', 'F', '2', 'C', 'L', 'I', 'P'};
+static constexpr uint32_t clip_max_delta = 0xFFFFF;
+
+static constexpr uint32_t ump_start_of_clip = 0xF0200000;
+static constexpr uint32_t ump_end_of_clip = 0xF0210000;
+
+enum class utility_status : uint8_t
+{
+  noop = 0x0,
+  jr_clock = 0x1,
+  jr_timestamp = 0x2,
+  ticks_per_quarter = 0x3,
+  delta_clockstamp = 0x4
+};
+
+static constexpr bool is_utility(uint32_t word) noexcept
+{
+  return (word >> 28) == 0x0;
+}
+
+static constexpr utility_status get_utility_status(uint32_t word) noexcept
+{
+  return utility_status((word >> 20) & 0xF);
+}
+
+static constexpr uint32_t get_stream_status(uint32_t word) noexcept
+{
+  return (word >> 28) == 0xF ? (word & 0x03FF0000) : 0xFFFFFFFF;
+}
+
+// Flex data Set Tempo, with a complete form, in units of 10 nanoseconds per quarter note
+static constexpr bool is_set_tempo(uint32_t word) noexcept
+{
+  return (word >> 28) == 0xD && ((word >> 22) & 0x3) == 0 && (word & 0xFFFF) == 0;
+}
+
+static LIBREMIDI_INLINE void write_clip_word(uint32_t word, auto& out) noexcept
+{
+  uint8_t bytes[4];
+  write_uint32_be(bytes, word);
+  out.bytes(bytes, 4);
+}
+
+static LIBREMIDI_INLINE void write_clip_delta(int64_t delta, auto& out) noexcept
+{
+  for (; delta > clip_max_delta; delta -= clip_max_delta)
+    write_clip_word(0x00400000 | clip_max_delta, out);
+  write_clip_word(0x00400000 | uint32_t(delta), out);
+}
+}
+
+LIBREMIDI_INLINE
+clip_reader::clip_reader() noexcept = default;
+
+LIBREMIDI_INLINE
+clip_reader::~clip_reader() = default;
+
+LIBREMIDI_INLINE
+auto clip_reader::parse(const uint8_t* data, std::size_t size) noexcept -> parse_result
+{
+  events.clear();
+  configuration.clear();
+  diagnostics.clear();
+  tempoMap = {};
+  ticksPerQuarterNote = 0;
+  endTick = 0;
+  m_file.reset();
+
+  const auto report = [&](const uint8_t* p, int track, parse_error err) noexcept {
+#if defined(__cpp_exceptions)
+    try
+    {
+      diagnostics.push_back({std::size_t(p - data), track, err});
+    }
+    catch (...)
+    {
+    }
+#else
+    diagnostics.push_back({std::size_t(p - data), track, err});
+#endif
+  };
+
+  if (size == 0 || !data)
+  {
+    report(data, -1, parse_error::empty_buffer);
+    return parse_result::invalid;
+  }
+  if (size < 8 || std::memcmp(data, util::clip_file_header, 8) != 0)
+  {
+    report(data, -1, parse_error::invalid_header);
+    return parse_result::invalid;
+  }
+
+  const uint8_t* const end = data + size;
+  const uint8_t* p = data + 8;
+  std::vector<tempo_change> tempo;
+  int64_t tick = 0;
+  bool in_clip = false;
+  bool has_delta = false;
+  bool has_end = false;
+  bool incomplete = false;
+  bool not_validated = false;
+
+#if defined(__cpp_exceptions)
+  try
+#endif
+  {
+    // Most messages are a delta clockstamp followed by a one- or two-word message
+    events.reserve((size - 8) / 12);
+
+    while (end - p >= 4)
+    {
+      const clip_event ev{tick, p};
+      const uint32_t word = ev.word(0);
+      const std::size_t words = ump_word_count(word);
+      if (std::size_t(end - p) < 4 * words)
+        break;
+
+      const int track = in_clip ? 0 : -1;
+      if (util::is_utility(word))
+      {
+        switch (util::get_utility_status(word))
+        {
+          case util::utility_status::delta_clockstamp:
+            if (in_clip)
+              tick += word & util::clip_max_delta;
+            has_delta = true;
+            break;
+          case util::utility_status::ticks_per_quarter:
+            if (!in_clip)
+              ticksPerQuarterNote = int(word & 0xFFFF);
+            break;
+          default:
+            // JR clock and timestamps only make sense on a live connection
+            break;
+        }
+      }
+      else if (util::get_stream_status(word) == (util::ump_start_of_clip & 0x03FF0000))
+      {
+        if (!in_clip)
+        {
+          if (ticksPerQuarterNote == 0)
+          {
+            report(data + 8, -1, parse_error::missing_ticks_per_quarter);
+            not_validated = true;
+          }
+          in_clip = true;
+          tick = 0;
+        }
+        has_delta = false;
+      }
+      else if (util::get_stream_status(word) == (util::ump_end_of_clip & 0x03FF0000))
+      {
+        if (in_clip)
+        {
+          p += 4 * words;
+          has_end = true;
+          break;
+        }
+      }
+      else
+      {
+        if (!has_delta)
+        {
+          report(p, track, parse_error::missing_delta_clockstamp);
+          not_validated = true;
+        }
+
+        if (in_clip)
+        {
+          if (util::is_set_tempo(word))
+            tempo.push_back({tick, uint32_t((ev.word(1) + 50) / 100)});
+          events.push_back(ev);
+        }
+        else
+        {
+          configuration.push_back({0, p});
+        }
+        has_delta = false;
+      }
+      p += 4 * words;
+    }
+
+    if (!in_clip)
+    {
+      report(p, -1, parse_error::invalid_header);
+      events.clear();
+      return parse_result::invalid;
+    }
+
+    if (!has_end)
+    {
+      report(p, 0, p == end ? parse_error::missing_end_of_track : parse_error::truncated_event);
+      incomplete = true;
+    }
+    else if (p != end)
+    {
+      report(p, -1, parse_error::junk_at_end);
+      not_validated = true;
+    }
+
+    endTick = tick;
+    tempoMap = tempo_map{ticksPerQuarterNote, std::move(tempo)};
+  }
+#if defined(__cpp_exceptions)
+  catch (const std::bad_alloc&)
+  {
+    events.clear();
+    configuration.clear();
+    report(p, -1, parse_error::out_of_memory);
+    return parse_result::invalid;
+  }
+#endif
+
+  if (incomplete)
+    return parse_result::incomplete;
+  if (not_validated)
+    return parse_result::complete;
+  return parse_result::validated;
+}
+
+LIBREMIDI_INLINE
+auto clip_reader::parse(const std::vector<uint8_t>& buffer) noexcept -> parse_result
+{
+  return parse(buffer.data(), buffer.size());
+}
+
+LIBREMIDI_INLINE
+auto clip_reader::parse(std::span<const uint8_t> buffer) noexcept -> parse_result
+{
+  return parse(buffer.data(), buffer.size());
+}
+
+LIBREMIDI_INLINE
+auto clip_reader::parse_file(const std::filesystem::path& path) noexcept -> parse_result
+{
+  // On failure, parsing nothing resets the previous file and reports an empty buffer
+  std::shared_ptr<mapped_file> file;
+#if defined(__cpp_exceptions)
+  try
+  {
+    file = std::make_shared<mapped_file>();
+  }
+  catch (const std::bad_alloc&)
+  {
+    return parse(nullptr, 0);
+  }
+#else
+  file = std::make_shared<mapped_file>();
+#endif
+
+  if (!file->open(path))
+    return parse(nullptr, 0);
+
+  const auto res = parse(file->data(), file->size());
+  m_file = std::move(file);
+  return res;
+}
+
+LIBREMIDI_INLINE
+double clip_reader::get_end_seconds() const noexcept
+{
+  return tempoMap.tick_to_seconds(endTick);
+}
+
+LIBREMIDI_INLINE
+void clip_writer::add_configuration(const ump& m)
+{
+  m_configuration.insert(m_configuration.end(), m.data, m.data + ump_word_count(m.data[0]));
+}
+
+LIBREMIDI_INLINE
+void clip_writer::add_event(int64_t tick, const ump& m)
+{
+  add_event(tick, std::span<const uint32_t>{m.data, ump_word_count(m.data[0])});
+}
+
+LIBREMIDI_INLINE
+void clip_writer::add_event(int64_t tick, std::span<const uint32_t> words)
+{
+  tick = std::max(tick, int64_t(0));
+
+  for (std::size_t i = 0; i < words.size();)
+  {
+    const uint32_t word = words[i];
+    const std::size_t n = ump_word_count(word);
+    if (words.size() - i < n)
+      break;
+
+    // The timing of the file is given by the position of the messages
+    const auto status = util::get_stream_status(word);
+    if (!util::is_utility(word) && status != (util::ump_start_of_clip & 0x03FF0000)
+        && status != (util::ump_end_of_clip & 0x03FF0000))
+    {
+      if (!m_events.empty() && tick < m_events.back().tick)
+        m_sorted = false;
+      m_events.push_back({tick, uint32_t(m_words.size())});
+      m_words.insert(m_words.end(), words.begin() + i, words.begin() + i + n);
+    }
+    i += n;
+  }
+}
+
+LIBREMIDI_INLINE
+int64_t clip_writer::add_stream(int64_t tick, std::span<const uint32_t> words)
+{
+  tick = std::max(tick, int64_t(0));
+
+  // JR timestamps count 1/31250th of a second, and wrap around every two seconds
+  const int64_t us_per_quarter = std::max(tempo, uint32_t(1));
+  int64_t jr_tick = tick;
+  int64_t jr_us = 0;
+  int32_t jr_previous = -1;
+
+  for (std::size_t i = 0; i < words.size();)
+  {
+    const uint32_t word = words[i];
+    const std::size_t n = ump_word_count(word);
+    if (words.size() - i < n)
+      break;
+
+    if (util::is_utility(word))
+    {
+      switch (util::get_utility_status(word))
+      {
+        case util::utility_status::delta_clockstamp:
+          tick += word & util::clip_max_delta;
+          jr_tick = tick;
+          jr_us = 0;
+          break;
+        case util::utility_status::jr_timestamp:
+        {
+          const int32_t timestamp = int32_t(word & 0xFFFF);
+          if (jr_previous >= 0)
+          {
+            jr_us += int64_t((timestamp - jr_previous) & 0xFFFF) * 32;
+            const int64_t ticks = (jr_us / us_per_quarter) * ticksPerQuarterNote
+                                  + (jr_us % us_per_quarter) * ticksPerQuarterNote
+                                        / us_per_quarter;
+            tick = std::max(tick, jr_tick + ticks);
+          }
+          jr_previous = timestamp;
+          break;
+        }
+        default:
+          break;
+      }
+    }
+    else
+    {
+      add_event(tick, words.subspan(i, n));
+    }
+    i += n;
+  }
+  return tick;
+}
+
+LIBREMIDI_INLINE
+void clip_writer::clear() noexcept
+{
+  m_words.clear();
+  m_events.clear();
+  m_configuration.clear();
+  m_sorted = true;
+  endTick = 0;
+}
+
+template <typename GetBuffer>
+LIBREMIDI_INLINE std::size_t clip_writer::write_impl(GetBuffer get_buffer) const
+{
+  // Stable order of the messages by tick, only computed when they were not added in order
+  std::vector<uint32_t> order;
+  if (!m_sorted)
+  {
+    order.resize(m_events.size());
+    for (std::size_t i = 0; i < order.size(); i++)
+      order[i] = uint32_t(i);
+    std::ranges::stable_sort(order, {}, [this](uint32_t i) { return m_events[i].tick; });
+  }
+
+  const auto encode = [&](auto& out) {
+    out.bytes(util::clip_file_header, 8);
+
+    util::write_clip_delta(0, out);
+    util::write_clip_word(0x00300000 | (uint32_t(ticksPerQuarterNote) & 0xFFFF), out);
+    for (std::size_t i = 0; i < m_configuration.size();)
+    {
+      const std::size_t n = ump_word_count(m_configuration[i]);
+      util::write_clip_delta(0, out);
+      for (std::size_t k = 0; k < n; k++)
+        util::write_clip_word(m_configuration[i + k], out);
+      i += n;
+    }
+
+    util::write_clip_delta(0, out);
+    for (uint32_t w : {util::ump_start_of_clip, 0u, 0u, 0u})
+      util::write_clip_word(w, out);
+
+    if (tempo != 500000)
+    {
+      // Set Tempo to the whole group, in units of 10 nanoseconds
+      util::write_clip_delta(0, out);
+      for (uint32_t w : {0xD0100000u, tempo * 100, 0u, 0u})
+        util::write_clip_word(w, out);
+    }
+
+    int64_t previous = 0;
+    for (std::size_t i = 0; i < m_events.size(); i++)
+    {
+      const auto& ev = m_events[order.empty() ? i : order[i]];
+      const uint32_t* words = m_words.data() + ev.offset;
+      util::write_clip_delta(ev.tick - previous, out);
+      for (std::size_t k = 0, n = ump_word_count(words[0]); k < n; k++)
+        util::write_clip_word(words[k], out);
+      previous = ev.tick;
+    }
+
+    util::write_clip_delta(std::max(endTick, previous) - previous, out);
+    for (uint32_t w : {util::ump_end_of_clip, 0u, 0u, 0u})
+      util::write_clip_word(w, out);
+  };
+
+  util::byte_counter counter;
+  encode(counter);
+
+  const std::span<uint8_t> buffer = get_buffer(counter.size);
+  if (buffer.size() < counter.size)
+    return 0;
+
+  util::byte_writer writer{buffer.data()};
+  encode(writer);
+  return counter.size;
+}
+
+LIBREMIDI_INLINE
+std::size_t clip_writer::encoded_size() const
+{
+  std::size_t size{};
+  write_impl([&size](std::size_t s) noexcept {
+    size = s;
+    return std::span<uint8_t>{};
+  });
+  return size;
+}
+
+LIBREMIDI_INLINE
+std::size_t clip_writer::write_to(std::span<uint8_t> buffer) const
+{
+  return write_impl([buffer](std::size_t) noexcept { return buffer; });
+}
+
+LIBREMIDI_INLINE
+void clip_writer::write_to(std::vector<uint8_t>& buffer) const
+{
+  write_impl([&buffer](std::size_t size) {
+    buffer.resize(size);
+    return std::span<uint8_t>{buffer};
+  });
+}
+
+LIBREMIDI_INLINE
+void clip_writer::write(std::ostream& out) const
+{
+  std::vector<uint8_t> buffer;
+  write_to(buffer);
+  out.write(
+      reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+}
+}
@@ -0,0 +1,180 @@
+#pragma once
+#include <libremidi/reader.hpp>
+#include <libremidi/ump.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace libremidi
+{
+//! Number of 32-bit words of a UMP, given its first word, for all the message types
+//! including the reserved ones
+constexpr std::size_t ump_word_count(uint32_t first_word) noexcept
+{
+  constexpr uint8_t sizes[16]{1, 1, 1, 2, 2, 4, 1, 1, 2, 2, 2, 3, 3, 4, 4, 4};
+  return sizes[first_word >> 28];
+}
+
+//! A message of a clip file, at an absolute tick
+struct clip_event
+{
+  int64_t tick{};
+  const uint8_t* data{}; //! The big-endian words of the message, in the parsed buffer
+
+  [[nodiscard]] uint32_t word(std::size_t i) const noexcept
+  {
+    const uint8_t* p = data + 4 * i;
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return ump_word_count(word(0)); }
+
+  //! The message in host order. Its timestamp is left to 0: see clip_reader::tempoMap.
+  [[nodiscard]] ump to_ump() const noexcept
+  {
+    ump res;
+    for (std::size_t i = 0, n = size(); i < n; i++)
+      res.data[i] = word(i);
+    return res;
+  }
+};
+
+/**
+ * @brief Reads MIDI 2.0 clip files (SMF2CLIP), which store UMP messages with their timing.
+ *
+ * The messages are not copied: the events point to the words of the parsed buffer, which
+ * must outlive the reader unless it was loaded with parse_file.
+ * Delta clockstamps are accumulated into absolute ticks, and the JR clock, JR timestamp
+ * and NOOP messages are skipped, as they have no meaning in a file.
+ *
+ * ```
+ * libremidi::clip_reader r;
+ * if (r.parse_file("capture.midi2") != libremidi::reader::invalid)
+ *   for (const auto& ev : r.events)
+ *     out.send_ump(ev.to_ump());
+ * ```
+ */
+class LIBREMIDI_EXPORT clip_reader
+{
+public:
+  using parse_result = reader::parse_result;
+
+  clip_reader() noexcept;
+  ~clip_reader();
+
+  clip_reader(const clip_reader&) = delete;
+  clip_reader& operator=(const clip_reader&) = delete;
+  clip_reader(clip_reader&&) noexcept = default;
+  clip_reader& operator=(clip_reader&&) noexcept = default;
+
+  parse_result parse(const uint8_t* data, std::size_t size) noexcept;
+  parse_result parse(const std::vector<uint8_t>& buffer) noexcept;
+  parse_result parse(std::span<const uint8_t> buffer) noexcept;
+
+  //! Parses a file directly from a read-only memory mapping of it,
+  //! kept until the next parse so that the events can refer to it
+  parse_result parse_file(const std::filesystem::path& path) noexcept;
+
+  //! Tick of the End of Clip message
+  [[nodiscard]] int64_t get_end_tick() const noexcept { return endTick; }
+  [[nodiscard]] double get_end_seconds() const noexcept;
+
+  //! From the Delta Clockstamp Ticks Per Quarter Note message of the clip header
+  int ticksPerQuarterNote{};
+
+  //! From the Set Tempo messages of the clip. Their unit is 10 nanoseconds,
+  //! so the tempo is rounded to the microsecond.
+  tempo_map tempoMap;
+
+  //! Messages of the clip header other than the ticks per quarter note, at tick 0
+  std::vector<clip_event> configuration;
+
+  //! Messages of the clip, in file order, without the Start and End of Clip messages
+  std::vector<clip_event> events;
+
+  //! What could not be parsed or validated, in file order. The track is 0 for the
+  //! messages of the clip, and -1 for the file header and the clip header.
+  std::vector<parse_diagnostic> diagnostics;
+
+private:
+  std::shared_ptr<const void> m_file;
+  int64_t endTick{};
+};
+
+/**
+ * @brief Writes MIDI 2.0 clip files (SMF2CLIP).
+ *
+ * The messages are stored as a single contiguous array of words. They can be added at
+ * absolute ticks in any order: they are sorted by tick when writing, keeping the order
+ * of the messages at the same tick. Ticks between two messages larger than what a
+ * delta clockstamp can hold are split over several consecutive delta clockstamps.
+ */
+class LIBREMIDI_EXPORT clip_writer
+{
+public:
+  //! Written in the clip header
+  int ticksPerQuarterNote{480};
+
+  //! In microseconds per quarter note. Written as a Set Tempo message at the start
+  //! of the clip unless it is the default tempo of 120 BPM, and used to convert
+  //! the JR timestamps of the streams given to add_stream.
+  uint32_t tempo{500000};
+
+  //! The End of Clip message is written at this tick, or after the last message if later
+  int64_t endTick{};
+
+  //! Adds a message to the clip header, e.g. a profile or stream configuration message
+  void add_configuration(const ump& m);
+
+  //! Adds the messages of the span, all at the same tick
+  void add_event(int64_t tick, const ump& m);
+  void add_event(int64_t tick, std::span<const uint32_t> words);
+
+  //! Adds a stream in which the time is given by utility messages, e.g. as captured from
+  //! a device: delta clockstamps advance by their number of ticks, and JR timestamps
+  //! by the time elapsed since the previous one, converted with the tempo.
+  //! Returns the tick reached at the end of the stream.
+  int64_t add_stream(int64_t tick, std::span<const uint32_t> words);
+
+  void clear() noexcept;
+
+  //! Number of messages, without the ones of the clip header
+  [[nodiscard]] std::size_t size() const noexcept { return m_events.size(); }
+
+  void write(std::ostream& out) const;
+
+  //! Exact size of the file written by write and write_to
+  [[nodiscard]] std::size_t encoded_size() const;
+
+  //! Writes the file in the buffer, and returns its size,
+  //! or 0 without writing anything if the buffer is too small
+  std::size_t write_to(std::span<uint8_t> buffer) const;
+
+  //! Replaces the content of the buffer by the file
+  void write_to(std::vector<uint8_t>& buffer) const;
+
+private:
+  // get_buffer(size) gives the buffer to write the file to
+  template <typename GetBuffer>
+  std::size_t write_impl(GetBuffer get_buffer) const;
+
+  struct record
+  {
+    int64_t tick{};
+    uint32_t offset{}; // In m_words
+  };
+
+  std::vector<uint32_t> m_words;
+  std::vector<record> m_events;
+  std::vector<uint32_t> m_configuration;
+  bool m_sorted{true};
+};
+}
+
+#if defined(LIBREMIDI_HEADER_ONLY)
+  #include <libremidi/clip_file.cpp>
+#endif
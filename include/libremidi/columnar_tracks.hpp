@@ -0,0 +1,149 @@
+#pragma once
+#include <libremidi/merged_tracks.hpp>
+#include <libremidi/message.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace libremidi
+{
+/**
+ * @brief The events of several tracks as parallel arrays, one per field, in time order.
+ *
+ * Scanning a field only reads that field, contiguously, instead of following the bytes
+ * of each message: counts and filters over the columns can be vectorized by the compiler.
+ * Events are ordered as merged_tracks gives them, so ticks are sorted.
+ *
+ * ```
+ * libremidi::columnar_tracks cols = r.columns();
+ * auto loud_notes = cols.select([](uint8_t status, uint8_t, uint8_t data2) {
+ *   return (status & 0xF0) == 0x90 && data2 > 100;
+ * });
+ * ```
+ */
+struct columnar_tracks
+{
+  columnar_tracks() = default;
+
+  //! absolute_ticks tells whether the ticks of the tracks are already absolute,
+  //! as with libremidi::reader{true}, or deltas
+  explicit columnar_tracks(std::span<const midi_track> tracks, bool absolute_ticks = false)
+  {
+    std::size_t count = 0;
+    std::size_t payload_size = 0;
+    for (const auto& t : tracks)
+    {
+      count += t.size();
+      for (const auto& ev : t)
+        if (!is_channel_message(ev.m))
+          payload_size += ev.m.size();
+    }
+
+    tick.reserve(count);
+    track.reserve(count);
+    status.reserve(count);
+    data1.reserve(count);
+    data2.reserve(count);
+    payload_offsets.reserve(count + 1);
+    payload.reserve(payload_size);
+
+    for (const track_event_view ev : merged_tracks{tracks, absolute_ticks})
+    {
+      const auto& bytes = ev.m.bytes;
+      tick.push_back(ev.tick);
+      track.push_back(uint16_t(ev.track));
+      status.push_back(bytes.size() > 0 ? bytes[0] : 0);
+      data1.push_back(bytes.size() > 1 ? bytes[1] : 0);
+      data2.push_back(bytes.size() > 2 ? bytes[2] : 0);
+      if (!is_channel_message(bytes))
+        payload.insert(payload.end(), bytes.begin(), bytes.end());
+      payload_offsets.push_back(uint32_t(payload.size()));
+    }
+  }
+
+  std::vector<int64_t> tick; //! Absolute
+  std::vector<uint16_t> track;
+  std::vector<uint8_t> status;
+
+  //! The bytes after the status, or 0. For meta events, data1 is the type.
+  std::vector<uint8_t> data1;
+  std::vector<uint8_t> data2;
+
+  //! The whole bytes of the events which are not channel messages, e.g. meta events
+  //! and sysex, are in payload from payload_offsets[i] to payload_offsets[i + 1]
+  std::vector<uint32_t> payload_offsets{0};
+  std::vector<uint8_t> payload;
+
+  [[nodiscard]] std::size_t size() const noexcept { return tick.size(); }
+  [[nodiscard]] bool empty() const noexcept { return tick.empty(); }
+
+  //! Bytes of a meta event or sysex, empty for channel messages
+  [[nodiscard]] std::span<const uint8_t> payload_of(std::size_t i) const noexcept
+  {
+    return std::span<const uint8_t>{payload}.subspan(
+        payload_offsets[i], payload_offsets[i + 1] - payload_offsets[i]);
+  }
+
+  [[nodiscard]] message to_message(std::size_t i) const
+  {
+    message m;
+    if (const auto p = payload_of(i); !p.empty())
+    {
+      m.bytes.assign(p.begin(), p.end());
+    }
+    else if (status[i] >= 0x80 && status[i] < 0xF0)
+    {
+      m.bytes = {status[i], data1[i], data2[i]};
+      m.bytes.resize(channel_message_size(status[i]));
+    }
+    return m;
+  }
+
+  //! The tick is absolute
+  [[nodiscard]] track_event to_event(std::size_t i) const
+  {
+    return {int(tick[i]), int(track[i]), to_message(i)};
+  }
+
+  //! Indices of the events for which pred(status, data1, data2) is true, in order
+  template <typename Predicate>
+  [[nodiscard]] std::vector<uint32_t> select(Predicate pred) const
+  {
+    // Every index is written, and only kept if it matches: there is no branch
+    std::vector<uint32_t> res(size());
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < res.size(); i++)
+    {
+      res[n] = uint32_t(i);
+      n += pred(status[i], data1[i], data2[i]) ? 1 : 0;
+    }
+    res.resize(n);
+    return res;
+  }
+
+  //! Number of events for which pred(status, data1, data2) is true
+  template <typename Predicate>
+  [[nodiscard]] std::size_t count(Predicate pred) const
+  {
+    std::size_t n = 0;
+    for (std::size_t i = 0, N = size(); i < N; i++)
+      n += pred(status[i], data1[i], data2[i]) ? 1 : 0;
+    return n;
+  }
+
+private:
+  static std::size_t channel_message_size(uint8_t status) noexcept
+  {
+    const auto type = status & 0xF0;
+    return type == 0xC0 || type == 0xD0 ? 2 : 3;
+  }
+
+  static bool is_channel_message(std::span<const uint8_t> bytes) noexcept
+  {
+    return !bytes.empty() && bytes[0] >= 0x80 && bytes[0] < 0xF0
+           && bytes.size() == channel_message_size(bytes[0]);
+  }
+};
+}
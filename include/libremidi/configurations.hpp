@@ -2,6 +2,7 @@
 
 #if defined(__linux__)
   #include <libremidi/backends/alsa_raw/config.hpp>
+  #include <libremidi/backends/alsa_raw_direct/config.hpp>
   #include <libremidi/backends/alsa_raw_ump/config.hpp>
   #include <libremidi/backends/alsa_seq/config.hpp>
   #include <libremidi/backends/alsa_seq_ump/config.hpp>
@@ -24,6 +25,7 @@
 #endif
 
 #include <libremidi/backends/jack/config.hpp>
+#include <libremidi/backends/loopback/config.hpp>
 
 namespace libremidi
 {
@@ -0,0 +1,149 @@
+#pragma once
+
+#if defined(_WIN32)
+  #if !defined(NOMINMAX)
+    #define NOMINMAX 1
+  #endif
+  #if !defined(WIN32_LEAN_AND_MEAN)
+    #define WIN32_LEAN_AND_MEAN 1
+  #endif
+  #include <windows.h>
+#elif __has_include(<sys/mman.h>) && !defined(__EMSCRIPTEN__)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#else
+  #include <fstream>
+  #include <iterator>
+  #include <vector>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace libremidi
+{
+//! Read-only view of a whole file, mapped in memory when the platform supports it
+//! and read into memory otherwise.
+class mapped_file
+{
+public:
+  mapped_file() noexcept = default;
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+  ~mapped_file() { close(); }
+
+  //! Maps the file, with a hint that it is going to be read sequentially
+  bool open(const std::filesystem::path& path) noexcept
+  {
+    close();
+#if defined(_WIN32)
+    m_file = CreateFileW(
+        path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+      return false;
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(m_file, &size))
+      return close(), false;
+    m_size = static_cast<std::size_t>(size.QuadPart);
+    if (m_size == 0)
+      return true;
+
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+      return close(), false;
+
+    m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_data)
+      return close(), false;
+    return true;
+#elif __has_include(<sys/mman.h>) && !defined(__EMSCRIPTEN__)
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      return false;
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0)
+    {
+      ::close(fd);
+      return false;
+    }
+    m_size = static_cast<std::size_t>(st.st_size);
+    if (m_size == 0)
+    {
+      ::close(fd);
+      return true;
+    }
+
+  #if defined(POSIX_FADV_SEQUENTIAL)
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  #endif
+    void* ptr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file alive
+    ::close(fd);
+    if (ptr == MAP_FAILED)
+    {
+      m_size = 0;
+      return false;
+    }
+    ::madvise(ptr, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const uint8_t*>(ptr);
+    return true;
+#else
+    std::ifstream file{path, std::ios::binary};
+    if (!file.is_open())
+      return false;
+    try
+    {
+      m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    catch (...)
+    {
+      return false;
+    }
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    return true;
+#endif
+  }
+
+  void close() noexcept
+  {
+#if defined(_WIN32)
+    if (m_data)
+      UnmapViewOfFile(m_data);
+    if (m_mapping)
+      CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+      CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+#elif __has_include(<sys/mman.h>) && !defined(__EMSCRIPTEN__)
+    if (m_data)
+      ::munmap(const_cast<uint8_t*>(m_data), m_size);
+#else
+    m_buffer = {};
+#endif
+    m_data = nullptr;
+    m_size = 0;
+  }
+
+  const uint8_t* data() const noexcept { return m_data; }
+  std::size_t size() const noexcept { return m_size; }
+
+private:
+  const uint8_t* m_data{};
+  std::size_t m_size{};
+#if defined(_WIN32)
+  HANDLE m_file{INVALID_HANDLE_VALUE};
+  HANDLE m_mapping{};
+#elif __has_include(<sys/mman.h>) && !defined(__EMSCRIPTEN__)
+#else
+  std::vector<uint8_t> m_buffer;
+#endif
+};
+}
@@ -3,7 +3,11 @@
 #include <libremidi/config.hpp>
 #include <libremidi/observer_configuration.hpp>
 #include <libremidi/error_handler.hpp>
+#include <libremidi/detail/port_cache.hpp>
+#include <libremidi/detail/port_debouncer.hpp>
+#include <libremidi/detail/port_registry.hpp>
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -17,6 +21,17 @@ public:
   virtual libremidi::API get_current_api() const noexcept = 0;
   virtual std::vector<libremidi::input_port> get_input_ports() const noexcept = 0;
   virtual std::vector<libremidi::output_port> get_output_ports() const noexcept = 0;
+
+  mutable port_registry registry;
+
+  //! Set if observer_configuration::cache_ports was requested
+  std::shared_ptr<port_cache> cache;
+
+  //! Set if observer_configuration::on_changes was provided
+  std::shared_ptr<port_debouncer> debouncer;
+
+  //! Set after the first enumeration, which is reported to the startup profiler
+  mutable std::atomic_flag enumerated = ATOMIC_FLAG_INIT;
 };
 
 template <typename T, typename Arg>
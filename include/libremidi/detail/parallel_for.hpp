@@ -0,0 +1,97 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#if defined(__cpp_exceptions)
+  #include <exception>
+  #include <mutex>
+#endif
+
+#if defined(__LIBREMIDI_DEBUG__)
+  #include <iostream>
+#endif
+
+namespace libremidi::detail
+{
+/**
+ * Calls f(index, worker) for each index < count, on up to `threads` threads including
+ * the calling one. Each thread takes the next index which has not been processed yet;
+ * worker is the number of the thread, 0 being the calling thread, so that f can keep
+ * per-thread state without locking.
+ *
+ * If threads cannot be started, the work is done by the ones which could.
+ * If f throws, the indices which were not started yet are skipped, and the first
+ * exception is rethrown in the calling thread once every thread is done.
+ */
+template <typename F>
+void parallel_for(std::size_t count, int threads, F&& f)
+{
+  if (threads <= 1 || count <= 1)
+  {
+    for (std::size_t i = 0; i < count; i++)
+      f(i, 0);
+    return;
+  }
+
+  std::atomic_size_t next = 0;
+#if defined(__cpp_exceptions)
+  std::exception_ptr error;
+  std::mutex error_mutex;
+#endif
+
+  auto work = [&](int worker) noexcept {
+#if defined(__cpp_exceptions)
+    try
+    {
+      for (std::size_t i = next++; i < count; i = next++)
+        f(i, worker);
+    }
+    catch (...)
+    {
+      next = count;
+      std::lock_guard _{error_mutex};
+      if (!error)
+        error = std::current_exception();
+    }
+#else
+    for (std::size_t i = next++; i < count; i = next++)
+      f(i, worker);
+#endif
+  };
+
+  const int worker_count = int(std::min(std::size_t(threads), count)) - 1;
+  std::vector<std::thread> workers;
+#if defined(__cpp_exceptions)
+  try
+  {
+    workers.reserve(worker_count);
+    while (int(workers.size()) < worker_count)
+      workers.emplace_back(work, int(workers.size()) + 1);
+  }
+  catch (const std::exception& e)
+  {
+    // Go on with the threads we could start
+  #if defined(__LIBREMIDI_DEBUG__)
+    std::cerr << "libremidi: could not start a worker thread: " << e.what() << std::endl;
+  #endif
+  }
+#else
+  workers.reserve(worker_count);
+  while (int(workers.size()) < worker_count)
+    workers.emplace_back(work, int(workers.size()) + 1);
+#endif
+
+  work(0);
+
+  for (auto& t : workers)
+    t.join();
+
+#if defined(__cpp_exceptions)
+  if (error)
+    std::rethrow_exception(error);
+#endif
+}
+}
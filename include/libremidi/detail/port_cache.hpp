@@ -0,0 +1,178 @@
+#pragma once
+#include <libremidi/observer_configuration.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace libremidi
+{
+namespace detail
+{
+// Same identity as in the port_registry
+inline bool same_port(const port_information& lhs, const port_information& rhs) noexcept
+{
+  return lhs.client == rhs.client && lhs.port == rhs.port && lhs.port_name == rhs.port_name;
+}
+}
+
+//! Keeps an immutable snapshot of the ports of an observer, updated from its
+//! hotplug callbacks instead of querying the system.
+//! Readers only copy a shared_ptr; writers copy the lists and publish a new snapshot.
+class port_cache : public std::enable_shared_from_this<port_cache>
+{
+public:
+  //! Wraps the hotplug callbacks of a configuration so that they update the cache
+  //! before calling the user-provided ones
+  void attach(observer_configuration& conf)
+  {
+    const auto self = shared_from_this();
+    conf.input_added = [self, cb = std::move(conf.input_added)](const input_port& p) {
+      self->add(p);
+      if (cb)
+        cb(p);
+    };
+    conf.input_removed = [self, cb = std::move(conf.input_removed)](const input_port& p) {
+      self->remove(p);
+      if (cb)
+        cb(p);
+    };
+    conf.output_added = [self, cb = std::move(conf.output_added)](const output_port& p) {
+      self->add(p);
+      if (cb)
+        cb(p);
+    };
+    conf.output_removed = [self, cb = std::move(conf.output_removed)](const output_port& p) {
+      self->remove(p);
+      if (cb)
+        cb(p);
+    };
+  }
+
+  //! Builds the initial snapshot.
+  //! The back-end is enumerated without holding the lock, as back-ends call the hotplug
+  //! callbacks with their own locks held: the notifications received in the meantime are
+  //! kept, and applied in order over the enumeration when publishing it.
+  template <typename Observer>
+  void initialize(const Observer& obs)
+  {
+    auto snap = std::make_shared<port_snapshot>();
+    snap->inputs = obs.get_input_ports();
+    snap->outputs = obs.get_output_ports();
+
+    std::lock_guard _{m_mutex};
+    for (const auto& [added, p] : m_pending_inputs)
+      added ? apply_add(*snap, p) : apply_remove(*snap, p);
+    for (const auto& [added, p] : m_pending_outputs)
+      added ? apply_add(*snap, p) : apply_remove(*snap, p);
+    m_pending_inputs.clear();
+    m_pending_outputs.clear();
+
+    m_snapshot = std::move(snap);
+    m_ready = true;
+  }
+
+  uint64_t generation() const noexcept { return m_generation.load(std::memory_order_acquire); }
+
+  std::shared_ptr<const port_snapshot> snapshot() const
+  {
+    std::lock_guard _{m_mutex};
+    return m_snapshot;
+  }
+
+private:
+  template <typename Port>
+  using pending_list = std::vector<std::pair<bool, Port>>;
+
+  template <typename Port>
+  static auto& ports(port_snapshot& snap) noexcept
+  {
+    if constexpr (std::is_same_v<Port, input_port>)
+      return snap.inputs;
+    else
+      return snap.outputs;
+  }
+
+  template <typename Port>
+  auto& pending() noexcept
+  {
+    if constexpr (std::is_same_v<Port, input_port>)
+      return m_pending_inputs;
+    else
+      return m_pending_outputs;
+  }
+
+  // Return whether the snapshot changed
+  template <typename Port>
+  static bool apply_add(port_snapshot& snap, const Port& p)
+  {
+    auto& list = ports<Port>(snap);
+    auto it = std::find_if(list.begin(), list.end(), [&](const Port& other) {
+      return detail::same_port(p, other);
+    });
+    if (it == list.end())
+      list.push_back(p);
+    else if (*it != p)
+      *it = p;
+    else
+      return false;
+    return true;
+  }
+
+  template <typename Port>
+  static bool apply_remove(port_snapshot& snap, const Port& p)
+  {
+    auto same = [&](const Port& other) { return detail::same_port(p, other); };
+    return std::erase_if(ports<Port>(snap), same) > 0;
+  }
+
+  template <typename Port>
+  void add(const Port& p)
+  {
+    std::lock_guard _{m_mutex};
+    if (!m_ready)
+    {
+      pending<Port>().emplace_back(true, p);
+      return;
+    }
+
+    auto snap = std::make_shared<port_snapshot>(*m_snapshot);
+    if (apply_add(*snap, p))
+      publish(std::move(snap));
+  }
+
+  template <typename Port>
+  void remove(const Port& p)
+  {
+    std::lock_guard _{m_mutex};
+    if (!m_ready)
+    {
+      pending<Port>().emplace_back(false, p);
+      return;
+    }
+
+    auto snap = std::make_shared<port_snapshot>(*m_snapshot);
+    if (apply_remove(*snap, p))
+      publish(std::move(snap));
+  }
+
+  void publish(std::shared_ptr<port_snapshot> snap)
+  {
+    snap->generation = m_generation.load(std::memory_order_relaxed) + 1;
+    m_snapshot = std::move(snap);
+    m_generation.store(m_snapshot->generation, std::memory_order_release);
+  }
+
+  mutable std::mutex m_mutex;
+  std::shared_ptr<const port_snapshot> m_snapshot = std::make_shared<port_snapshot>();
+  std::atomic<uint64_t> m_generation{};
+  bool m_ready{};
+
+  // Notifications received before the first snapshot: true for an addition
+  pending_list<input_port> m_pending_inputs;
+  pending_list<output_port> m_pending_outputs;
+};
+}
@@ -0,0 +1,172 @@
+#pragma once
+#include <libremidi/detail/port_cache.hpp>
+#include <libremidi/detail/thread_policy.hpp>
+#include <libremidi/observer_configuration.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace libremidi
+{
+//! Collects the hotplug notifications of an observer and delivers them as a single
+//! port_changes once no change happened during the settle window.
+//! The delivery happens from a thread owned by the debouncer.
+class port_debouncer : public std::enable_shared_from_this<port_debouncer>
+{
+public:
+  port_debouncer(port_changes_callback cb, std::chrono::milliseconds window, thread_policy policy)
+      : m_callback{std::move(cb)}
+      , m_window{window}
+      , m_policy{std::move(policy)}
+  {
+    m_thread = std::thread{[this] { run(); }};
+  }
+
+  port_debouncer(const port_debouncer&) = delete;
+  port_debouncer& operator=(const port_debouncer&) = delete;
+
+  //! Pending changes are dropped
+  ~port_debouncer()
+  {
+    {
+      std::lock_guard _{m_mutex};
+      m_stop = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+  }
+
+  //! Wraps the hotplug callbacks of a configuration so that they also feed the debouncer.
+  //! The callbacks only keep a weak reference: the debouncer lives as long as the observer.
+  void attach(observer_configuration& conf)
+  {
+    const auto self = weak_from_this();
+    conf.input_added = [self, cb = std::move(conf.input_added)](const input_port& p) {
+      if (cb)
+        cb(p);
+      if (auto d = self.lock())
+        d->added(p);
+    };
+    conf.input_removed = [self, cb = std::move(conf.input_removed)](const input_port& p) {
+      if (cb)
+        cb(p);
+      if (auto d = self.lock())
+        d->removed(p);
+    };
+    conf.output_added = [self, cb = std::move(conf.output_added)](const output_port& p) {
+      if (cb)
+        cb(p);
+      if (auto d = self.lock())
+        d->added(p);
+    };
+    conf.output_removed = [self, cb = std::move(conf.output_removed)](const output_port& p) {
+      if (cb)
+        cb(p);
+      if (auto d = self.lock())
+        d->removed(p);
+    };
+    conf.on_changes = nullptr;
+  }
+
+private:
+  template <typename Port>
+  auto& added_list() noexcept
+  {
+    if constexpr (std::is_same_v<Port, input_port>)
+      return m_pending.inputs_added;
+    else
+      return m_pending.outputs_added;
+  }
+
+  template <typename Port>
+  auto& removed_list() noexcept
+  {
+    if constexpr (std::is_same_v<Port, input_port>)
+      return m_pending.inputs_removed;
+    else
+      return m_pending.outputs_removed;
+  }
+
+  // A port which disappears and comes back unchanged within the window is not reported
+  template <typename Port>
+  void added(const Port& p)
+  {
+    {
+      std::lock_guard _{m_mutex};
+      auto& removed = removed_list<Port>();
+      if (auto it = std::find(removed.begin(), removed.end(), p); it != removed.end())
+        removed.erase(it);
+      else
+        added_list<Port>().push_back(p);
+      m_last_change = std::chrono::steady_clock::now();
+    }
+    m_cv.notify_one();
+  }
+
+  // A port which appears and disappears within the window is not reported
+  template <typename Port>
+  void removed(const Port& p)
+  {
+    {
+      std::lock_guard _{m_mutex};
+      auto& added = added_list<Port>();
+      auto same = [&](const Port& other) { return detail::same_port(p, other); };
+      if (auto it = std::find_if(added.begin(), added.end(), same); it != added.end())
+        added.erase(it);
+      else
+        removed_list<Port>().push_back(p);
+      m_last_change = std::chrono::steady_clock::now();
+    }
+    m_cv.notify_one();
+  }
+
+  void run()
+  {
+    apply_thread_policy(m_policy, "observer debouncer");
+
+    std::unique_lock lock{m_mutex};
+    for (;;)
+    {
+      m_cv.wait(lock, [this] { return m_stop || m_last_change.has_value(); });
+      if (m_stop)
+        return;
+
+      // Restart the wait each time a change arrives before the end of the window
+      const auto deadline = *m_last_change + m_window;
+      if (std::chrono::steady_clock::now() < deadline)
+      {
+        m_cv.wait_until(lock, deadline);
+        continue;
+      }
+
+      m_last_change.reset();
+      auto changes = std::exchange(m_pending, {});
+      if (changes.empty())
+        continue;
+
+      lock.unlock();
+      m_callback(changes);
+      lock.lock();
+    }
+  }
+
+  port_changes_callback m_callback;
+  std::chrono::milliseconds m_window{};
+  thread_policy m_policy;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  port_changes m_pending;
+  std::optional<std::chrono::steady_clock::time_point> m_last_change;
+  bool m_stop{};
+
+  std::thread m_thread;
+};
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include <libremidi/observer_configuration.hpp>
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace libremidi
+{
+//! Interns ports into dense integer identifiers.
+//! A given port always maps to the same id for the lifetime of the registry,
+//! even if it disappears and comes back later.
+//! The string metadata is only copied once, when a port is first seen.
+class port_registry
+{
+public:
+  //! Returns the identifier of a port, allocating one if the port was never seen before
+  port_id intern(const input_port& p) { return intern(p, is_input); }
+  port_id intern(const output_port& p) { return intern(p, is_output); }
+
+  //! Returns the identifier of a port if it has already been interned
+  std::optional<port_id> find(const port_information& p) const
+  {
+    std::lock_guard _{m_mutex};
+    if (auto it = m_ids.find(key_view{p.client, p.port, p.port_name}); it != m_ids.end())
+      return it->second;
+    return std::nullopt;
+  }
+
+  std::optional<input_port> get_input(port_id id) const
+  {
+    std::lock_guard _{m_mutex};
+    if (id >= m_ports.size() || !(m_ports[id].direction & is_input))
+      return std::nullopt;
+    return input_port{m_ports[id].info};
+  }
+
+  std::optional<output_port> get_output(port_id id) const
+  {
+    std::lock_guard _{m_mutex};
+    if (id >= m_ports.size() || !(m_ports[id].direction & is_output))
+      return std::nullopt;
+    return output_port{m_ports[id].info};
+  }
+
+  std::size_t size() const
+  {
+    std::lock_guard _{m_mutex};
+    return m_ports.size();
+  }
+
+private:
+  enum direction_flags : uint8_t
+  {
+    is_input = 1 << 0,
+    is_output = 1 << 1
+  };
+
+  port_id intern(const port_information& p, direction_flags dir)
+  {
+    std::lock_guard _{m_mutex};
+    if (auto it = m_ids.find(key_view{p.client, p.port, p.port_name}); it != m_ids.end())
+    {
+      auto& entry = m_ports[it->second];
+      entry.direction |= dir;
+
+      // Display names can change over the lifetime of a port, e.g. when a device gets renamed
+      if (entry.info != p)
+        entry.info = p;
+      return it->second;
+    }
+
+    const auto id = static_cast<port_id>(m_ports.size());
+    m_ports.push_back({p, dir});
+    m_ids.emplace(key{p.client, p.port, p.port_name}, id);
+    return id;
+  }
+
+  // Some APIs (WinMM, JACK, WinMIDI...) do not have a numeric port handle
+  // and identify ports by name, thus the name is part of the identity.
+  struct key_view
+  {
+    client_handle client;
+    port_handle port;
+    std::string_view port_name;
+  };
+
+  struct key
+  {
+    client_handle client;
+    port_handle port;
+    std::string port_name;
+
+    operator key_view() const noexcept { return {client, port, port_name}; }
+  };
+
+  struct key_hash
+  {
+    using is_transparent = void;
+    std::size_t operator()(const key_view& k) const noexcept
+    {
+      std::size_t seed = std::hash<std::string_view>{}(k.port_name);
+      seed ^= std::hash<uint64_t>{}(k.client) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+      seed ^= std::hash<uint64_t>{}(k.port) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+      return seed;
+    }
+    std::size_t operator()(const key& k) const noexcept { return (*this)(key_view(k)); }
+  };
+
+  struct key_equal
+  {
+    using is_transparent = void;
+    bool operator()(const key_view& lhs, const key_view& rhs) const noexcept
+    {
+      return lhs.client == rhs.client && lhs.port == rhs.port && lhs.port_name == rhs.port_name;
+    }
+  };
+
+  struct entry
+  {
+    port_information info;
+    uint8_t direction{};
+  };
+
+  mutable std::mutex m_mutex;
+  std::unordered_map<key, port_id, key_hash, key_equal> m_ids;
+  std::vector<entry> m_ports;
+};
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+// Encoding of the events of Standard MIDI files, shared by the writer and the recorder
+namespace libremidi::util
+{
+// Big-endian stores, independent of the endianness of the host
+inline uint8_t* write_uint16_be(uint8_t* out, uint16_t value) noexcept
+{
+  out[0] = static_cast<uint8_t>(value >> 8);
+  out[1] = static_cast<uint8_t>(value);
+  return out + 2;
+}
+
+inline uint8_t* write_uint32_be(uint8_t* out, uint32_t value) noexcept
+{
+  out[0] = static_cast<uint8_t>(value >> 24);
+  out[1] = static_cast<uint8_t>(value >> 16);
+  out[2] = static_cast<uint8_t>(value >> 8);
+  out[3] = static_cast<uint8_t>(value);
+  return out + 4;
+}
+
+inline std::size_t variable_length_size(uint32_t aValue) noexcept
+{
+  std::size_t size = 1;
+  while (aValue >>= 7)
+    size++;
+  return size;
+}
+
+// Write a number to the midifile
+// as a variable length value which segments a file into 7-bit
+// values.  Maximum size of aValue is 0x7fffffff
+inline uint8_t* write_variable_length(uint32_t aValue, uint8_t* out) noexcept
+{
+  const std::size_t size = variable_length_size(aValue);
+  for (std::size_t i = size - 1; i > 0; i--)
+    *out++ = static_cast<uint8_t>(((aValue >> (7 * i)) & 0x7F) | 0x80);
+  *out++ = static_cast<uint8_t>(aValue & 0x7F);
+  return out;
+}
+
+// Counts the bytes that byte_writer would write
+struct byte_counter
+{
+  std::size_t size{};
+
+  void byte(uint8_t) noexcept { size++; }
+  void bytes(const uint8_t*, std::size_t n) noexcept { size += n; }
+  void variable_length(uint32_t v) noexcept { size += variable_length_size(v); }
+};
+
+struct byte_writer
+{
+  uint8_t* out{};
+
+  void byte(uint8_t b) noexcept { *out++ = b; }
+  void bytes(const uint8_t* b, std::size_t n) noexcept
+  {
+    std::memcpy(out, b, n);
+    out += n;
+  }
+  void variable_length(uint32_t v) noexcept { out = write_variable_length(v, out); }
+};
+
+// Encodes a non-empty event after its delta-time.
+// status is the running status, updated for the next event; 0 when there is none.
+template <typename Output>
+void encode_event(
+    uint32_t delta, std::span<const uint8_t> msg, bool runningStatus, uint8_t& status,
+    Output& out) noexcept
+{
+  const uint8_t* bytes = msg.data();
+  const std::size_t size = msg.size();
+
+  out.variable_length(delta);
+
+  if (bytes[0] == 0xF0 || bytes[0] == 0xF7)
+  {
+    // 0xf0 == Complete sysex message (0xf0 is part of the raw MIDI).
+    // 0xf7 == Raw byte message (0xf7 not part of the raw MIDI).
+    // Print the first byte of the message (0xf0 or 0xf7), then
+    // print a VLV length for the rest of the bytes in the message.
+    // In other words, when creating a 0xf0 or 0xf7 MIDI message,
+    // do not insert the VLV byte length yourself, as this code will
+    // do it for you automatically.
+    out.byte(bytes[0]);
+    out.variable_length(static_cast<uint32_t>(size - 1));
+    out.bytes(bytes + 1, size - 1);
+    status = 0;
+  }
+  else if (runningStatus && bytes[0] == status)
+  {
+    // Same channel message status as the previous event
+    out.bytes(bytes + 1, size - 1);
+  }
+  else
+  {
+    // Non-sysex type of message, so just output the bytes of the message:
+    out.bytes(bytes, size);
+
+    // Sysex and meta events cancel the running status
+    status = bytes[0] >= 0x80 && bytes[0] < 0xF0 ? bytes[0] : 0;
+  }
+}
+
+template <typename Output>
+void encode_end_of_track(uint32_t delta, Output& out) noexcept
+{
+  static constexpr uint8_t eot[3]{0xFF, 0x2F, 0x00};
+  out.variable_length(delta);
+  out.bytes(eot, 3);
+}
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+
+namespace libremidi
+{
+//! Lock-free queue of variable-size records, for one producer thread and one consumer thread.
+//! Each record is a timestamp followed by bytes, stored contiguously in a ring of bytes
+//! which never reallocates: pushing never blocks nor allocates, and fails when full.
+class spsc_byte_queue
+{
+public:
+  //! Not thread-safe: to be called before the producer and consumer start
+  bool allocate(std::size_t capacity) noexcept
+  {
+    std::size_t size = 64;
+    while (size < capacity)
+      size *= 2;
+
+    m_data.reset(new (std::nothrow) uint8_t[size]);
+    m_scratch.reset(new (std::nothrow) uint8_t[size]);
+    if (!m_data || !m_scratch)
+    {
+      m_data.reset();
+      m_scratch.reset();
+    }
+    m_capacity = m_data ? size : 0;
+    m_write.store(0, std::memory_order_relaxed);
+    m_read.store(0, std::memory_order_relaxed);
+    return bool(m_data);
+  }
+
+  std::size_t capacity() const noexcept { return m_capacity; }
+
+  //! Producer side
+  bool try_push(int64_t timestamp, std::span<const uint8_t> bytes) noexcept
+  {
+    const std::size_t record = sizeof(header) + bytes.size();
+    const std::size_t w = m_write.load(std::memory_order_relaxed);
+    const std::size_t r = m_read.load(std::memory_order_acquire);
+    if (m_capacity - (w - r) < record)
+      return false;
+
+    const header h{timestamp, bytes.size()};
+    copy_in(w, reinterpret_cast<const uint8_t*>(&h), sizeof(header));
+    copy_in(w + sizeof(header), bytes.data(), bytes.size());
+    m_write.store(w + record, std::memory_order_release);
+    return true;
+  }
+
+  //! Consumer side: calls f(int64_t timestamp, std::span<const uint8_t> bytes) for each record
+  //! pushed so far. The bytes are only valid during the call.
+  template <typename F>
+  std::size_t consume(F&& f) noexcept
+  {
+    const std::size_t w = m_write.load(std::memory_order_acquire);
+    std::size_t r = m_read.load(std::memory_order_relaxed);
+    std::size_t count = 0;
+    while (r != w)
+    {
+      header h;
+      copy_out(r, reinterpret_cast<uint8_t*>(&h), sizeof(header));
+
+      // Records are contiguous unless they wrap around the end of the ring
+      const std::size_t begin = (r + sizeof(header)) & (m_capacity - 1);
+      if (begin + h.size <= m_capacity)
+      {
+        f(h.timestamp, std::span<const uint8_t>{m_data.get() + begin, h.size});
+      }
+      else
+      {
+        copy_out(r + sizeof(header), m_scratch.get(), h.size);
+        f(h.timestamp, std::span<const uint8_t>{m_scratch.get(), h.size});
+      }
+
+      r += sizeof(header) + h.size;
+      count++;
+    }
+    m_read.store(r, std::memory_order_release);
+    return count;
+  }
+
+private:
+  struct header
+  {
+    int64_t timestamp;
+    std::size_t size;
+  };
+
+  void copy_in(std::size_t pos, const uint8_t* src, std::size_t n) noexcept
+  {
+    pos &= m_capacity - 1;
+    const std::size_t first = std::min(n, m_capacity - pos);
+    std::memcpy(m_data.get() + pos, src, first);
+    std::memcpy(m_data.get(), src + first, n - first);
+  }
+
+  void copy_out(std::size_t pos, uint8_t* dst, std::size_t n) const noexcept
+  {
+    pos &= m_capacity - 1;
+    const std::size_t first = std::min(n, m_capacity - pos);
+    std::memcpy(dst, m_data.get() + pos, first);
+    std::memcpy(dst + first, m_data.get(), n - first);
+  }
+
+  std::unique_ptr<uint8_t[]> m_data;
+  std::unique_ptr<uint8_t[]> m_scratch; // For the records which wrap around
+  std::size_t m_capacity{};
+
+  // On separate cache lines, as each is written by a different thread
+  alignas(64) std::atomic_size_t m_write{0};
+  alignas(64) std::atomic_size_t m_read{0};
+};
+}
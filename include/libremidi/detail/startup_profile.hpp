@@ -0,0 +1,52 @@
+#pragma once
+#include <libremidi/startup_profile.hpp>
+
+namespace libremidi::detail
+{
+//! Measures a startup phase for the duration of its scope.
+//! Does not read the clock when no profiler is installed.
+class startup_timer
+{
+public:
+  startup_timer(startup_phase phase, std::string_view backend) noexcept
+      : m_phase{phase}
+      , m_backend{backend}
+  {
+    if (startup_profiler_state::instance().enabled.load(std::memory_order_acquire))
+    {
+      m_enabled = true;
+      m_start = std::chrono::steady_clock::now();
+    }
+  }
+
+  startup_timer(const startup_timer&) = delete;
+  startup_timer& operator=(const startup_timer&) = delete;
+
+  ~startup_timer()
+  {
+    if (!m_enabled)
+      return;
+
+    const auto duration = std::chrono::steady_clock::now() - m_start;
+
+    auto& state = startup_profiler_state::instance();
+    std::shared_ptr<const startup_profiler> cb;
+    {
+      std::lock_guard _{state.mutex};
+      cb = state.callback;
+    }
+
+    if (cb)
+      (*cb)(startup_event{
+          .phase = m_phase,
+          .backend = m_backend,
+          .duration = std::chrono::duration_cast<std::chrono::nanoseconds>(duration)});
+  }
+
+private:
+  startup_phase m_phase{};
+  std::string_view m_backend;
+  std::chrono::steady_clock::time_point m_start{};
+  bool m_enabled{};
+};
+}
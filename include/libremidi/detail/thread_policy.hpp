@@ -0,0 +1,124 @@
+#pragma once
+#include <libremidi/thread_policy.hpp>
+
+#if defined(_WIN32)
+  #if !defined(NOMINMAX)
+    #define NOMINMAX 1
+  #endif
+  #if !defined(WIN32_LEAN_AND_MEAN)
+    #define WIN32_LEAN_AND_MEAN 1
+  #endif
+  #include <windows.h>
+#elif __has_include(<pthread.h>) && !defined(__EMSCRIPTEN__)
+  #include <pthread.h>
+  #include <sched.h>
+  #include <sys/mman.h>
+
+  #include <cerrno>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+namespace libremidi
+{
+namespace detail
+{
+// Touches the stack one page at a time; the write after the recursive call
+// prevents the compiler from turning it into a loop reusing the same frame.
+inline void prefault_stack(std::size_t bytes) noexcept
+{
+  volatile unsigned char page[4096];
+  page[0] = 0;
+  page[sizeof(page) - 1] = 0;
+  if (bytes > sizeof(page))
+    prefault_stack(bytes - sizeof(page));
+  page[1] = 0;
+}
+
+inline stdx::error set_scheduler(const thread_policy& policy) noexcept
+{
+  if (policy.scheduler == thread_scheduler::inherit)
+    return stdx::error{};
+
+#if defined(_WIN32)
+  if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL))
+    return std::errc::operation_not_permitted;
+  return stdx::error{};
+#elif __has_include(<pthread.h>) && !defined(__EMSCRIPTEN__)
+  const int sched = policy.scheduler == thread_scheduler::fifo ? SCHED_FIFO : SCHED_RR;
+  sched_param param{};
+  param.sched_priority = std::clamp(
+      policy.priority, sched_get_priority_min(sched), sched_get_priority_max(sched));
+  if (int err = pthread_setschedparam(pthread_self(), sched, &param); err != 0)
+    return static_cast<std::errc>(err);
+  return stdx::error{};
+#else
+  return std::errc::not_supported;
+#endif
+}
+
+inline stdx::error set_affinity(const thread_policy& policy) noexcept
+{
+  if (policy.cpus.empty())
+    return stdx::error{};
+
+#if defined(_WIN32)
+  DWORD_PTR mask = 0;
+  for (int cpu : policy.cpus)
+    if (cpu >= 0 && cpu < int(sizeof(DWORD_PTR) * 8))
+      mask |= DWORD_PTR(1) << cpu;
+  if (mask == 0 || !SetThreadAffinityMask(GetCurrentThread(), mask))
+    return std::errc::invalid_argument;
+  return stdx::error{};
+#elif defined(__linux__) && !defined(__EMSCRIPTEN__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : policy.cpus)
+    if (cpu >= 0 && cpu < CPU_SETSIZE)
+      CPU_SET(cpu, &set);
+  if (int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set); err != 0)
+    return static_cast<std::errc>(err);
+  return stdx::error{};
+#else
+  return std::errc::not_supported;
+#endif
+}
+
+inline stdx::error lock_memory(const thread_policy& policy) noexcept
+{
+  if (!policy.lock_memory)
+    return stdx::error{};
+
+#if !defined(_WIN32) && __has_include(<pthread.h>) && !defined(__EMSCRIPTEN__)
+  if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    return static_cast<std::errc>(errno);
+  return stdx::error{};
+#else
+  return std::errc::not_supported;
+#endif
+}
+}
+
+//! Applies a thread policy to the calling thread.
+//! Called at the beginning of every thread started by libremidi.
+inline thread_policy_report
+apply_thread_policy(const thread_policy& policy, std::string_view thread_name)
+{
+  thread_policy_report report{.thread = thread_name};
+  if (policy.empty())
+    return report;
+
+  report.memory_lock = detail::lock_memory(policy);
+  report.scheduling = detail::set_scheduler(policy);
+  report.affinity = detail::set_affinity(policy);
+
+  if (policy.prefault_stack > 0)
+    detail::prefault_stack(policy.prefault_stack);
+
+  if (policy.on_applied)
+    policy.on_applied(report);
+  return report;
+}
+}
@@ -2,6 +2,7 @@
 #include <libremidi/config.hpp>
 #include <libremidi/error.hpp>
 #include <libremidi/message.hpp>
+#include <libremidi/thread_policy.hpp>
 #include <libremidi/ump.hpp>
 
 #include <functional>
@@ -78,6 +79,9 @@ struct input_configuration
 
   //! Timestamp mode. See @libremidi::timestamp_mode
   uint32_t timestamps : 3 = timestamp_mode::Absolute;
+
+  //! Scheduling of the input thread, for the back-ends which start one
+  thread_policy threading{};
 };
 
 using ump_callback = std::function<void(ump&&)>;
@@ -114,5 +118,8 @@ struct ump_input_configuration
   uint32_t ignore_sensing : 1 = true;
 
   uint32_t timestamps : 3 = timestamp_mode::Absolute;
+
+  //! Scheduling of the input thread, for the back-ends which start one
+  thread_policy threading{};
 };
 }
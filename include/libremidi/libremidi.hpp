@@ -98,6 +98,29 @@ public:
   [[nodiscard]] std::vector<libremidi::input_port> get_input_ports() const noexcept;
   [[nodiscard]] std::vector<libremidi::output_port> get_output_ports() const noexcept;
 
+  //! Return a stable integer identifier for a port.
+  //! The same port always gets the same identifier for the lifetime of this observer,
+  //! which allows to use it as a cheap key in containers instead of the port itself.
+  //! A port seen for the first time is added to the registry, which may throw std::bad_alloc.
+  [[nodiscard]] port_id get_port_id(const libremidi::input_port& port) const;
+  [[nodiscard]] port_id get_port_id(const libremidi::output_port& port) const;
+
+  //! Return the port metadata associated to an identifier previously obtained
+  //! through get_port_id
+  [[nodiscard]] std::optional<libremidi::input_port> get_input_port(port_id id) const noexcept;
+  [[nodiscard]] std::optional<libremidi::output_port> get_output_port(port_id id) const noexcept;
+
+  //! Counter incremented each time a port appears or disappears.
+  //! Cheap enough to be polled, e.g. on every frame of a UI, to know when to call snapshot().
+  //! Only tracked with observer_configuration::cache_ports, otherwise always zero.
+  [[nodiscard]] uint64_t generation() const noexcept;
+
+  //! Immutable list of the available ports, which can be kept and shared across threads.
+  //! With observer_configuration::cache_ports, it is only rebuilt when the hotplug
+  //! callbacks fire and this is just a reference count increment.
+  //! Otherwise the system is queried on each call.
+  [[nodiscard]] std::shared_ptr<const port_snapshot> snapshot() const;
+
 private:
   std::unique_ptr<class observer_api> impl_;
 };
@@ -223,7 +246,7 @@ public:
   int64_t current_time();
 
   //! Try to schedule a message later in time if the underlying API supports it
-  //! (currently not implemented anywhere)
+  //! (currently only the loopback API), otherwise send it immediately
   stdx::error schedule_message(int64_t timestamp, const unsigned char* message, size_t size);
 
   //! Immediately send a single UMP packet to an open MIDI output port.
@@ -248,8 +271,8 @@ public:
   }
 #endif
 
-  //! Try to schedule an UMP packet later in time if the underlying API supports it
-  //! (currently not implemented anywhere)
+  //! Try to schedule an UMP packet later in time if the underlying API supports it,
+  //! otherwise send it immediately
   stdx::error schedule_ump(int64_t timestamp, const uint32_t* message, size_t size);
 
 private:
@@ -0,0 +1,157 @@
+#pragma once
+#include <libremidi/message.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <vector>
+
+namespace libremidi
+{
+/**
+ * @brief Lazy view of the events of several tracks as a single timeline.
+ *
+ * The tracks are merged with a heap of per-track cursors, so iterating
+ * costs O(log k) per event for k tracks, without copying or sorting the events.
+ * Ticks are absolute, and events at the same tick are given in track order,
+ * as a stable sort by tick of all the events would give them.
+ *
+ * ```
+ * for (libremidi::track_event_view ev : libremidi::merged_tracks{r.tracks})
+ *   ...
+ * ```
+ */
+class merged_tracks
+{
+public:
+  //! absolute_ticks tells whether the ticks of the tracks are already absolute,
+  //! as with libremidi::reader{true}, or deltas
+  explicit merged_tracks(std::span<const midi_track> tracks, bool absolute_ticks = false) noexcept
+      : m_tracks{tracks}
+      , m_absolute{absolute_ticks}
+  {
+  }
+
+  class iterator
+  {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = track_event_view;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+
+    iterator(std::span<const midi_track> tracks, bool absolute)
+        : m_tracks{tracks}
+        , m_absolute{absolute}
+    {
+      m_heap.reserve(tracks.size());
+      for (std::size_t t = 0; t < tracks.size(); t++)
+      {
+        if (!tracks[t].empty())
+          m_heap.push_back({tracks[t].front().tick, uint32_t(t), 0});
+      }
+      std::make_heap(m_heap.begin(), m_heap.end(), order);
+    }
+
+    //! The tick is absolute, the track is the index of the track in the span
+    track_event_view operator*() const noexcept
+    {
+      const auto& top = m_heap.front();
+      const auto& msg = m_tracks[top.track][top.index].m;
+      return {
+          .tick = static_cast<int>(top.tick),
+          .track = int(top.track),
+          .m = {.bytes = {msg.bytes.data(), msg.bytes.size()}, .timestamp = msg.timestamp}};
+    }
+
+    iterator& operator++()
+    {
+      std::pop_heap(m_heap.begin(), m_heap.end(), order);
+      auto& next = m_heap.back();
+      const auto& track = m_tracks[next.track];
+      if (++next.index < track.size())
+      {
+        const int tick = track[next.index].tick;
+        next.tick = m_absolute ? tick : next.tick + tick;
+        std::push_heap(m_heap.begin(), m_heap.end(), order);
+      }
+      else
+      {
+        m_heap.pop_back();
+      }
+      return *this;
+    }
+
+    void operator++(int) { ++*this; }
+
+    bool operator==(std::default_sentinel_t) const noexcept { return m_heap.empty(); }
+
+  private:
+    struct cursor
+    {
+      int64_t tick{};
+      uint32_t track{};
+      std::size_t index{};
+    };
+
+    // The std heap functions build max-heaps: the first cursor is the one with the
+    // lowest (tick, track)
+    static bool order(const cursor& lhs, const cursor& rhs) noexcept
+    {
+      return lhs.tick != rhs.tick ? lhs.tick > rhs.tick : lhs.track > rhs.track;
+    }
+
+    std::span<const midi_track> m_tracks;
+    std::vector<cursor> m_heap;
+    bool m_absolute{};
+  };
+
+  iterator begin() const { return iterator{m_tracks, m_absolute}; }
+  std::default_sentinel_t end() const noexcept { return {}; }
+
+  //! Copies the events into a single format-0 track, in one pass.
+  //! The end-of-track events of the tracks are replaced by a single one at the end,
+  //! at the tick of the last of them.
+  midi_track to_track(bool absolute_ticks = false) const
+  {
+    std::size_t count = 0;
+    for (const auto& track : m_tracks)
+      count += track.size();
+
+    midi_track res;
+    res.reserve(count);
+
+    int previous = 0;
+    int end_tick = 0;
+    bool has_end = false;
+    for (iterator it = begin(); it != std::default_sentinel; ++it)
+    {
+      const auto ev = *it;
+      if (ev.m.size() >= 2 && ev.m.get_meta_event_type() == meta_event_type::END_OF_TRACK)
+      {
+        end_tick = std::max(end_tick, ev.tick);
+        has_end = true;
+        continue;
+      }
+
+      res.push_back({absolute_ticks ? ev.tick : ev.tick - previous, 0, ev.m.to_message()});
+      previous = ev.tick;
+    }
+
+    if (has_end)
+    {
+      end_tick = std::max(end_tick, previous);
+      res.push_back(
+          {absolute_ticks ? end_tick : end_tick - previous, 0, meta_events::end_of_track()});
+    }
+    return res;
+  }
+
+private:
+  std::span<const midi_track> m_tracks;
+  bool m_absolute{};
+};
+}
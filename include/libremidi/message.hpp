@@ -284,4 +284,75 @@ struct track_event
 };
 
 typedef std::vector<track_event> midi_track;
+
+//! Non-owning equivalent of message, e.g. pointing into a MIDI file.
+//! Has the same read-only interface, so that code written for message works with it.
+struct message_view
+{
+  std::span<const uint8_t> bytes;
+  int64_t timestamp{};
+
+  operator std::span<const unsigned char>() const noexcept { return bytes; }
+
+  auto size() const noexcept { return bytes.size(); }
+  auto empty() const noexcept { return bytes.empty(); }
+
+  auto& operator[](std::size_t i) const noexcept { return bytes[i]; }
+  auto& front() const { return bytes.front(); }
+  auto& back() const { return bytes.back(); }
+
+  auto begin() const noexcept { return bytes.begin(); }
+  auto end() const noexcept { return bytes.end(); }
+  auto rbegin() const noexcept { return bytes.rbegin(); }
+  auto rend() const noexcept { return bytes.rend(); }
+
+  int get_channel() const noexcept
+  {
+    if ((bytes[0] & 0xF0) != 0xF0)
+      return (bytes[0] & 0xF) + 1;
+    return 0;
+  }
+
+  bool is_meta_event() const noexcept { return bytes[0] == 0xFF; }
+
+  meta_event_type get_meta_event_type() const noexcept
+  {
+    if (!is_meta_event())
+      return meta_event_type::UNKNOWN;
+    return static_cast<meta_event_type>(bytes[1]);
+  }
+
+  message_type get_message_type() const noexcept
+  {
+    if (bytes[0] >= static_cast<uint8_t>(message_type::SYSTEM_EXCLUSIVE))
+      return static_cast<message_type>(bytes[0] & 0xFF);
+    else
+      return static_cast<message_type>(bytes[0] & 0xF0);
+  }
+
+  bool is_note_on_or_off() const noexcept
+  {
+    const auto status = get_message_type();
+    return (status == message_type::NOTE_ON) || (status == message_type::NOTE_OFF);
+  }
+
+  //! Copies the bytes into an owning message
+  message to_message() const
+  {
+    message m;
+    m.bytes.assign(bytes.begin(), bytes.end());
+    m.timestamp = timestamp;
+    return m;
+  }
+};
+
+//! Non-owning equivalent of track_event
+struct track_event_view
+{
+  int tick = 0;
+  int track = 0;
+  message_view m;
+
+  track_event to_event() const { return {tick, track, m.to_message()}; }
+};
 }
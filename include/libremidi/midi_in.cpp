@@ -4,6 +4,7 @@
 
 #include <libremidi/backends.hpp>
 #include <libremidi/detail/midi_api.hpp>
+#include <libremidi/detail/startup_profile.hpp>
 
 #include <cassert>
 
@@ -18,6 +19,7 @@ LIBREMIDI_INLINE auto make_midi_in(auto base_conf, std::any api_conf, auto backe
   auto from_api = [&]<typename T>(T& /*backend*/) mutable {
     if (auto conf = std::any_cast<typename T::midi_in_configuration>(&api_conf))
     {
+      detail::startup_timer _{startup_phase::client_creation, T::name};
       ptr = libremidi::make<typename T::midi_in>(std::move(base_conf), std::move(*conf));
       return true;
     }
@@ -29,19 +31,18 @@ LIBREMIDI_INLINE auto make_midi_in(auto base_conf, std::any api_conf, auto backe
 
 LIBREMIDI_INLINE midi_in::midi_in(const input_configuration& base_conf) noexcept
 {
-  for (const auto& api : available_apis())
-  {
+  midi1::for_first_backend([&]<typename T>(const T&) {
     try
     {
-      impl_ = make_midi_in(base_conf, midi_in_configuration_for(api), midi1::available_backends);
+      impl_ = make_midi_in(
+          base_conf, typename T::midi_in_configuration{}, midi1::available_backends);
     }
     catch (const std::exception& e)
     {
     }
+    return bool(impl_);
+  });
 
-    if (impl_)
-      return;
-  }
   if (!impl_)
     impl_ = std::make_unique<midi_in_dummy>(input_configuration{}, dummy_configuration{});
 }
@@ -4,6 +4,7 @@
 
 #include <libremidi/backends.hpp>
 #include <libremidi/detail/midi_api.hpp>
+#include <libremidi/detail/startup_profile.hpp>
 
 #include <array>
 #include <cassert>
@@ -16,31 +17,30 @@ LIBREMIDI_INLINE auto make_midi_out(auto base_conf, std::any api_conf)
   auto from_api = [&]<typename T>(T& /*backend*/) mutable {
     if (auto conf = std::any_cast<typename T::midi_out_configuration>(&api_conf))
     {
+      detail::startup_timer _{startup_phase::client_creation, T::name};
       ptr = libremidi::make<typename T::midi_out>(std::move(base_conf), std::move(*conf));
       return true;
     }
     return false;
   };
-  std::apply([&](auto&&... b) { (from_api(b) || ...); }, midi1::available_backends);
-  std::apply([&](auto&&... b) { (from_api(b) || ...); }, midi2::available_backends);
+  // Some configuration types, e.g. the dummy one, are shared between the MIDI 1 and 2 back-ends
+  std::apply([&](auto&&... b) { return (from_api(b) || ...); }, midi1::available_backends)
+      || std::apply([&](auto&&... b) { return (from_api(b) || ...); }, midi2::available_backends);
   return ptr;
 }
 
 LIBREMIDI_INLINE midi_out::midi_out(const output_configuration& base_conf) noexcept
 {
-  for (const auto& api : available_apis())
-  {
+  midi1::for_first_backend([&]<typename T>(const T&) {
     try
     {
-      impl_ = make_midi_out(base_conf, midi_out_configuration_for(api));
+      impl_ = make_midi_out(base_conf, typename T::midi_out_configuration{});
     }
     catch (const std::exception& e)
     {
     }
-
-    if (impl_)
-      return;
-  }
+    return bool(impl_);
+  });
 
   if (!impl_)
     impl_ = std::make_unique<midi_out_dummy>(output_configuration{}, dummy_configuration{});
@@ -233,4 +233,22 @@ stdx::error midi_out::send_ump(uint32_t b0, uint32_t b1, uint32_t b2, uint32_t b
   return send_ump(std::to_array({b0, b1, b2, b3}));
 }
 
+
+LIBREMIDI_INLINE
+int64_t midi_out::current_time()
+{
+  return impl_->current_time();
+}
+
+LIBREMIDI_INLINE
+stdx::error midi_out::schedule_message(int64_t ts, const unsigned char* message, size_t size)
+{
+  return impl_->schedule_message(ts, message, size);
+}
+
+LIBREMIDI_INLINE
+stdx::error midi_out::schedule_ump(int64_t ts, const uint32_t* message, size_t size)
+{
+  return impl_->schedule_ump(ts, message, size);
+}
 }
@@ -4,6 +4,7 @@
 
 #include <libremidi/backends.hpp>
 #include <libremidi/detail/midi_api.hpp>
+#include <libremidi/detail/startup_profile.hpp>
 
 namespace libremidi
 {
@@ -13,45 +14,105 @@ LIBREMIDI_INLINE auto make_observer(auto base_conf, std::any api_conf)
   auto from_api = [&]<typename T>(T& /*backend*/) mutable {
     if (auto conf = std::any_cast<typename T::midi_observer_configuration>(&api_conf))
     {
+      detail::startup_timer _{startup_phase::client_creation, T::name};
       ptr = libremidi::make<typename T::midi_observer>(std::move(base_conf), std::move(*conf));
       return true;
     }
     return false;
   };
-  std::apply([&](auto&&... b) { (from_api(b) || ...); }, midi1::available_backends);
-  std::apply([&](auto&&... b) { (from_api(b) || ...); }, midi2::available_backends);
+  // Some configuration types, e.g. the dummy one, are shared between the MIDI 1 and 2 back-ends
+  std::apply([&](auto&&... b) { return (from_api(b) || ...); }, midi1::available_backends)
+      || std::apply([&](auto&&... b) { return (from_api(b) || ...); }, midi2::available_backends);
   return ptr;
 }
 
+// The debouncer is fed by the hotplug callbacks, like the cache
+LIBREMIDI_INLINE std::shared_ptr<port_debouncer> make_port_debouncer(observer_configuration& conf)
+{
+  if (!conf.on_changes)
+    return {};
+
+  auto debouncer = std::make_shared<port_debouncer>(
+      std::move(conf.on_changes), conf.settle_window, conf.threading);
+  debouncer->attach(conf);
+  return debouncer;
+}
+
+// The cache is filled by the hotplug callbacks: they are wrapped before the back-end sees them
+LIBREMIDI_INLINE std::shared_ptr<port_cache> make_port_cache(observer_configuration& conf)
+{
+  if (!conf.cache_ports)
+    return {};
+
+  auto cache = std::make_shared<port_cache>();
+  cache->attach(conf);
+  return cache;
+}
+
+LIBREMIDI_INLINE void init_port_cache(observer_api& impl, std::shared_ptr<port_cache> cache)
+{
+  if (!cache)
+    return;
+
+  // Building the snapshot is the first enumeration of the observer
+  impl.enumerated.test_and_set(std::memory_order_relaxed);
+  detail::startup_timer _{startup_phase::first_enumeration, get_api_name(impl.get_current_api())};
+  cache->initialize(impl);
+  impl.cache = std::move(cache);
+}
+
+// Reports the first enumeration of each observer to the startup profiler
+LIBREMIDI_INLINE auto enumerate(const observer_api& impl, auto func)
+{
+  if (impl.enumerated.test_and_set(std::memory_order_relaxed))
+    return func();
+
+  detail::startup_timer _{startup_phase::first_enumeration, get_api_name(impl.get_current_api())};
+  return func();
+}
+
 LIBREMIDI_INLINE observer::observer(const observer_configuration& base_conf) noexcept
 {
-  for (const auto& api : available_apis())
-  {
+  auto conf = base_conf;
+  auto debouncer = make_port_debouncer(conf);
+  auto cache = make_port_cache(conf);
+  midi1::for_first_backend([&]<typename T>(const T&) {
     try
     {
-      impl_ = make_observer(base_conf, observer_configuration_for(api));
+      impl_ = make_observer(conf, typename T::midi_observer_configuration{});
     }
     catch (const std::exception& e)
     {
     }
+    return bool(impl_);
+  });
 
-    if (impl_)
-      return;
+  if (impl_)
+  {
+    impl_->debouncer = std::move(debouncer);
+    init_port_cache(*impl_, std::move(cache));
   }
-
-  if (!impl_)
+  else
+  {
     impl_ = std::make_unique<observer_dummy>(observer_configuration{}, dummy_configuration{});
+  }
 }
 
 LIBREMIDI_INLINE observer::observer(observer_configuration base_conf, std::any api_conf)
-    : impl_{make_observer(base_conf, api_conf)}
 {
+  auto debouncer = make_port_debouncer(base_conf);
+  auto cache = make_port_cache(base_conf);
+  impl_ = make_observer(base_conf, api_conf);
   if (!impl_)
   {
     error_handler e;
     e.libremidi_handle_error(base_conf, "Could not open observer for the given api");
     impl_ = std::make_unique<observer_dummy>(observer_configuration{}, dummy_configuration{});
+    return;
   }
+
+  impl_->debouncer = std::move(debouncer);
+  init_port_cache(*impl_, std::move(cache));
 }
 
 LIBREMIDI_INLINE observer::observer(observer&& other) noexcept
@@ -81,12 +142,58 @@ libremidi::API observer::get_current_api() const noexcept
 LIBREMIDI_INLINE
 std::vector<libremidi::input_port> observer::get_input_ports() const noexcept
 {
-  return impl_->get_input_ports();
+  if (impl_->cache)
+    return impl_->cache->snapshot()->inputs;
+  return enumerate(*impl_, [this] { return impl_->get_input_ports(); });
 }
 
 LIBREMIDI_INLINE
 std::vector<libremidi::output_port> observer::get_output_ports() const noexcept
 {
-  return impl_->get_output_ports();
+  if (impl_->cache)
+    return impl_->cache->snapshot()->outputs;
+  return enumerate(*impl_, [this] { return impl_->get_output_ports(); });
+}
+
+LIBREMIDI_INLINE
+port_id observer::get_port_id(const libremidi::input_port& port) const
+{
+  return impl_->registry.intern(port);
+}
+
+LIBREMIDI_INLINE
+port_id observer::get_port_id(const libremidi::output_port& port) const
+{
+  return impl_->registry.intern(port);
+}
+
+LIBREMIDI_INLINE
+std::optional<libremidi::input_port> observer::get_input_port(port_id id) const noexcept
+{
+  return impl_->registry.get_input(id);
+}
+
+LIBREMIDI_INLINE
+std::optional<libremidi::output_port> observer::get_output_port(port_id id) const noexcept
+{
+  return impl_->registry.get_output(id);
+}
+
+LIBREMIDI_INLINE
+uint64_t observer::generation() const noexcept
+{
+  return impl_->cache ? impl_->cache->generation() : 0;
+}
+
+LIBREMIDI_INLINE
+std::shared_ptr<const port_snapshot> observer::snapshot() const
+{
+  if (impl_->cache)
+    return impl_->cache->snapshot();
+
+  auto snap = std::make_shared<port_snapshot>();
+  snap->inputs = impl_->get_input_ports();
+  snap->outputs = impl_->get_output_ports();
+  return snap;
 }
 }
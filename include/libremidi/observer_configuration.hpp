@@ -1,15 +1,22 @@
 #pragma once
 #include <libremidi/config.hpp>
 #include <libremidi/error.hpp>
+#include <libremidi/thread_policy.hpp>
 
+#include <chrono>
 #include <compare>
 #include <string>
+#include <vector>
 
 namespace libremidi
 {
 using client_handle = std::uint64_t;
 using port_handle = std::uint64_t;
 
+//! Dense identifier of a port, allocated by an observer.
+//! Cheap to copy, hash and compare, unlike port_information.
+using port_id = std::uint32_t;
+
 struct LIBREMIDI_EXPORT port_information
 {
   // Handle to the client object:
@@ -54,8 +61,36 @@ struct output_port : port_information
   std::strong_ordering operator<=>(const output_port& other) const noexcept = default;
 };
 
+//! Immutable list of the ports known to an observer at a given time.
+//! See observer::snapshot().
+struct port_snapshot
+{
+  //! Incremented each time a port appears or disappears
+  uint64_t generation{};
+
+  std::vector<input_port> inputs;
+  std::vector<output_port> outputs;
+};
+
+//! Ports which appeared and disappeared during a settle window.
+//! See observer_configuration::on_changes.
+struct port_changes
+{
+  std::vector<input_port> inputs_added;
+  std::vector<input_port> inputs_removed;
+  std::vector<output_port> outputs_added;
+  std::vector<output_port> outputs_removed;
+
+  bool empty() const noexcept
+  {
+    return inputs_added.empty() && inputs_removed.empty() && outputs_added.empty()
+           && outputs_removed.empty();
+  }
+};
+
 using input_port_callback = std::function<void(const input_port&)>;
 using output_port_callback = std::function<void(const output_port&)>;
+using port_changes_callback = std::function<void(const port_changes&)>;
 struct observer_configuration
 {
   midi_error_callback on_error{};
@@ -66,6 +101,13 @@ struct observer_configuration
   output_port_callback output_added;
   output_port_callback output_removed;
 
+  //! Coalesced hotplug notifications: the changes are collected until no port
+  //! appeared or disappeared for settle_window, and then delivered at once,
+  //! from a thread of the observer. A port added and removed in the same window
+  //! is not reported. The individual callbacks above are still called immediately.
+  port_changes_callback on_changes{};
+  std::chrono::milliseconds settle_window{100};
+
   // Observe hardware ports
   uint32_t track_hardware : 1 = true;
 
@@ -78,9 +120,17 @@ struct observer_configuration
   // Notify of the existing ports in the observer constructor
   uint32_t notify_in_constructor : 1 = true;
 
+  // Keep the list of ports in memory, updated by the hotplug notifications,
+  // so that get_input_ports / get_output_ports / snapshot do not query the system.
+  // Only useful with back-ends which support hotplug.
+  uint32_t cache_ports : 1 = false;
+
+  //! Scheduling of the observation thread, for the back-ends which start one
+  thread_policy threading{};
+
   bool has_callbacks() const noexcept
   {
-    return input_added || input_removed || output_added || output_removed;
+    return input_added || input_removed || output_added || output_removed || on_changes;
   }
 };
 }
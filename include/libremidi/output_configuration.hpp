@@ -19,5 +19,8 @@ struct output_configuration
 
   //! Timestamp mode for the timestamps passed to schedule_message
   uint32_t timestamps : 3 = timestamp_mode::Absolute;
+
+  //! Scheduling of the output thread, for the back-ends which start one (PipeWire)
+  thread_policy threading{};
 };
 }
@@ -26,10 +26,15 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #if !defined(LIBREMIDI_HEADER_ONLY)
   #include <libremidi/reader.hpp>
 #endif
+#include <libremidi/detail/mapped_file.hpp>
+#include <libremidi/detail/parallel_for.hpp>
 #include <libremidi/message.hpp>
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
+#include <new>
+#include <thread>
 
 // File Parsing Validation Todo:
 // ==============================
@@ -61,63 +66,54 @@ namespace util
 {
 struct no_validator
 {
-  static inline bool validate_track([[maybe_unused]] const midi_track& track) { return true; }
+  template <typename Track>
+  static inline parse_error validate_track([[maybe_unused]] const Track& track) noexcept
+  {
+    return parse_error::none;
+  }
 };
 
+// Works with midi_track and reader_view::track_view
 struct validator
 {
-  static inline bool validate_track(const midi_track& track)
+  template <typename Track>
+  static inline parse_error validate_track(const Track& track) noexcept
   {
     if (track.empty())
-    {
-#if defined(__LIBREMIDI_DEBUG__)
-      std::cerr << "empty track" << std::endl;
-#endif
-      return false;
-    }
+      return parse_error::empty_track;
 
     // Ensure that there is a unique EOT at the end of the track
-    auto it = std::find_if(track.begin(), track.end(), [](const libremidi::track_event& msg) {
-      static const auto eot = meta_events::end_of_track();
-      return msg.m.bytes == eot.bytes;
+    auto it = std::find_if(track.begin(), track.end(), [](const auto& msg) {
+      const auto& b = msg.m.bytes;
+      return b.size() == 3 && b[0] == 0xFF && b[1] == 0x2F && b[2] == 0x00;
     });
 
     if (it == track.end())
-    {
-#if defined(__LIBREMIDI_DEBUG__)
-      std::cerr << "track has no END OF TRACK" << std::endl;
-#endif
-      return false;
-    }
+      return parse_error::missing_end_of_track;
 
-    if (&it->m != &track.back().m)
-    {
-#if defined(__LIBREMIDI_DEBUG__)
-      std::cerr << std::distance(it, track.end());
-      std::cerr << "track does not end with END OF TRACK" << std::endl;
-#endif
-      return false;
-    }
+    if (std::next(it) != track.end())
+      return parse_error::events_after_end_of_track;
 
-    return true;
+    return parse_error::none;
   }
 };
 
 // Used when we know that we have enough space
 struct read_unchecked
 {
-  // Read a MIDI-style variable-length integer (big-endian value in groups of 7 bits,
-  // with top bit set to signify that another byte follows).
-  static inline void ensure_size(
+  static inline bool ensure_size(
       [[maybe_unused]] const uint8_t* begin, [[maybe_unused]] const uint8_t* end,
-      [[maybe_unused]] int64_t needed)
+      [[maybe_unused]] std::size_t needed) noexcept
   {
+    return true;
   }
 
-  static inline uint32_t
-  read_variable_length(uint8_t const*& data, [[maybe_unused]] uint8_t const* end)
+  // Read a MIDI-style variable-length integer (big-endian value in groups of 7 bits,
+  // with top bit set to signify that another byte follows).
+  static inline bool read_variable_length(
+      uint8_t const*& data, [[maybe_unused]] uint8_t const* end, std::size_t& result) noexcept
   {
-    uint32_t result = 0;
+    result = 0;
     while (true)
     {
       uint8_t b = *data++;
@@ -128,34 +124,22 @@ struct read_unchecked
       }
       else
       {
-        return result + b; // b is the last byte
+        result += b; // b is the last byte
+        return true;
       }
     }
   }
 
-  static inline void read_bytes(
-      midi_bytes& buffer, uint8_t const*& data, [[maybe_unused]] const uint8_t* end,
-      const std::size_t num)
-  {
-    buffer.reserve(buffer.size() + num);
-    for (std::size_t i = 0; i < num; ++i)
-      buffer.push_back(*data++);
-  }
-
-  static inline void read_bytes(
-      midi_bytes& buffer, uint8_t const*& data, [[maybe_unused]] const uint8_t* end, const int num)
-  {
-    read_bytes(buffer, data, end, static_cast<std::size_t>(num));
-  }
-
-  static inline uint16_t read_uint16_be(uint8_t const*& data, [[maybe_unused]] const uint8_t* end)
+  static inline uint16_t
+  read_uint16_be(uint8_t const*& data, [[maybe_unused]] const uint8_t* end) noexcept
   {
     uint16_t result = *data++ << 8u;
     result += *data++;
     return result;
   }
 
-  static inline uint32_t read_uint24_be(uint8_t const*& data, [[maybe_unused]] const uint8_t* end)
+  static inline uint32_t
+  read_uint24_be(uint8_t const*& data, [[maybe_unused]] const uint8_t* end) noexcept
   {
     uint32_t result = *data++ << 16u;
     result += static_cast<uint32_t>(*data++ << 8u);
@@ -163,7 +147,8 @@ struct read_unchecked
     return result;
   }
 
-  static inline uint32_t read_uint32_be(uint8_t const*& data, [[maybe_unused]] const uint8_t* end)
+  static inline uint32_t
+  read_uint32_be(uint8_t const*& data, [[maybe_unused]] const uint8_t* end) noexcept
   {
     uint32_t result = *data++ << 24u;
     result += static_cast<uint32_t>(*data++ << 16u);
@@ -173,24 +158,27 @@ struct read_unchecked
   }
 };
 
-// Used when we do not know if we have enough bytes and have to check before reading
+// Used when we do not know if we have enough bytes and have to check before reading.
+// Reports a lack of data through its return value: the fixed-size reads
+// are only done after ensure_size.
 struct read_checked
 {
-  // Read a MIDI-style variable-length integer (big-endian value in groups of 7 bits,
-  // with top bit set to signify that another byte follows).
-  static inline void
-  ensure_size(const uint8_t* begin, const uint8_t* end, const std::size_t needed)
+  static inline bool
+  ensure_size(const uint8_t* begin, const uint8_t* end, const std::size_t needed) noexcept
   {
-    if (const auto available = static_cast<std::size_t>(end - begin); available < needed)
-      throw std::runtime_error("MIDI reader: not enough data to process");
+    return static_cast<std::size_t>(end - begin) >= needed;
   }
 
-  static inline std::size_t read_variable_length(uint8_t const*& data, uint8_t const* end)
+  // Read a MIDI-style variable-length integer (big-endian value in groups of 7 bits,
+  // with top bit set to signify that another byte follows).
+  static inline bool
+  read_variable_length(uint8_t const*& data, uint8_t const* end, std::size_t& result) noexcept
   {
-    std::size_t result = 0;
+    result = 0;
     while (true)
     {
-      ensure_size(data, end, 1);
+      if (data == end)
+        return false;
       uint8_t b = *data++;
       if (b & 0x80)
       {
@@ -199,33 +187,24 @@ struct read_checked
       }
       else
       {
-        return result + b; // b is the last byte
+        result += b; // b is the last byte
+        return true;
       }
     }
   }
 
-  static inline void
-  read_bytes(midi_bytes& buffer, uint8_t const*& data, uint8_t const* end, const std::size_t num)
-  {
-    ensure_size(data, end, num);
-    read_unchecked::read_bytes(buffer, data, end, num);
-  }
-
-  static inline uint16_t read_uint16_be(uint8_t const*& data, uint8_t const* end)
+  static inline uint16_t read_uint16_be(uint8_t const*& data, uint8_t const* end) noexcept
   {
-    ensure_size(data, end, 2);
     return read_unchecked::read_uint16_be(data, end);
   }
 
-  static inline uint32_t read_uint24_be(uint8_t const*& data, uint8_t const* end)
+  static inline uint32_t read_uint24_be(uint8_t const*& data, uint8_t const* end) noexcept
   {
-    ensure_size(data, end, 3);
     return read_unchecked::read_uint24_be(data, end);
   }
 
-  static inline uint32_t read_uint32_be(uint8_t const*& data, uint8_t const* end)
+  static inline uint32_t read_uint32_be(uint8_t const*& data, uint8_t const* end) noexcept
   {
-    ensure_size(data, end, 4);
     return read_unchecked::read_uint32_be(data, end);
   }
 };
@@ -243,36 +222,56 @@ using validator = util::no_validator;
 using validator = util::validator;
 #endif
 
+// An event as laid out in the file: an optional byte which is not stored with the
+// rest of the message (the status byte of running status events, or the F0 of sysex,
+// whose length is stored in between), followed by contiguous bytes of the file.
+struct raw_event
+{
+  const uint8_t* data{};
+  std::size_t size{};
+  uint8_t head{};
+  bool has_head{};
+
+  std::size_t total_size() const noexcept { return has_head + size; }
+  uint8_t front() const noexcept { return has_head ? head : data[0]; }
+};
+
+// Decoding shared by reader, reader_view and stream_reader: validates the event
+// and finds its bytes. On error, dataStart is left somewhere inside the event.
 LIBREMIDI_INLINE
-track_event parse_event(
-    int tick, int track, const uint8_t*& dataStart, const uint8_t* dataEnd,
-    message_type lastEventTypeByte)
+parse_error decode_event(
+    const uint8_t*& dataStart, const uint8_t* dataEnd, message_type lastEventTypeByte,
+    raw_event& event) noexcept
 {
-  byte_reader::ensure_size(dataStart, dataEnd, 1);
+  if (!byte_reader::ensure_size(dataStart, dataEnd, 1))
+    return parse_error::truncated_event;
+  const uint8_t* const eventStart = dataStart;
   auto type = static_cast<message_type>(*dataStart++);
 
-  track_event event{tick, track, message{}};
+  const auto skip = [&](std::size_t length) {
+    if (!byte_reader::ensure_size(dataStart, dataEnd, length))
+      return false;
+    dataStart += length;
+    return true;
+  };
 
   if ((static_cast<uint8_t>(type) & 0xF0) == 0xF0)
   {
     // Meta event
     if (static_cast<uint8_t>(type) == 0xFF)
     {
-      byte_reader::ensure_size(dataStart, dataEnd, 1);
+      if (!byte_reader::ensure_size(dataStart, dataEnd, 1))
+        return parse_error::truncated_event;
       auto subtype = static_cast<meta_event_type>(*dataStart++);
 
-      event.m.bytes.reserve(3);
-      event.m.bytes.push_back(static_cast<uint8_t>(type));
-      event.m.bytes.push_back(static_cast<uint8_t>(subtype));
-
+      // Here we read the meta-event length manually, as this way it is also part of the
+      // message bytes
       uint32_t length = 0;
-      // Here we read the meta-event length manually, as this way we can also put it into
-      // event.m.bytes
       while (true)
       {
-        byte_reader::ensure_size(dataStart, dataEnd, 1);
+        if (!byte_reader::ensure_size(dataStart, dataEnd, 1))
+          return parse_error::truncated_event;
         uint8_t b = *dataStart++;
-        event.m.bytes.push_back(b);
         if (b & 0x80)
         {
           const uint8_t byte = (b & 0x7F);
@@ -287,56 +286,37 @@ track_event parse_event(
         }
       }
 
+      const uint8_t* const payload = dataStart;
+      if (!skip(length))
+        return parse_error::truncated_event;
+
+      event = raw_event{.data = eventStart, .size = std::size_t(dataStart - eventStart)};
+
       switch (subtype)
       {
-        case meta_event_type::SEQUENCE_NUMBER: {
-          switch (length)
-          {
-            case 0:
-              return event;
-            case 2:
-              byte_reader::read_bytes(event.m.bytes, dataStart, dataEnd, 2);
-              return event;
-            default:
-              throw std::invalid_argument("Expected length for SEQUENCE_NUMBER event is 0 or 2");
-          }
-        }
-        case meta_event_type::TEXT:
-        case meta_event_type::COPYRIGHT:
-        case meta_event_type::TRACK_NAME:
-        case meta_event_type::INSTRUMENT:
-        case meta_event_type::LYRIC:
-        case meta_event_type::MARKER:
-        case meta_event_type::CUE:
-        case meta_event_type::PATCH_NAME:
-        case meta_event_type::DEVICE_NAME: {
-          byte_reader::read_bytes(event.m.bytes, dataStart, dataEnd, length);
-          return event;
-        }
+        case meta_event_type::SEQUENCE_NUMBER:
+          // Expected length for SEQUENCE_NUMBER event is 0 or 2
+          if (length != 0 && length != 2)
+            return parse_error::invalid_meta_event;
+          return parse_error::none;
 
-        case meta_event_type::END_OF_TRACK: {
+        case meta_event_type::END_OF_TRACK:
           if (length != 0)
-            throw std::invalid_argument("Expected length for END_OF_TRACK event is 0");
-          return event;
-        }
-        case meta_event_type::TEMPO_CHANGE: {
+            return parse_error::invalid_meta_event;
+          return parse_error::none;
+
+        case meta_event_type::TEMPO_CHANGE:
           if (length != 3)
-            throw std::invalid_argument("Expected length for TEMPO_CHANGE event is 3");
-          // event.m.bytes[3] = read_uint24_be(dataStart); // @dimitri TOFIX
-          byte_reader::read_bytes(event.m.bytes, dataStart, dataEnd, length);
-          return event;
-        }
+            return parse_error::invalid_meta_event;
+          return parse_error::none;
+
         case meta_event_type::SMPTE_OFFSET: {
           if (length != 5)
-            throw std::invalid_argument("Expected length for SMPTE_OFFSET event is 5");
-          byte_reader::read_bytes(event.m.bytes, dataStart, dataEnd, length);
-          auto& b = event.m.bytes;
-
-          uint8_t format = (b[3] & 0b01100000) >> 5;
-          uint8_t h = (b[3] & 0b00011111);
+            return parse_error::invalid_meta_event;
+          const uint8_t* b = payload;
 
-          if (format > 3)
-            throw std::invalid_argument("SMPTE_OFFSET has unknown format");
+          uint8_t format = (b[0] & 0b01100000) >> 5;
+          uint8_t h = (b[0] & 0b00011111);
 
           int max = 0;
           switch (format)
@@ -357,354 +337,493 @@ track_event parse_event(
               break;
           }
 
-          if (h >= 24 || b[4] >= 60 || b[5] >= 60 || b[6] >= max || b[7] >= 100)
-            throw std::invalid_argument("SMPTE_OFFSET is out-of-23:59:59:xx:99 bounds");
-          return event;
+          // Out of 23:59:59:xx:99 bounds
+          if (h >= 24 || b[1] >= 60 || b[2] >= 60 || b[3] >= max || b[4] >= 100)
+            return parse_error::invalid_meta_event;
+          return parse_error::none;
         }
-        case meta_event_type::TIME_SIGNATURE: {
+
+        case meta_event_type::TIME_SIGNATURE:
           if (length != 4)
-            throw std::invalid_argument("Expected length for TIME_SIGNATURE event is 4");
-          byte_reader::read_bytes(event.m.bytes, dataStart, dataEnd, length);
-          return event;
-        }
+            return parse_error::invalid_meta_event;
+          return parse_error::none;
+
         case meta_event_type::KEY_SIGNATURE: {
           if (length != 2)
-            throw std::invalid_argument("Expected length for KEY_SIGNATURE event is 2");
-          byte_reader::read_bytes(event.m.bytes, dataStart, dataEnd, length);
-          auto k = static_cast<int8_t>(event.m[3]);
+            return parse_error::invalid_meta_event;
+          auto k = static_cast<int8_t>(payload[0]);
           if (k < -7 || k > 7)
-            throw std::invalid_argument("Invalid KEY_SIGNATURE");
-          if (event.m[4] > 1)
-            throw std::invalid_argument("Invalid KEY_SIGNATURE");
-          return event;
-        }
-        case meta_event_type::PROPRIETARY: {
-          byte_reader::read_bytes(event.m.bytes, dataStart, dataEnd, length);
-          return event;
+            return parse_error::invalid_meta_event;
+          if (payload[1] > 1)
+            return parse_error::invalid_meta_event;
+          return parse_error::none;
         }
-        case meta_event_type::CHANNEL_PREFIX: {
-          if (length != 1)
-            throw std::invalid_argument("Expected length for CHANNEL_PREFIX event is 1");
-          byte_reader::read_bytes(event.m.bytes, dataStart, dataEnd, length);
-          return event;
-        }
-        case meta_event_type::MIDI_PORT: {
+
+        case meta_event_type::CHANNEL_PREFIX:
+        case meta_event_type::MIDI_PORT:
           if (length != 1)
-            throw std::invalid_argument("Expected length for MIDI_PORT event is 1");
-          byte_reader::read_bytes(event.m.bytes, dataStart, dataEnd, length);
-          return event;
-        }
+            return parse_error::invalid_meta_event;
+          return parse_error::none;
+
+        case meta_event_type::TEXT:
+        case meta_event_type::COPYRIGHT:
+        case meta_event_type::TRACK_NAME:
+        case meta_event_type::INSTRUMENT:
+        case meta_event_type::LYRIC:
+        case meta_event_type::MARKER:
+        case meta_event_type::CUE:
+        case meta_event_type::PATCH_NAME:
+        case meta_event_type::DEVICE_NAME:
+        case meta_event_type::PROPRIETARY:
         case meta_event_type::UNKNOWN:
-        default: {
-          // Unknown events?
-          byte_reader::read_bytes(event.m.bytes, dataStart, dataEnd, length);
-          return event;
-        }
+        default:
+          return parse_error::none;
       }
     }
 
-    else if (type == message_type::SYSTEM_EXCLUSIVE)
-    {
-      const auto length = byte_reader::read_variable_length(dataStart, dataEnd);
-      event.m.bytes = {static_cast<uint8_t>(type)};
-      byte_reader::read_bytes(event.m.bytes, dataStart, dataEnd, length);
-      return event;
-    }
-
-    else if (type == message_type::EOX)
+    else if (type == message_type::SYSTEM_EXCLUSIVE || type == message_type::EOX)
     {
-      const auto length = byte_reader::read_variable_length(dataStart, dataEnd);
-      byte_reader::read_bytes(event.m.bytes, dataStart, dataEnd, length);
-      return event;
+      std::size_t length = 0;
+      if (!byte_reader::read_variable_length(dataStart, dataEnd, length))
+        return parse_error::truncated_event;
+      const uint8_t* const payload = dataStart;
+      if (!skip(length))
+        return parse_error::truncated_event;
+
+      // F0 <length> <bytes>: the F0 is part of the message.
+      // F7 <length> <bytes> is used to escape arbitrary bytes: only these are.
+      if (type == message_type::SYSTEM_EXCLUSIVE)
+        event = raw_event{
+            .data = payload,
+            .size = length,
+            .head = static_cast<uint8_t>(type),
+            .has_head = true};
+      else
+        event = raw_event{.data = payload, .size = length};
+      return parse_error::none;
     }
     else
     {
-      throw std::runtime_error("Unrecognised MIDI event type byte");
+      // Unrecognised MIDI event type byte
+      return parse_error::unsupported_event;
     }
   }
 
   // Channel events
   else
   {
-    event.m.bytes.clear();
+    uint8_t b[3]{};
 
     // Running status...
     if ((static_cast<uint8_t>(type) & 0x80) == 0)
     {
       // Reuse lastEventTypeByte as the event type.
       // eventTypeByte is actually the first parameter
-      event.m.bytes.push_back(static_cast<uint8_t>(lastEventTypeByte));
-      event.m.bytes.push_back(static_cast<uint8_t>(type));
+      event = {
+          .data = eventStart,
+          .size = 1,
+          .head = static_cast<uint8_t>(lastEventTypeByte),
+          .has_head = true};
+      b[0] = static_cast<uint8_t>(lastEventTypeByte);
+      b[1] = static_cast<uint8_t>(type);
       type = lastEventTypeByte;
     }
     else
     {
-      event.m.bytes.push_back(static_cast<uint8_t>(type));
-
-      byte_reader::ensure_size(dataStart, dataEnd, 1);
-      event.m.bytes.push_back(static_cast<uint8_t>(*dataStart++));
-      lastEventTypeByte = type;
+      if (!byte_reader::ensure_size(dataStart, dataEnd, 1))
+        return parse_error::truncated_event;
+      event = {.data = eventStart, .size = 2};
+      b[0] = static_cast<uint8_t>(type);
+      b[1] = *dataStart++;
     }
 
-    static constexpr auto validate = [](midi_bytes& b) {
-      if (b[1] < 128 && b[2] < 128)
-        return true;
-      throw std::invalid_argument("MIDI message has arguments > 127");
-    };
-
     switch (static_cast<message_type>(static_cast<uint8_t>(type) & 0xF0))
     {
       case message_type::NOTE_OFF:
       case message_type::NOTE_ON:
       case message_type::POLY_PRESSURE:
       case message_type::CONTROL_CHANGE:
-        byte_reader::ensure_size(dataStart, dataEnd, 1);
-        event.m.bytes.push_back(*dataStart++);
-        validate(event.m.bytes);
-        return event;
+      case message_type::PITCH_BEND:
+        if (!byte_reader::ensure_size(dataStart, dataEnd, 1))
+          return parse_error::truncated_event;
+        b[2] = *dataStart++;
+        event.size++;
+        if (b[1] >= 128 || b[2] >= 128)
+          return parse_error::invalid_data_byte;
+        return parse_error::none;
+
       case message_type::PROGRAM_CHANGE:
-        if (event.m.bytes[1] >= 128)
-          throw std::invalid_argument("MIDI PC has arguments > 127");
-        return event;
       case message_type::AFTERTOUCH:
-        if (event.m.bytes[1] >= 128)
-          throw std::invalid_argument("MIDI Atertouch has arguments > 127");
-        return event;
-      case message_type::PITCH_BEND:
-        byte_reader::ensure_size(dataStart, dataEnd, 1);
-        event.m.bytes.push_back(*dataStart++);
-        validate(event.m.bytes);
-        return event;
-
-      case message_type::TIME_CODE:
-        throw std::runtime_error("Unsupported MIDI event type TIME_CODE");
-      case message_type::SONG_POS_POINTER:
-        throw std::runtime_error("Unsupported MIDI event type SONG_POS_POINTER");
-      case message_type::SONG_SELECT:
-        throw std::runtime_error("Unsupported MIDI event type SONG_SELECT");
-      case message_type::RESERVED1:
-        throw std::runtime_error("Unsupported MIDI event type RESERVED1");
-      case message_type::RESERVED2:
-        throw std::runtime_error("Unsupported MIDI event type RESERVED2");
-      case message_type::TUNE_REQUEST:
-        throw std::runtime_error("Unsupported MIDI event type TUNE_REQUEST");
-      case message_type::EOX:
-        throw std::runtime_error("Unsupported MIDI event type EOX");
-        // System Realtime Messages :
-      case message_type::TIME_CLOCK:
-        throw std::runtime_error("Unsupported MIDI event type TIME_CLOCK");
-      case message_type::RESERVED3:
-        throw std::runtime_error("Unsupported MIDI event type RESERVED3");
-      case message_type::START:
-        throw std::runtime_error("Unsupported MIDI event type START");
-      case message_type::CONTINUE:
-        throw std::runtime_error("Unsupported MIDI event type CONTINUE");
-      case message_type::STOP:
-        throw std::runtime_error("Unsupported MIDI event type STOP");
-      case message_type::RESERVED4:
-        throw std::runtime_error("Unsupported MIDI event type RESERVED4");
-      case message_type::ACTIVE_SENSING:
-        throw std::runtime_error("Unsupported MIDI event type ACTIVE_SENSING");
-      case message_type::SYSTEM_RESET:
-        throw std::runtime_error("Unsupported MIDI event type SYSTEM_RESET");
-      case message_type::INVALID:
-        throw std::runtime_error("Unsupported MIDI event type INVALID");
-      case message_type::SYSTEM_EXCLUSIVE:
-        throw std::runtime_error("Unsupported MIDI event type SYSTEM_EXCLUSIVE");
+        if (b[1] >= 128)
+          return parse_error::invalid_data_byte;
+        return parse_error::none;
+
       default:
-        throw std::runtime_error("Unsupported MIDI event type");
+        // System common and realtime messages cannot be used in files,
+        // and running status cannot be used before a channel message.
+        return parse_error::unsupported_event;
     }
   }
 }
 
-LIBREMIDI_INLINE
-reader::reader(bool useAbsolute)
-    : ticksPerBeat(480)
-    , startingTempo(120)
-    , useAbsoluteTicks(useAbsolute)
+constexpr int str_to_headerid(const char* str)
 {
+  return str[0] << 24 | str[1] << 16 | str[2] << 8 | str[3];
 }
 
-LIBREMIDI_INLINE
-reader::~reader() { }
+enum class track_status
+{
+  complete,   // All the events could be decoded
+  incomplete, // An event could not be decoded, the rest of the chunk was skipped
+  invalid     // A delta-time could not be read: the whole file is invalid
+};
 
-constexpr int str_to_headerid(const char* str)
+struct track_chunk
 {
-  return str[0] << 24 | str[1] << 16 | str[2] << 8 | str[3];
+  const uint8_t* data{};
+  uint32_t length{};
+};
+
+struct track_result
+{
+  track_status status{};
+  parse_diagnostic diagnostic{};
+
+  // Collected while parsing, for the tempo map
+  std::vector<tempo_change> tempo;
+  int64_t end_tick{};
+};
+
+// FF 51 03 tt tt tt
+inline bool is_tempo_change(const raw_event& ev) noexcept
+{
+  return !ev.has_head && ev.size == 6 && ev.data[0] == 0xFF
+         && ev.data[1] == uint8_t(meta_event_type::TEMPO_CHANGE) && ev.data[2] == 3;
 }
 
-LIBREMIDI_INLINE
-auto reader::parse(const uint8_t* dataPtr, std::size_t size) noexcept -> parse_result
-try
+// Decodes the events of a MTrk chunk. Only touches the state of this track in
+// the handler, so that tracks can be parsed concurrently.
+template <typename Handler>
+track_result parse_track(
+    const uint8_t* base, const track_chunk& chunk, int i, bool useAbsoluteTicks,
+    Handler& handler) noexcept
 {
   using namespace libremidi::util;
 
-  tracks.clear();
+  track_result res;
+  int64_t absoluteTick = 0;
 
-  if (size == 0)
-  {
+  const auto failure = [&](track_status status, const uint8_t* where, parse_error err) {
 #if defined(__LIBREMIDI_DEBUG__)
-    std::cerr << "empty buffer passed to parse." << std::endl;
+    std::cerr << "track " << i << ": error " << int(err) << " at " << (where - base) << std::endl;
 #endif
-    return parse_result::invalid;
+    res.status = status;
+    res.diagnostic = {std::size_t(where - base), i, err};
+    res.end_tick = absoluteTick;
+    return std::move(res);
+  };
+
+#if defined(__cpp_exceptions)
+  try
+#endif
+  {
+    handler.begin_track(i, chunk.length);
+
+    const uint8_t* dataPtr = chunk.data;
+    const uint8_t* const trackEnd = dataPtr + chunk.length;
+
+    auto runningEvent = message_type::INVALID;
+
+    std::size_t tickCount = 0;
+
+    while (dataPtr < trackEnd)
+    {
+      std::size_t tick = 0;
+      if (!read_checked::read_variable_length(dataPtr, trackEnd, tick))
+        return failure(track_status::invalid, dataPtr, parse_error::truncated_event);
+
+      absoluteTick += tick;
+      if (useAbsoluteTicks)
+      {
+        tickCount += tick;
+      }
+      else
+      {
+        tickCount = tick;
+      }
+
+      // In case of error the rest of the track is skipped
+      const uint8_t* const eventStart = dataPtr;
+      raw_event ev;
+      if (auto err = decode_event(dataPtr, trackEnd, runningEvent, ev); err != parse_error::none)
+        return failure(track_status::incomplete, eventStart, err);
+
+      if (ev.total_size() == 0)
+        return failure(track_status::incomplete, eventStart, parse_error::empty_event);
+
+      if (ev.front() != 0xFF)
+      {
+        runningEvent = static_cast<message_type>(ev.front());
+      }
+
+      if (is_tempo_change(ev))
+      {
+        const auto* b = ev.data + 3;
+        res.tempo.push_back(
+            {absoluteTick, uint32_t(b[0]) << 16 | uint32_t(b[1]) << 8 | uint32_t(b[2])});
+      }
+
+      handler.on_event(i, static_cast<int>(tickCount), ev);
+    }
+    res.end_tick = absoluteTick;
+    return res;
   }
+#if defined(__cpp_exceptions)
+  catch (const std::bad_alloc&)
+  {
+    return failure(track_status::invalid, chunk.data, parse_error::out_of_memory);
+  }
+#endif
+}
 
-  const uint8_t* const dataEnd = dataPtr + size;
+// Parses the chunks, either in the calling thread or on up to `threads` threads.
+// Each thread takes the next chunk which has not been parsed yet.
+template <typename Handler>
+void parse_tracks(
+    const uint8_t* base, std::span<const track_chunk> chunks, std::span<track_result> results,
+    bool useAbsoluteTicks, int threads, Handler& handler)
+{
+  if (threads <= 1 || chunks.size() <= 1)
+  {
+    for (std::size_t i = 0; i < chunks.size(); ++i)
+    {
+      results[i] = parse_track(base, chunks[i], int(i), useAbsoluteTicks, handler);
+      // Later tracks would be discarded anyways
+      if (results[i].status == track_status::invalid)
+        break;
+    }
+    return;
+  }
+
+  detail::parallel_for(chunks.size(), threads, [&](std::size_t i, int) noexcept {
+    results[i] = parse_track(base, chunks[i], int(i), useAbsoluteTicks, handler);
+  });
+}
+
+// Reads the MThd chunk.
+// The handler receives on_format(int) and on_time_division(uint16_t).
+template <typename Handler>
+parse_error read_smf_header(
+    const uint8_t*& dataPtr, const uint8_t* dataEnd, int& trackCount, Handler& handler) noexcept
+{
+  using namespace libremidi::util;
+
+  if (dataPtr == dataEnd)
+    return parse_error::empty_buffer;
+
+  if (!read_checked::ensure_size(dataPtr, dataEnd, 14))
+    return parse_error::invalid_header;
 
   uint32_t headerId = read_checked::read_uint32_be(dataPtr, dataEnd);
   uint32_t headerLength = read_checked::read_uint32_be(dataPtr, dataEnd);
 
   if (static_cast<int>(headerId) != str_to_headerid("MThd") || headerLength != 6)
-  {
-#if defined(__LIBREMIDI_DEBUG__)
-    std::cerr << "couldn't parse header" << std::endl;
-#endif
-    return parse_result::invalid;
-  }
+    return parse_error::invalid_header;
 
-  format = read_checked::read_uint16_be(
+  const int format = read_checked::read_uint16_be(
       dataPtr, dataEnd); //@tofix format type -> save for later eventually
+  handler.on_format(format);
   if (format > 2)
-  {
-#if defined(__LIBREMIDI_DEBUG__)
-    std::cerr << "unknown format" << std::endl;
-#endif
-    return parse_result::invalid;
-  }
-  int trackCount = read_checked::read_uint16_be(dataPtr, dataEnd);
+    return parse_error::unsupported_format;
+
+  trackCount = read_checked::read_uint16_be(dataPtr, dataEnd);
   uint16_t timeDivision = read_checked::read_uint16_be(dataPtr, dataEnd);
 
   // CBB: deal with the SMPTE style time coding
   // timeDivision is described here http://www.sonicspot.com/guide/midifiles.html
+  // given beats per second, timeDivision should be derivable.
   if (timeDivision & 0x8000)
-  {
-#if defined(__LIBREMIDI_DEBUG__)
-    std::cerr << "found SMPTE time frames (unsupported)" << std::endl;
-    int fps = (timeDivision >> 16) & 0x7f;
-    if (fps != -30 && fps != -29 && fps != -25 && fps != -24)
-      return parse_result::invalid;
-    int ticksPerFrame = timeDivision & 0xff;
-#endif
-    // given beats per second, timeDivision should be derivable.
-    return parse_result::invalid;
-  }
+    return parse_error::unsupported_time_division;
 
-  startingTempo = 120.0f;             // midi default
-  ticksPerBeat = float(timeDivision); // ticks per beat (a beat is defined as a quarter note)
+  handler.on_time_division(timeDivision);
+  return parse_error::none;
+}
 
-  parse_result result = parse_result::validated;
+// Locates the track chunks. If a chunk is missing or truncated, the chunks before it
+// are still returned: the result tells how the file has to be reported once they
+// have been processed. dataPtr is left after the last chunk found.
+LIBREMIDI_INLINE
+reader::parse_result locate_track_chunks(
+    const uint8_t* base, const uint8_t*& dataPtr, const uint8_t* dataEnd, int trackCount,
+    std::vector<track_chunk>& chunks, parse_diagnostic& diagnostic)
+{
+  using namespace libremidi::util;
+  using parse_result = reader::parse_result;
 
+  chunks.clear();
+  chunks.reserve(trackCount);
   for (int i = 0; i < trackCount; ++i)
   {
-    midi_track track;
+    diagnostic = {std::size_t(dataPtr - base), i, parse_error::none};
+    if (!read_checked::ensure_size(dataPtr, dataEnd, 8))
+    {
+      diagnostic.error = parse_error::truncated_track_header;
+      return parse_result::invalid;
+    }
 
-    headerId = read_checked::read_uint32_be(dataPtr, dataEnd);
-    headerLength = read_checked::read_uint32_be(dataPtr, dataEnd);
+    const uint32_t headerId = read_checked::read_uint32_be(dataPtr, dataEnd);
+    const uint32_t headerLength = read_checked::read_uint32_be(dataPtr, dataEnd);
 
     if (headerId != str_to_headerid("MTrk"))
     {
-#if defined(__LIBREMIDI_DEBUG__)
-      std::cerr << "couldn't find track header" << std::endl;
-#endif
+      diagnostic.error = parse_error::missing_track_header;
       return parse_result::incomplete;
     }
 
-    int64_t available = dataEnd - dataPtr;
-    if (available < headerLength)
+    if (!read_checked::ensure_size(dataPtr, dataEnd, headerLength))
     {
-#if defined(__LIBREMIDI_DEBUG__)
-      std::cerr << "not enough data available" << std::endl;
-#endif
+      diagnostic.error = parse_error::truncated_track;
       return parse_result::incomplete;
     }
 
-    track.reserve(headerLength / 3);
+    chunks.push_back({dataPtr, headerLength});
+    dataPtr += headerLength;
+  }
+  diagnostic = {};
+  return parse_result::validated;
+}
 
-    const uint8_t* const trackEnd = dataPtr + headerLength;
+// Parsing of the header and of the track chunks, shared by reader and reader_view.
+// The chunks are located first, then parsed, possibly concurrently. The results are
+// then processed in order, so that they do not depend on the number of threads.
+// The handler receives the decoded events and stores them the way it wants:
+//  - on_format(int), on_time_division(uint16_t)
+//  - begin(int track_count): called once the chunks are located
+//  - begin_track(int track, uint32_t chunk_length), on_event(int track, int tick, const
+//  raw_event&): called from the thread which parses the track
+//  - end_track(int track, bool validate): called in order, returns why the track
+//  does not follow the SMF rules if it was validated.
+//  - on_timing(tempo_map&&, int64_t end_tick): the tempo changes of the tracks which are kept
+//  - finish(int track_count): the number of tracks to keep
+//  - on_diagnostic(const parse_diagnostic&): called in file order
+template <typename Handler>
+auto parse_smf(
+    const uint8_t* dataPtr, std::size_t size, bool useAbsoluteTicks, int threads,
+    Handler& handler) noexcept -> reader::parse_result
+{
+  using parse_result = reader::parse_result;
 
-    auto runningEvent = message_type::INVALID;
+  const uint8_t* const base = dataPtr;
+  const uint8_t* const dataEnd = dataPtr + size;
+  int ticksPerQuarter = 0;
+
+  // The tempo changes of all the tracks which are kept
+  const auto make_tempo_map = [&](std::span<track_result> results, int count) {
+    std::vector<tempo_change> changes;
+    for (int i = 0; i < count; i++)
+      changes.insert(changes.end(), results[i].tempo.begin(), results[i].tempo.end());
+    return tempo_map{ticksPerQuarter, std::move(changes)};
+  };
+  const auto end_tick = [](std::span<track_result> results, int count) {
+    int64_t end = 0;
+    for (int i = 0; i < count; i++)
+      end = std::max(end, results[i].end_tick);
+    return end;
+  };
+
+#if defined(__cpp_exceptions)
+  try
+#endif
+  {
+    int trackCount = 0;
+    if (auto err = read_smf_header(dataPtr, dataEnd, trackCount, handler);
+        err != parse_error::none)
+    {
+      handler.on_diagnostic({0, -1, err});
+      return parse_result::invalid;
+    }
 
-    std::size_t tickCount = 0;
+    // Time division, as read by read_smf_header
+    const uint8_t* timeDivision = base + 12;
+    ticksPerQuarter = util::read_checked::read_uint16_be(timeDivision, dataEnd);
 
-    while (dataPtr < trackEnd)
+    std::vector<track_chunk> chunks;
+    std::vector<track_result> results;
+    parse_diagnostic chunks_diagnostic;
+    const auto chunks_result
+        = locate_track_chunks(base, dataPtr, dataEnd, trackCount, chunks, chunks_diagnostic);
+
+    const int chunkCount = static_cast<int>(chunks.size());
+    handler.begin(chunkCount);
+
+    results.resize(chunks.size());
+    parse_tracks<Handler>(base, chunks, results, useAbsoluteTicks, threads, handler);
+
+    parse_result result = parse_result::validated;
+    for (int i = 0; i < chunkCount; ++i)
     {
-      const auto tick = read_checked::read_variable_length(dataPtr, trackEnd);
-      if (useAbsoluteTicks)
-      {
-        tickCount += tick;
-      }
-      else
-      {
-        tickCount = tick;
-      }
+      if (results[i].status != track_status::complete)
+        handler.on_diagnostic(results[i].diagnostic);
 
-      try
+      if (results[i].status == track_status::invalid)
       {
-        track_event ev
-            = parse_event(static_cast<int>(tickCount), i, dataPtr, trackEnd, runningEvent);
-        if (!ev.m.empty())
-        {
-          if (!ev.m.is_meta_event())
-          {
-            runningEvent = static_cast<message_type>(ev.m.bytes[0]);
-          }
-        }
-        else
-        {
-#if defined(__LIBREMIDI_DEBUG__)
-          std::cerr << "could not read event" << std::endl;
-#endif
-          dataPtr = trackEnd;
-          result = parse_result::incomplete;
-          continue;
-        }
-
-        track.push_back(std::move(ev));
+        handler.on_timing(make_tempo_map(results, i), end_tick(results, i));
+        handler.finish(i);
+        return parse_result::invalid;
       }
-      catch (const std::exception& e)
+      if (results[i].status == track_status::incomplete)
       {
-#if defined(__LIBREMIDI_DEBUG__)
-        std::cerr << "" << e.what() << std::endl;
-#endif
-        dataPtr = trackEnd;
         result = parse_result::incomplete;
-        continue;
       }
-    }
 
-    if (result == parse_result::validated)
-    {
-      if (!validator::validate_track(track))
+      if (auto err = handler.end_track(i, result == parse_result::validated);
+          err != parse_error::none)
       {
+        handler.on_diagnostic({std::size_t(chunks[i].data - base - 8), i, err});
         result = parse_result::complete;
       }
     }
-    tracks.push_back(std::move(track));
-  }
+    handler.on_timing(make_tempo_map(results, chunkCount), end_tick(results, chunkCount));
+    handler.finish(chunkCount);
+
+    if (chunks_result != parse_result::validated)
+    {
+      handler.on_diagnostic(chunks_diagnostic);
+      return chunks_result;
+    }
 
-  if (result == parse_result::validated)
-  {
     if (dataPtr != dataEnd)
     {
-#if defined(__LIBREMIDI_DEBUG__)
-      std::cerr << "midifile has junk at end: " << std::intptr_t(dataEnd - dataPtr) << std::endl;
-#endif
-      result = parse_result::complete;
+      handler.on_diagnostic({std::size_t(dataPtr - base), -1, parse_error::junk_at_end});
+      if (result == parse_result::validated)
+        result = parse_result::complete;
     }
+    return result;
   }
-  return result;
+#if defined(__cpp_exceptions)
+  catch (const std::bad_alloc&)
+  {
+    handler.finish(0);
+    return parse_result::invalid;
+  }
+#endif
 }
-catch (const std::exception& e)
+
+// Number of threads to use for parsing a file
+inline int parse_thread_count(int requested, std::size_t size) noexcept
 {
-#if defined(__LIBREMIDI_DEBUG__)
-  std::cerr << "" << e.what() << std::endl;
-#endif
-  return parse_result::invalid;
+  if (requested > 0)
+    return requested;
+
+  // Automatic: not worth starting threads for small files
+  if (size < 256 * 1024)
+    return 1;
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
 }
 
 // In ticks
-LIBREMIDI_INLINE
-double reader::get_end_time() const noexcept
+template <typename Tracks>
+double end_time(const Tracks& tracks, bool useAbsoluteTicks) noexcept
 {
   if (useAbsoluteTicks)
   {
@@ -737,8 +856,90 @@ double reader::get_end_time() const noexcept
 }
 
 LIBREMIDI_INLINE
-auto reader::parse(const std::vector<uint8_t>& buffer) noexcept -> parse_result
-{
+reader::reader(bool useAbsolute)
+    : ticksPerBeat(480)
+    , startingTempo(120)
+    , useAbsoluteTicks(useAbsolute)
+{
+}
+
+LIBREMIDI_INLINE
+reader::~reader() { }
+
+// Builds one message per event
+struct reader_builder
+{
+  reader& self;
+
+  void on_format(int format) { self.format = format; }
+  void on_time_division(uint16_t timeDivision)
+  {
+    self.startingTempo = 120.0f;             // midi default
+    self.ticksPerBeat = float(timeDivision); // ticks per beat (a beat is defined as a quarter note)
+  }
+
+  void on_timing(tempo_map&& map, int64_t end_tick)
+  {
+    // Tempo at the first tick: 120 BPM unless the file sets it
+    self.startingTempo = float(60'000'000. / map.tempo_at(0));
+    self.tempoMap = std::move(map);
+    self.endTick = end_tick;
+  }
+
+  void begin(int track_count) { self.tracks.resize(track_count); }
+
+  void begin_track(int track, uint32_t length) { self.tracks[track].reserve(length / 3); }
+
+  void on_event(int track, int tick, const raw_event& ev)
+  {
+    auto& event = self.tracks[track].emplace_back(tick, track, message{});
+    event.m.bytes.reserve(ev.total_size());
+    if (ev.has_head)
+      event.m.bytes.push_back(ev.head);
+    event.m.bytes.insert(event.m.bytes.end(), ev.data, ev.data + ev.size);
+  }
+
+  parse_error end_track(int track, bool validate)
+  {
+    return validate ? validator::validate_track(self.tracks[track]) : parse_error::none;
+  }
+
+  void finish(int track_count) { self.tracks.resize(track_count); }
+
+  void on_diagnostic(const parse_diagnostic& d) { self.diagnostics.push_back(d); }
+};
+
+LIBREMIDI_INLINE
+auto reader::parse(const uint8_t* dataPtr, std::size_t size) noexcept -> parse_result
+{
+  tracks.clear();
+  diagnostics.clear();
+  tempoMap = {};
+  endTick = 0;
+  ticksPerBeat = 0.f;
+  startingTempo = 0.f;
+  format = 0;
+
+  reader_builder builder{*this};
+  return parse_smf(
+      dataPtr, size, useAbsoluteTicks, parse_thread_count(threadCount, size), builder);
+}
+
+LIBREMIDI_INLINE
+double reader::get_end_time() const noexcept
+{
+  return end_time(tracks, useAbsoluteTicks);
+}
+
+LIBREMIDI_INLINE
+double reader::get_end_seconds() const noexcept
+{
+  return tempoMap.tick_to_seconds(endTick);
+}
+
+LIBREMIDI_INLINE
+auto reader::parse(const std::vector<uint8_t>& buffer) noexcept -> parse_result
+{
   return parse(buffer.data(), buffer.size());
 }
 
@@ -749,4 +950,732 @@ auto reader::parse(std::span<uint8_t> buffer) noexcept -> parse_result
   return parse(buffer.data(), buffer.size());
 }
 #endif
+
+LIBREMIDI_INLINE
+auto reader::parse_file(const std::filesystem::path& path) noexcept -> parse_result
+{
+  // On failure, parsing nothing resets the previous file and reports an empty buffer
+  mapped_file file;
+  if (!file.open(path))
+  {
+#if defined(__LIBREMIDI_DEBUG__)
+    std::cerr << "could not open " << path << std::endl;
+#endif
+    return parse(nullptr, 0);
+  }
+  return parse(file.data(), file.size());
+}
+
+// Builds the compact records, without allocating per event
+struct reader_view_builder
+{
+  reader_view& self;
+  const uint8_t* source{};
+
+  void on_format(int format) { self.format = format; }
+  void on_time_division(uint16_t timeDivision)
+  {
+    self.startingTempo = 120.0f;
+    self.ticksPerBeat = float(timeDivision);
+  }
+
+  void on_timing(tempo_map&& map, int64_t end_tick)
+  {
+    // Tempo at the first tick: 120 BPM unless the file sets it
+    self.startingTempo = float(60'000'000. / map.tempo_at(0));
+    self.tempoMap = std::move(map);
+    self.endTick = end_tick;
+  }
+
+  void begin(int track_count) { self.m_storage.resize(track_count); }
+
+  void begin_track(int track, uint32_t length)
+  {
+    auto& storage = self.m_storage[track];
+    storage.records.clear();
+    storage.payload.clear();
+    storage.records.reserve(length / 3);
+  }
+
+  void on_event(int track, int tick, const raw_event& ev)
+  {
+    auto& storage = self.m_storage[track];
+    smf_event_record r{.tick = tick, .size = uint32_t(ev.total_size())};
+    if (r.size <= sizeof(r.bytes))
+    {
+      r.storage = smf_event_record::inline_bytes;
+      uint8_t* out = r.bytes;
+      if (ev.has_head)
+        *out++ = ev.head;
+      std::copy_n(ev.data, ev.size, out);
+    }
+    else if (!ev.has_head)
+    {
+      r.storage = smf_event_record::source_buffer;
+      r.offset = uint32_t(ev.data - source);
+    }
+    else
+    {
+      // Sysex: F0 and the payload are separated by the length in the file
+      r.storage = smf_event_record::payload_storage;
+      r.offset = uint32_t(storage.payload.size());
+      storage.payload.push_back(ev.head);
+      storage.payload.insert(storage.payload.end(), ev.data, ev.data + ev.size);
+    }
+    storage.records.push_back(r);
+  }
+
+  reader_view::track_view view(int track) const noexcept
+  {
+    const auto& storage = self.m_storage[track];
+    return {track, storage.records, source, storage.payload.data()};
+  }
+
+  parse_error end_track(int track, bool validate)
+  {
+    return validate ? validator::validate_track(view(track)) : parse_error::none;
+  }
+
+  void on_diagnostic(const parse_diagnostic& d) { self.diagnostics.push_back(d); }
+
+  void finish(int track_count)
+  {
+    self.tracks.clear();
+    self.m_storage.resize(track_count);
+    self.tracks.reserve(track_count);
+    for (int i = 0; i < track_count; i++)
+      self.tracks.push_back(view(i));
+  }
+};
+
+LIBREMIDI_INLINE
+reader_view::reader_view(bool useAbsolute)
+    : ticksPerBeat(480)
+    , startingTempo(120)
+    , useAbsoluteTicks(useAbsolute)
+{
+}
+
+LIBREMIDI_INLINE
+reader_view::~reader_view() = default;
+
+LIBREMIDI_INLINE
+auto reader_view::parse(const uint8_t* dataPtr, std::size_t size) noexcept -> parse_result
+{
+  // The storage of each track is kept, to reuse its memory
+  tracks.clear();
+  diagnostics.clear();
+  tempoMap = {};
+  endTick = 0;
+  ticksPerBeat = 0.f;
+  startingTempo = 0.f;
+  format = 0;
+  m_file.reset();
+
+  reader_view_builder builder{*this, dataPtr};
+  return parse_smf(
+      dataPtr, size, useAbsoluteTicks, parse_thread_count(threadCount, size), builder);
+}
+
+LIBREMIDI_INLINE
+auto reader_view::parse(const std::vector<uint8_t>& buffer) noexcept -> parse_result
+{
+  return parse(buffer.data(), buffer.size());
+}
+
+LIBREMIDI_INLINE
+auto reader_view::parse(std::span<const uint8_t> buffer) noexcept -> parse_result
+{
+  return parse(buffer.data(), buffer.size());
+}
+
+LIBREMIDI_INLINE
+auto reader_view::parse_file(const std::filesystem::path& path) noexcept -> parse_result
+{
+  // On failure, parsing nothing resets the previous file and reports an empty buffer
+  std::shared_ptr<mapped_file> file;
+#if defined(__cpp_exceptions)
+  try
+  {
+    file = std::make_shared<mapped_file>();
+  }
+  catch (const std::bad_alloc&)
+  {
+    return parse(nullptr, 0);
+  }
+#else
+  file = std::make_shared<mapped_file>();
+#endif
+
+  if (!file->open(path))
+  {
+#if defined(__LIBREMIDI_DEBUG__)
+    std::cerr << "could not open " << path << std::endl;
+#endif
+    return parse(nullptr, 0);
+  }
+
+  const auto res = parse(file->data(), file->size());
+  m_file = std::move(file);
+  return res;
+}
+
+LIBREMIDI_INLINE
+double reader_view::get_end_time() const noexcept
+{
+  return end_time(tracks, useAbsoluteTicks);
+}
+
+LIBREMIDI_INLINE
+double reader_view::get_end_seconds() const noexcept
+{
+  return tempoMap.tick_to_seconds(endTick);
+}
+
+LIBREMIDI_INLINE
+midi_track reader_view::track_view::to_track() const
+{
+  midi_track track;
+  track.reserve(size());
+  for (const auto& r : m_records)
+    track.push_back(make_view(r).to_event());
+  return track;
+}
+
+LIBREMIDI_INLINE
+std::vector<midi_track> reader_view::to_tracks() const
+{
+  std::vector<midi_track> res;
+  res.reserve(tracks.size());
+  for (const auto& t : tracks)
+    res.push_back(t.to_track());
+  return res;
+}
+
+LIBREMIDI_INLINE
+stream_reader::stream_reader() noexcept
+    : ticksPerBeat(480)
+    , startingTempo(120)
+{
+}
+
+LIBREMIDI_INLINE
+stream_reader::~stream_reader() = default;
+
+LIBREMIDI_INLINE
+auto stream_reader::open(const uint8_t* dataPtr, std::size_t size) noexcept -> parse_result
+{
+  struct header_handler
+  {
+    stream_reader& self;
+    void on_format(int format) { self.format = format; }
+    void on_time_division(uint16_t timeDivision)
+    {
+      self.startingTempo = 120.0f;
+      self.ticksPerBeat = float(timeDivision);
+    }
+  } handler{*this};
+
+  ticksPerBeat = 0.f;
+  startingTempo = 0.f;
+  format = 0;
+  m_tracks.clear();
+  m_heap.clear();
+  m_checkpoints.clear();
+  m_checkpoint_tracks.clear();
+  m_indexed = false;
+  m_file.reset();
+  m_base = dataPtr;
+  m_layout = parse_result::invalid;
+  m_layout_diagnostic = {};
+  m_junk_at_end = false;
+
+  const uint8_t* const dataEnd = dataPtr + size;
+
+#if defined(__cpp_exceptions)
+  try
+#endif
+  {
+    int trackCount = 0;
+    if (auto err = read_smf_header(dataPtr, dataEnd, trackCount, handler);
+        err != parse_error::none)
+    {
+      m_layout_diagnostic = {0, -1, err};
+      rewind();
+      return parse_result::invalid;
+    }
+
+    std::vector<track_chunk> chunks;
+    m_layout
+        = locate_track_chunks(m_base, dataPtr, dataEnd, trackCount, chunks, m_layout_diagnostic);
+    if (m_layout == parse_result::validated && dataPtr != dataEnd)
+    {
+      m_junk_at_end = true;
+      m_layout_diagnostic = {std::size_t(dataPtr - m_base), -1, parse_error::junk_at_end};
+    }
+
+    m_tracks.reserve(chunks.size());
+    for (const auto& chunk : chunks)
+      m_tracks.push_back({.begin = chunk.data, .end = chunk.data + chunk.length});
+    m_heap.reserve(m_tracks.size());
+  }
+#if defined(__cpp_exceptions)
+  catch (const std::bad_alloc&)
+  {
+    m_tracks.clear();
+    m_layout = parse_result::invalid;
+    m_layout_diagnostic = {0, -1, parse_error::out_of_memory};
+  }
+#endif
+
+  rewind();
+
+  // The events have not been checked yet
+  const auto res = result();
+  return res == parse_result::validated ? parse_result::complete : res;
+}
+
+LIBREMIDI_INLINE
+auto stream_reader::open(const std::vector<uint8_t>& buffer) noexcept -> parse_result
+{
+  return open(buffer.data(), buffer.size());
+}
+
+LIBREMIDI_INLINE
+auto stream_reader::open(std::span<const uint8_t> buffer) noexcept -> parse_result
+{
+  return open(buffer.data(), buffer.size());
+}
+
+LIBREMIDI_INLINE
+auto stream_reader::open_file(const std::filesystem::path& path) noexcept -> parse_result
+{
+  std::shared_ptr<mapped_file> file;
+#if defined(__cpp_exceptions)
+  try
+  {
+    file = std::make_shared<mapped_file>();
+  }
+  catch (const std::bad_alloc&)
+  {
+    return open(nullptr, 0);
+  }
+#else
+  file = std::make_shared<mapped_file>();
+#endif
+
+  if (!file->open(path))
+  {
+#if defined(__LIBREMIDI_DEBUG__)
+    std::cerr << "could not open " << path << std::endl;
+#endif
+    return open(nullptr, 0);
+  }
+
+  const auto res = open(file->data(), file->size());
+  m_file = std::move(file);
+  return res;
+}
+
+LIBREMIDI_INLINE
+void stream_reader::rewind() noexcept
+{
+  // Once indexed, the diagnostics of the whole file are known
+  if (!m_indexed)
+  {
+    m_invalid = false;
+    m_incomplete = false;
+    m_not_validated = m_junk_at_end;
+
+    // The diagnostics of the layout are known from the start,
+    // even if they concern the end of the file
+    diagnostics.clear();
+    if (m_layout_diagnostic.error != parse_error::none)
+      report(m_layout_diagnostic);
+  }
+
+  m_heap.clear();
+  for (std::size_t i = 0; i < m_tracks.size(); i++)
+  {
+    auto& cursor = m_tracks[i];
+    cursor.data = cursor.begin;
+    cursor.tick = 0;
+    cursor.running_status = message_type::INVALID;
+    cursor.has_events = false;
+    cursor.has_end_of_track = false;
+    cursor.has_events_after_end = false;
+
+    if (advance(cursor))
+      m_heap.push_back(uint32_t(i));
+    else
+      end_track(cursor);
+  }
+
+  std::make_heap(m_heap.begin(), m_heap.end(), heap_order());
+}
+
+LIBREMIDI_INLINE
+void stream_reader::report(const parse_diagnostic& d) noexcept
+{
+  if (m_indexed)
+    return;
+
+#if defined(__cpp_exceptions)
+  try
+  {
+    diagnostics.push_back(d);
+  }
+  catch (...)
+  {
+  }
+#else
+  diagnostics.push_back(d);
+#endif
+}
+
+// Reads the delta-time of the next event of the track
+LIBREMIDI_INLINE
+bool stream_reader::advance(track_cursor& cursor) noexcept
+{
+  if (cursor.data >= cursor.end)
+    return false;
+
+  std::size_t delta = 0;
+  if (!util::read_checked::read_variable_length(cursor.data, cursor.end, delta))
+  {
+    report(
+        {std::size_t(cursor.data - m_base), int(&cursor - m_tracks.data()),
+         parse_error::truncated_event});
+    m_invalid = true;
+    return false;
+  }
+
+  cursor.tick += delta;
+  return true;
+}
+
+// Same checks as the validator, once all the events of the track are known
+LIBREMIDI_INLINE
+void stream_reader::end_track(const track_cursor& cursor) noexcept
+{
+  parse_error err = parse_error::none;
+  if (!cursor.has_events)
+    err = parse_error::empty_track;
+  else if (!cursor.has_end_of_track)
+    err = parse_error::missing_end_of_track;
+  else
+    return;
+
+  m_not_validated = true;
+  report({std::size_t(cursor.begin - m_base - 8), int(&cursor - m_tracks.data()), err});
+}
+
+LIBREMIDI_INLINE
+auto stream_reader::next() noexcept -> std::optional<track_event_view>
+{
+  return next_before(std::numeric_limits<int64_t>::max());
+}
+
+// The next event if its tick is before the end tick. Tracks which cannot be decoded
+// further are skipped until then.
+LIBREMIDI_INLINE
+auto stream_reader::next_before(int64_t end) noexcept -> std::optional<track_event_view>
+{
+  while (!m_heap.empty() && m_tracks[m_heap.front()].tick < end)
+  {
+    std::pop_heap(m_heap.begin(), m_heap.end(), heap_order());
+    const auto index = m_heap.back();
+    m_heap.pop_back();
+
+    auto& cursor = m_tracks[index];
+
+    // Like reader, skip the rest of the track in case of error
+    const uint8_t* const eventStart = cursor.data;
+    raw_event ev;
+    if (auto err = decode_event(cursor.data, cursor.end, cursor.running_status, ev);
+        err != parse_error::none)
+    {
+      report({std::size_t(eventStart - m_base), int(index), err});
+      m_incomplete = true;
+      continue;
+    }
+
+    if (ev.total_size() == 0)
+    {
+      report({std::size_t(eventStart - m_base), int(index), parse_error::empty_event});
+      m_incomplete = true;
+      continue;
+    }
+
+    if (ev.front() != 0xFF)
+      cursor.running_status = static_cast<message_type>(ev.front());
+
+    // Anything after an end of track, including another one, breaks the SMF rules
+    if (cursor.has_end_of_track && !cursor.has_events_after_end)
+    {
+      cursor.has_events_after_end = true;
+      m_not_validated = true;
+      report(
+          {std::size_t(cursor.begin - m_base - 8), int(index),
+           parse_error::events_after_end_of_track});
+    }
+    if (!ev.has_head && ev.size == 3 && ev.data[0] == 0xFF
+        && ev.data[1] == uint8_t(meta_event_type::END_OF_TRACK))
+      cursor.has_end_of_track = true;
+    cursor.has_events = true;
+
+    std::span<const uint8_t> bytes;
+    if (!ev.has_head)
+    {
+      bytes = {ev.data, ev.size};
+    }
+    else if (ev.total_size() <= sizeof(m_short))
+    {
+      m_short[0] = ev.head;
+      std::copy_n(ev.data, ev.size, m_short + 1);
+      bytes = {m_short, ev.total_size()};
+    }
+    else
+    {
+      // Sysex: the F0 is not contiguous with the payload in the file
+#if defined(__cpp_exceptions)
+      try
+      {
+        m_sysex.resize(ev.total_size());
+      }
+      catch (const std::bad_alloc&)
+      {
+        report({std::size_t(eventStart - m_base), int(index), parse_error::out_of_memory});
+        m_invalid = true;
+        m_heap.clear();
+        return std::nullopt;
+      }
+#else
+      m_sysex.resize(ev.total_size());
+#endif
+      m_sysex[0] = ev.head;
+      std::copy_n(ev.data, ev.size, m_sysex.data() + 1);
+      bytes = m_sysex;
+    }
+
+    const auto tick = cursor.tick;
+    if (advance(cursor))
+    {
+      m_heap.push_back(index);
+      std::push_heap(m_heap.begin(), m_heap.end(), heap_order());
+    }
+    else
+    {
+      end_track(cursor);
+    }
+
+    return track_event_view{
+        .tick = static_cast<int>(tick), .track = int(index), .m = {.bytes = bytes}};
+  }
+  return std::nullopt;
+}
+
+LIBREMIDI_INLINE
+bool stream_reader::build_seek_index(int64_t interval) noexcept
+{
+  m_checkpoints.clear();
+  m_checkpoint_tracks.clear();
+  m_indexed = false;
+  interval = std::max(interval, int64_t(1));
+
+  rewind();
+
+  playback_state state;
+  int64_t next_checkpoint = 0;
+#if defined(__cpp_exceptions)
+  try
+#endif
+  {
+    while (!m_heap.empty())
+    {
+      // The state before the next event holds from the last multiple of the interval
+      // up to its tick: only one checkpoint is needed across long gaps
+      if (const int64_t tick = m_tracks[m_heap.front()].tick; tick >= next_checkpoint)
+      {
+        const int64_t checkpoint_tick = tick - tick % interval;
+        m_checkpoints.push_back({checkpoint_tick, state});
+
+        const std::size_t first = m_checkpoint_tracks.size();
+        for (const auto& cursor : m_tracks)
+        {
+          m_checkpoint_tracks.push_back(cursor);
+          m_checkpoint_tracks.back().data = cursor.end;
+        }
+        for (uint32_t i : m_heap)
+          m_checkpoint_tracks[first + i].data = m_tracks[i].data;
+        next_checkpoint = checkpoint_tick + interval;
+      }
+
+      while (auto ev = next_before(next_checkpoint))
+        state.apply(ev->m.bytes);
+    }
+  }
+#if defined(__cpp_exceptions)
+  catch (const std::bad_alloc&)
+  {
+    m_checkpoints.clear();
+    m_checkpoint_tracks.clear();
+    rewind();
+    return false;
+  }
+#endif
+
+  m_indexed = true;
+  rewind();
+  return true;
+}
+
+LIBREMIDI_INLINE
+playback_state stream_reader::seek(int64_t tick) noexcept
+{
+  playback_state state;
+
+  auto it = std::ranges::upper_bound(m_checkpoints, tick, {}, &checkpoint::tick);
+  if (it == m_checkpoints.begin())
+  {
+    rewind();
+  }
+  else
+  {
+    --it;
+    state = it->state;
+
+    const auto first = std::size_t(it - m_checkpoints.begin()) * m_tracks.size();
+    std::copy_n(m_checkpoint_tracks.begin() + first, m_tracks.size(), m_tracks.begin());
+
+    m_heap.clear();
+    for (std::size_t i = 0; i < m_tracks.size(); i++)
+      if (m_tracks[i].data < m_tracks[i].end)
+        m_heap.push_back(uint32_t(i));
+    std::make_heap(m_heap.begin(), m_heap.end(), heap_order());
+  }
+
+  // Chase the events up to the tick
+  while (auto ev = next_before(tick))
+    state.apply(ev->m.bytes);
+  return state;
+}
+
+LIBREMIDI_INLINE
+void playback_state::apply(std::span<const uint8_t> bytes) noexcept
+{
+  if (bytes.size() == 6 && bytes[0] == 0xFF && bytes[1] == 0x51 && bytes[2] == 0x03)
+  {
+    const uint32_t t = uint32_t(bytes[3]) << 16 | uint32_t(bytes[4]) << 8 | bytes[5];
+    if (t != 0)
+      tempo = t;
+    return;
+  }
+
+  if (bytes.size() < 2 || bytes[0] < 0x80 || bytes[0] >= 0xF0)
+    return;
+
+  auto& c = channels[bytes[0] & 0x0F];
+  switch (bytes[0] & 0xF0)
+  {
+    case 0xB0:
+      if (bytes.size() < 3)
+        break;
+      if (bytes[1] < c.controllers.size())
+      {
+        c.controllers[bytes[1]] = bytes[2];
+        if (bytes[1] >= 98 && bytes[1] <= 101)
+          c.nrpn = bytes[1] <= 99;
+      }
+      else if (bytes[1] == 121)
+      {
+        // Reset All Controllers, as per RP-015: modulation, pedals, channel pressure and
+        // pitch bend go back to their default, expression to 127, and the parameter
+        // numbers to null. Bank select, volume, pan, data entry, and the sound and
+        // effects controllers are kept; the device default of the others is not known.
+        for (std::size_t cc = 1; cc < c.controllers.size(); cc++)
+        {
+          if (cc != 6 && cc != 7 && cc != 10 && cc != 32 && cc != 38 && !(cc >= 70 && cc <= 79)
+              && !(cc >= 91 && cc <= 95))
+            c.controllers[cc] = unset;
+        }
+        c.controllers[1] = 0;
+        c.controllers[11] = 127;
+        for (std::size_t cc = 64; cc <= 67; cc++)
+          c.controllers[cc] = 0;
+        for (std::size_t cc = 98; cc <= 101; cc++)
+          c.controllers[cc] = 127;
+        c.nrpn = false;
+        c.pressure = 0;
+        c.pitch_bend = 0x2000;
+      }
+      break;
+    case 0xC0:
+      c.program = bytes[1];
+      break;
+    case 0xD0:
+      c.pressure = bytes[1];
+      break;
+    case 0xE0:
+      if (bytes.size() >= 3)
+        c.pitch_bend = uint16_t(bytes[1] | (bytes[2] << 7));
+      break;
+    default:
+      break;
+  }
+}
+
+LIBREMIDI_INLINE
+std::vector<message> playback_state::messages() const
+{
+  std::vector<message> res;
+  for (std::size_t i = 0; i < channels.size(); i++)
+  {
+    const auto& c = channels[i];
+    const auto ch = uint8_t(i);
+    const auto send_cc = [&](uint8_t cc) {
+      if (c.controllers[cc] != unset)
+        res.push_back(message{uint8_t(0xB0 | ch), cc, c.controllers[cc]});
+    };
+
+    // Data entry applies to the parameter selected last: it is sent after the parameter
+    // numbers, in the order they were selected. Data increment and decrement are not
+    // sent, as they would apply again to the value restored by data entry.
+    const auto is_parameter_cc
+        = [](std::size_t cc) { return cc == 6 || cc == 38 || (cc >= 96 && cc <= 101); };
+    for (std::size_t cc = 0; cc < c.controllers.size(); cc++)
+      if (!is_parameter_cc(cc))
+        send_cc(uint8_t(cc));
+
+    constexpr std::array<uint8_t, 2> rpn{101, 100}, nrpn{99, 98};
+    for (uint8_t cc : c.nrpn ? rpn : nrpn)
+      send_cc(cc);
+    for (uint8_t cc : c.nrpn ? nrpn : rpn)
+      send_cc(cc);
+    send_cc(6);
+    send_cc(38);
+    if (c.program != unset)
+      res.push_back(message{uint8_t(0xC0 | ch), c.program});
+    if (c.pressure != unset)
+      res.push_back(message{uint8_t(0xD0 | ch), c.pressure});
+    if (c.pitch_bend != unset_pitch_bend)
+      res.push_back(message{
+          uint8_t(0xE0 | ch), uint8_t(c.pitch_bend & 0x7F), uint8_t(c.pitch_bend >> 7)});
+  }
+  return res;
+}
+
+LIBREMIDI_INLINE
+auto stream_reader::result() const noexcept -> parse_result
+{
+  if (m_invalid)
+    return parse_result::invalid;
+  if (m_layout != parse_result::validated)
+    return m_layout;
+  if (m_incomplete)
+    return parse_result::incomplete;
+  if (m_not_validated)
+    return parse_result::complete;
+  return parse_result::validated;
+}
 }
@@ -25,10 +25,66 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #pragma once
 
+#include <libremidi/columnar_tracks.hpp>
+#include <libremidi/merged_tracks.hpp>
 #include <libremidi/message.hpp>
+#include <libremidi/tempo_map.hpp>
+
+#include <array>
+#include <compare>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
 
 namespace libremidi
 {
+//! Why a part of a MIDI file could not be parsed, or does not follow the SMF rules
+enum class parse_error : uint8_t
+{
+  none,
+
+  // The file cannot be parsed at all
+  empty_buffer,
+  invalid_header,            //! No MThd chunk of length 6
+  unsupported_format,        //! SMF format other than 0, 1 or 2
+  unsupported_time_division, //! SMPTE time division
+
+  // The following tracks cannot be read
+  truncated_track_header,
+  missing_track_header, //! A chunk is not a MTrk chunk
+  truncated_track,      //! The chunk length goes past the end of the file
+
+  // The rest of the track is skipped
+  truncated_event,    //! An event or delta-time goes past the end of its chunk
+  empty_event,        //! A sysex or escape event without any byte
+  invalid_meta_event, //! Wrong length or out-of-range value, e.g. a key signature
+  invalid_data_byte,  //! A channel message has a data byte greater than 127
+  unsupported_event,  //! A status byte which cannot be used in a file, e.g. a realtime message
+
+  // The track or file does not follow the SMF rules, but all its events were read
+  empty_track,
+  missing_end_of_track,
+  events_after_end_of_track,
+  junk_at_end, //! Data after the last track
+
+  // MIDI 2.0 clip files
+  missing_ticks_per_quarter, //! No Delta Clockstamp Ticks Per Quarter Note in the clip header
+  missing_delta_clockstamp,  //! A message which does not follow a delta clockstamp
+
+  out_of_memory
+};
+
+//! Describes an error found while parsing a MIDI file
+struct parse_diagnostic
+{
+  std::size_t offset{}; //! Byte offset from the beginning of the file
+  int track{-1};        //! Index of the track, or -1 for the file header and trailing data
+  parse_error error{};
+};
+
 /**
  * @brief reads Standard MIDI files (SMF).
  *
@@ -38,6 +94,8 @@ namespace libremidi
  * libremidi::reader r;
  * auto res = r.parse(midi_bytes, num_bytes);
  * ```
+ *
+ * Errors are reported through the result and the diagnostics: no exception is thrown.
  */
 class LIBREMIDI_EXPORT reader
 {
@@ -57,17 +115,443 @@ public:
   parse_result parse(const std::vector<uint8_t>& buffer) noexcept;
   parse_result parse(std::span<uint8_t> buffer) noexcept;
 
+  //! Parses a file directly from a read-only memory mapping of it,
+  //! which is released once the events have been copied
+  parse_result parse_file(const std::filesystem::path& path) noexcept;
+
+  //! In ticks, computed from the tracks
   [[nodiscard]] double get_end_time() const noexcept;
 
+  //! In seconds, following the tempo changes, as computed when parsing
+  [[nodiscard]] double get_end_seconds() const noexcept;
+
+  //! Absolute tick of the last event, as computed when parsing
+  [[nodiscard]] int64_t get_end_tick() const noexcept { return endTick; }
+
   float ticksPerBeat{}; // precision (number of ticks distinguishable per second)
-  float startingTempo{};
+  float startingTempo{}; // in BPM, at the first tick
   int format{};
 
+  //! Tempo changes of all the tracks, to convert ticks to time
+  tempo_map tempoMap;
+
+  //! Number of threads parsing the track chunks: 1 parses them in the calling thread,
+  //! 0 uses one per hardware thread for large files. The result does not depend on it.
+  int threadCount{1};
+
   std::vector<midi_track> tracks;
 
+  //! The events of all the tracks in time order, with absolute ticks.
+  //! merged().to_track() gives the equivalent format-0 track.
+  [[nodiscard]] merged_tracks merged() const noexcept
+  {
+    return merged_tracks{tracks, useAbsoluteTicks};
+  }
+
+  //! Copies the events of all the tracks into parallel arrays, in time order
+  [[nodiscard]] columnar_tracks columns() const
+  {
+    return columnar_tracks{tracks, useAbsoluteTicks};
+  }
+
+  //! What could not be parsed or validated, in file order
+  std::vector<parse_diagnostic> diagnostics;
+
+private:
+  friend struct reader_builder;
+  int64_t endTick{};
+  bool useAbsoluteTicks{};
+};
+
+/**
+ * @brief Compact representation of a track event, used by reader_view.
+ *
+ * Messages of up to three bytes (channel messages, end of track) are stored inline.
+ * Longer meta events refer to the parsed buffer, and sysex to the payload storage
+ * of their track in the reader_view, as their bytes are not contiguous in the file.
+ */
+struct smf_event_record
+{
+  enum storage_type : uint8_t
+  {
+    inline_bytes,
+    source_buffer,
+    payload_storage
+  };
+
+  int32_t tick{};
+  uint32_t offset{};
+  uint32_t size{};
+  storage_type storage{};
+  uint8_t bytes[3]{};
+};
+static_assert(sizeof(smf_event_record) == 16);
+
+/**
+ * @brief reads Standard MIDI files without allocating memory per event.
+ *
+ * The events are stored as smf_event_record in one array per track, and the
+ * iterators of each track give track_event_view objects, with the same interface
+ * as track_event. The parsed buffer must outlive the reader_view, unless it was
+ * loaded with parse_file.
+ *
+ * ```
+ * libremidi::reader_view r;
+ * r.parse(midi_bytes, num_bytes);
+ * for (const auto& track : r.tracks)
+ *   for (const auto& event : track)
+ *     process(event.tick, event.m.bytes);
+ * ```
+ */
+class LIBREMIDI_EXPORT reader_view
+{
+public:
+  using parse_result = reader::parse_result;
+
+  class track_view
+  {
+  public:
+    //! Gives a track_event_view for each record, by value: as with merged_tracks,
+    //! loops must bind it with const auto& or auto, not auto&.
+    //! The legacy category is input as there is no object to refer to, but the
+    //! iterator models std::random_access_iterator, e.g. for the ranges algorithms.
+    class iterator
+    {
+    public:
+      using iterator_category = std::input_iterator_tag;
+      using iterator_concept = std::random_access_iterator_tag;
+      using value_type = track_event_view;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = value_type;
+
+      iterator() noexcept = default;
+      iterator(const track_view* track, const smf_event_record* record) noexcept
+          : m_track{track}
+          , m_record{record}
+      {
+      }
+
+      reference operator*() const noexcept { return m_track->make_view(*m_record); }
+      value_type operator[](difference_type n) const noexcept
+      {
+        return m_track->make_view(m_record[n]);
+      }
+
+      iterator& operator++() noexcept
+      {
+        ++m_record;
+        return *this;
+      }
+      iterator operator++(int) noexcept
+      {
+        auto it = *this;
+        ++m_record;
+        return it;
+      }
+      iterator& operator--() noexcept
+      {
+        --m_record;
+        return *this;
+      }
+      iterator operator--(int) noexcept
+      {
+        auto it = *this;
+        --m_record;
+        return it;
+      }
+      iterator& operator+=(difference_type n) noexcept
+      {
+        m_record += n;
+        return *this;
+      }
+      iterator& operator-=(difference_type n) noexcept
+      {
+        m_record -= n;
+        return *this;
+      }
+      friend iterator operator+(iterator it, difference_type n) noexcept { return it += n; }
+      friend iterator operator+(difference_type n, iterator it) noexcept { return it += n; }
+      friend iterator operator-(iterator it, difference_type n) noexcept { return it -= n; }
+      friend difference_type operator-(const iterator& lhs, const iterator& rhs) noexcept
+      {
+        return lhs.m_record - rhs.m_record;
+      }
+      friend bool operator==(const iterator& lhs, const iterator& rhs) noexcept
+      {
+        return lhs.m_record == rhs.m_record;
+      }
+      friend auto operator<=>(const iterator& lhs, const iterator& rhs) noexcept
+      {
+        return lhs.m_record <=> rhs.m_record;
+      }
+
+    private:
+      const track_view* m_track{};
+      const smf_event_record* m_record{};
+    };
+    using const_iterator = iterator;
+
+    track_view() noexcept = default;
+    track_view(
+        int index, std::span<const smf_event_record> records, const uint8_t* source,
+        const uint8_t* payload) noexcept
+        : m_records{records}
+        , m_source{source}
+        , m_payload{payload}
+        , m_index{index}
+    {
+    }
+
+    iterator begin() const noexcept { return {this, m_records.data()}; }
+    iterator end() const noexcept { return {this, m_records.data() + m_records.size()}; }
+    std::size_t size() const noexcept { return m_records.size(); }
+    bool empty() const noexcept { return m_records.empty(); }
+
+    track_event_view operator[](std::size_t i) const noexcept { return make_view(m_records[i]); }
+    track_event_view front() const noexcept { return make_view(m_records.front()); }
+    track_event_view back() const noexcept { return make_view(m_records.back()); }
+
+    std::span<const smf_event_record> records() const noexcept { return m_records; }
+
+    track_event_view make_view(const smf_event_record& r) const noexcept
+    {
+      const uint8_t* data{};
+      switch (r.storage)
+      {
+        case smf_event_record::inline_bytes:
+          data = r.bytes;
+          break;
+        case smf_event_record::source_buffer:
+          data = m_source + r.offset;
+          break;
+        case smf_event_record::payload_storage:
+          data = m_payload + r.offset;
+          break;
+      }
+      return {.tick = r.tick, .track = m_index, .m = {.bytes = {data, r.size}}};
+    }
+
+    //! Copies the events into a midi_track, as reader would have parsed them
+    midi_track to_track() const;
+
+  private:
+    std::span<const smf_event_record> m_records;
+    const uint8_t* m_source{};
+    const uint8_t* m_payload{};
+    int m_index{};
+  };
+
+  explicit reader_view(bool useAbsolute = false);
+  ~reader_view();
+
+  reader_view(const reader_view&) = delete;
+  reader_view& operator=(const reader_view&) = delete;
+  reader_view(reader_view&&) noexcept = default;
+  reader_view& operator=(reader_view&&) noexcept = default;
+
+  parse_result parse(const uint8_t* data, std::size_t size) noexcept;
+  parse_result parse(const std::vector<uint8_t>& buffer) noexcept;
+  parse_result parse(std::span<const uint8_t> buffer) noexcept;
+
+  //! Parses a file directly from a read-only memory mapping of it. The mapping is
+  //! kept until the next parse, so that meta events refer to it instead of a copy.
+  parse_result parse_file(const std::filesystem::path& path) noexcept;
+
+  [[nodiscard]] double get_end_time() const noexcept;
+  [[nodiscard]] double get_end_seconds() const noexcept;
+  [[nodiscard]] int64_t get_end_tick() const noexcept { return endTick; }
+
+  //! Copies the events into the same structure as reader::tracks
+  [[nodiscard]] std::vector<midi_track> to_tracks() const;
+
+  float ticksPerBeat{};
+  float startingTempo{};
+  int format{};
+  tempo_map tempoMap;
+
+  //! See reader::threadCount
+  int threadCount{1};
+
+  std::vector<track_view> tracks;
+
+  //! See reader::diagnostics
+  std::vector<parse_diagnostic> diagnostics;
+
 private:
+  friend struct reader_view_builder;
+  struct track_storage
+  {
+    std::vector<smf_event_record> records;
+    std::vector<uint8_t> payload;
+  };
+  std::vector<track_storage> m_storage;
+  std::shared_ptr<const void> m_file;
+  int64_t endTick{};
   bool useAbsoluteTicks{};
 };
+static_assert(std::random_access_iterator<reader_view::track_view::iterator>);
+
+//! What a player needs to start from a given point of a file: the last tempo,
+//! and the last program, controller values, pressure and pitch bend of each channel
+struct LIBREMIDI_EXPORT playback_state
+{
+  static constexpr uint8_t unset = 0xFF;
+  static constexpr uint16_t unset_pitch_bend = 0xFFFF;
+
+  struct channel
+  {
+    std::array<uint8_t, 120> controllers; //! Channel mode messages are not kept
+    uint8_t program{unset};
+    uint8_t pressure{unset};
+    uint16_t pitch_bend{unset_pitch_bend};
+
+    //! Whether the NRPN numbers (CC99/98) were selected after the RPN ones (CC101/100),
+    //! so that data entry applies to them
+    bool nrpn{};
+
+    channel() noexcept { controllers.fill(unset); }
+  };
+
+  uint32_t tempo{500000}; //! In microseconds per quarter note
+  std::array<channel, 16> channels;
+
+  //! Updates the state with a channel message or tempo change
+  void apply(std::span<const uint8_t> bytes) noexcept;
+
+  //! The messages which restore the state of the channels, with the bank selects and
+  //! controllers before the program changes. The parameter numbers are sent before
+  //! data entry, the ones selected last at the end, so that the values go to them.
+  [[nodiscard]] std::vector<message> messages() const;
+};
+
+/**
+ * @brief reads the events of a Standard MIDI file one at a time, in time order.
+ *
+ * Opening only reads the header and locates the track chunks. Each call to next()
+ * then decodes the next event of the track which comes first, so that memory use
+ * only depends on the number of tracks and not on the size of the file.
+ * Events at the same tick are given in track order. Ticks are absolute.
+ *
+ * The returned view is valid until the next call to next(), and as long as
+ * the parsed buffer (unless it was opened with open_file).
+ *
+ * ```
+ * libremidi::stream_reader s;
+ * if (s.open(midi_bytes) != libremidi::reader::invalid)
+ *   while (auto event = s.next())
+ *     play(event->tick, event->m);
+ * ```
+ */
+class LIBREMIDI_EXPORT stream_reader
+{
+public:
+  using parse_result = reader::parse_result;
+
+  stream_reader() noexcept;
+  ~stream_reader();
+
+  stream_reader(const stream_reader&) = delete;
+  stream_reader& operator=(const stream_reader&) = delete;
+  stream_reader(stream_reader&&) noexcept = default;
+  stream_reader& operator=(stream_reader&&) noexcept = default;
+
+  //! Reads the header and locates the tracks. The events have not been checked yet:
+  //! this gives invalid or incomplete if the file structure is, and complete otherwise.
+  parse_result open(const uint8_t* data, std::size_t size) noexcept;
+  parse_result open(const std::vector<uint8_t>& buffer) noexcept;
+  parse_result open(std::span<const uint8_t> buffer) noexcept;
+
+  //! Same as open, from a read-only memory mapping of the file kept until the next open
+  parse_result open_file(const std::filesystem::path& path) noexcept;
+
+  //! Restarts from the first event
+  void rewind() noexcept;
+
+  //! The next event in time order, or nothing once all the tracks have been read.
+  //! A track which cannot be decoded further is skipped from this point.
+  [[nodiscard]] std::optional<track_event_view> next() noexcept;
+
+  //! Same meaning as the result of reader::parse, for the events read so far.
+  //! Once all the events have been read, it is what reader::parse would have given.
+  [[nodiscard]] parse_result result() const noexcept;
+
+  [[nodiscard]] std::size_t track_count() const noexcept { return m_tracks.size(); }
+
+  //! Reads the whole file once to save, every `interval` ticks, the position and running
+  //! status of each track along with the playback state, so that seek() only has to read
+  //! the events since the closest of these checkpoints.
+  //! The diagnostics and result are then those of the whole file.
+  //! Returns false, without an index, if there is not enough memory.
+  bool build_seek_index(int64_t interval) noexcept;
+
+  //! Positions the reader so that next() gives the events from the given tick on,
+  //! and returns the playback state at this tick. Without a seek index,
+  //! the events are read from the start of the file.
+  playback_state seek(int64_t tick) noexcept;
+
+  float ticksPerBeat{};
+  float startingTempo{};
+  int format{};
+
+  //! What could not be parsed or validated so far. Errors in the file structure
+  //! are known when opening it, the others are added as the events are read.
+  std::vector<parse_diagnostic> diagnostics;
+
+private:
+  struct track_cursor
+  {
+    const uint8_t* begin{};
+    const uint8_t* data{};
+    const uint8_t* end{};
+    int64_t tick{};
+    message_type running_status{message_type::INVALID};
+    bool has_events{};
+    bool has_end_of_track{};
+    bool has_events_after_end{};
+  };
+
+  bool advance(track_cursor& cursor) noexcept;
+  std::optional<track_event_view> next_before(int64_t end) noexcept;
+  void end_track(const track_cursor& cursor) noexcept;
+  void report(const parse_diagnostic& d) noexcept;
+
+  // The std heap functions build max-heaps: the first track is the one with the
+  // lowest (tick, index)
+  auto heap_order() const noexcept
+  {
+    return [this](uint32_t lhs, uint32_t rhs) noexcept {
+      const auto& l = m_tracks[lhs];
+      const auto& r = m_tracks[rhs];
+      return l.tick != r.tick ? l.tick > r.tick : lhs > rhs;
+    };
+  }
+
+  std::vector<track_cursor> m_tracks;
+  std::vector<uint32_t> m_heap;
+  std::vector<uint8_t> m_sysex;
+  uint8_t m_short[3]{};
+
+  const uint8_t* m_base{};
+  parse_result m_layout{};
+  parse_diagnostic m_layout_diagnostic{};
+  bool m_junk_at_end{};
+  bool m_invalid{};
+  bool m_incomplete{};
+  bool m_not_validated{};
+  std::shared_ptr<const void> m_file;
+
+  // Each checkpoint saves the cursors of all the tracks, in m_checkpoint_tracks.
+  // The tracks which are over are saved with their data at their end.
+  struct checkpoint
+  {
+    int64_t tick{};
+    playback_state state;
+  };
+  std::vector<checkpoint> m_checkpoints;
+  std::vector<track_cursor> m_checkpoint_tracks;
+  bool m_indexed{};
+};
 }
 
 #if defined(LIBREMIDI_HEADER_ONLY)
@@ -0,0 +1,351 @@
+#if !defined(LIBREMIDI_HEADER_ONLY)
+  #include <libremidi/recorder.hpp>
+#endif
+
+#include <libremidi/detail/mapped_file.hpp>
+#include <libremidi/detail/smf_encoding.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace libremidi
+{
+namespace util
+{
+enum class scanned_event
+{
+  complete,
+  end_of_track,
+  incomplete
+};
+
+static LIBREMIDI_INLINE bool
+scan_variable_length(const uint8_t*& p, const uint8_t* end, uint32_t& value) noexcept
+{
+  value = 0;
+  for (int i = 0; i < 4 && p < end; i++)
+  {
+    const uint8_t b = *p++;
+    value = (value << 7) | (b & 0x7F);
+    if (!(b & 0x80))
+      return true;
+  }
+  return false;
+}
+
+// Skips the next event of a track, if it is complete
+static LIBREMIDI_INLINE scanned_event
+scan_smf_event(const uint8_t*& p, const uint8_t* end, uint8_t& status) noexcept
+{
+  uint32_t delta{}, length{};
+  if (!scan_variable_length(p, end, delta) || p >= end)
+    return scanned_event::incomplete;
+
+  uint8_t b = *p;
+  if (b & 0x80)
+    p++;
+  else if (status != 0)
+    b = status;
+  else
+    return scanned_event::incomplete;
+
+  if (b == 0xFF)
+  {
+    if (p >= end)
+      return scanned_event::incomplete;
+    const uint8_t type = *p++;
+    if (!scan_variable_length(p, end, length) || std::size_t(end - p) < length)
+      return scanned_event::incomplete;
+    p += length;
+    status = 0;
+    return type == 0x2F ? scanned_event::end_of_track : scanned_event::complete;
+  }
+  else if (b == 0xF0 || b == 0xF7)
+  {
+    if (!scan_variable_length(p, end, length) || std::size_t(end - p) < length)
+      return scanned_event::incomplete;
+    p += length;
+    status = 0;
+    return scanned_event::complete;
+  }
+  else if (b > 0xF0)
+  {
+    return scanned_event::incomplete;
+  }
+
+  const std::ptrdiff_t data_bytes = ((b & 0xF0) == 0xC0 || (b & 0xF0) == 0xD0) ? 1 : 2;
+  if (end - p < data_bytes)
+    return scanned_event::incomplete;
+  for (std::ptrdiff_t i = 0; i < data_bytes; i++)
+    if (p[i] & 0x80)
+      return scanned_event::incomplete;
+  p += data_bytes;
+  status = b;
+  return scanned_event::complete;
+}
+}
+
+// Positions in the files written by the recorder: the header is followed by a single track
+static constexpr std::size_t recorder_track_length_offset = 18;
+static constexpr std::size_t recorder_track_offset = 22;
+
+LIBREMIDI_INLINE
+smf_recorder::smf_recorder() noexcept = default;
+
+LIBREMIDI_INLINE
+smf_recorder::~smf_recorder()
+{
+  close();
+}
+
+LIBREMIDI_INLINE
+bool smf_recorder::open(const std::filesystem::path& path)
+{
+  close();
+
+  if (ticksPerQuarterNote <= 0 || ticksPerQuarterNote > 0x7FFF)
+    return false;
+  if (tempo == 0 || tempo > 0xFFFFFF)
+    return false;
+
+  m_file.open(path, std::ios::binary | std::ios::trunc);
+  if (!m_file.is_open())
+    return false;
+
+  // Encoded events are never larger than their records in the queue,
+  // so the whole queue can always be drained at once
+  if (!m_queue.allocate(bufferSize))
+  {
+    m_file.close();
+    return false;
+  }
+  m_pending.resize(m_queue.capacity());
+
+  m_origin = 0;
+  m_time = 0;
+  m_tick = 0;
+  m_status = 0;
+  m_started = false;
+  m_error = false;
+  m_dropped = 0;
+  m_pushClock = 0;
+  m_pushStarted = false;
+
+  uint8_t header[recorder_track_offset + 7]{'M', 'T', 'h', 'd'};
+  uint8_t* out = util::write_uint32_be(header + 4, 6);
+  out = util::write_uint16_be(out, 0);
+  out = util::write_uint16_be(out, 1);
+  out = util::write_uint16_be(out, static_cast<uint16_t>(ticksPerQuarterNote));
+  std::memcpy(out, "MTrk", 4);
+
+  // The track length is updated at each flush
+  out = util::write_uint32_be(out + 4, 7);
+  const uint8_t tempo_event[7]{0x00, 0xFF, 0x51, 0x03, uint8_t(tempo >> 16), uint8_t(tempo >> 8),
+                               uint8_t(tempo)};
+  std::memcpy(out, tempo_event, 7);
+  m_trackSize = 7;
+
+  m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+  m_file.flush();
+  if (!m_file.good())
+  {
+    m_file.close();
+    return false;
+  }
+
+  m_stop.store(false, std::memory_order_relaxed);
+  m_thread = std::thread{[this] { run(); }};
+  return true;
+}
+
+LIBREMIDI_INLINE
+bool smf_recorder::push(const message& m) noexcept
+{
+  return push({m.bytes.data(), m.bytes.size()}, m.timestamp);
+}
+
+LIBREMIDI_INLINE
+bool smf_recorder::push(std::span<const uint8_t> bytes, int64_t timestamp) noexcept
+{
+  if (timestamps == timestamp_mode::NoTimestamp)
+  {
+    timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                    .count();
+  }
+  else if (timestamps == timestamp_mode::Relative)
+  {
+    // Relative timestamps are measured from the previous message the input received,
+    // including the ones which are not stored: they are summed for every message
+    m_pushClock = std::exchange(m_pushStarted, true) ? m_pushClock + timestamp : 0;
+    timestamp = m_pushClock;
+  }
+
+  // Only channel messages and sysex can be stored in a file
+  if (bytes.empty() || bytes[0] < 0x80 || (bytes[0] > 0xF0 && bytes[0] != 0xF7))
+    return true;
+
+  if (!m_queue.try_push(timestamp, bytes))
+  {
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+LIBREMIDI_INLINE
+void smf_recorder::run() noexcept
+{
+  using namespace std::chrono;
+  const auto poll = std::clamp(duration_cast<milliseconds>(flushInterval), 1ms, 10ms);
+  auto next_flush = steady_clock::now() + flushInterval;
+
+  while (!m_stop.load(std::memory_order_acquire))
+  {
+    drain();
+
+    if (const auto now = steady_clock::now(); now >= next_flush)
+    {
+      flush();
+      next_flush = now + flushInterval;
+    }
+    std::this_thread::sleep_for(poll);
+  }
+
+  drain();
+}
+
+LIBREMIDI_INLINE
+void smf_recorder::drain() noexcept
+{
+  util::byte_writer out{m_pending.data()};
+  const int64_t ns_per_quarter = int64_t(tempo) * 1000;
+
+  m_queue.consume([&](int64_t timestamp, std::span<const uint8_t> bytes) {
+    // The first message is at the start of the file
+    // Timestamps are absolute here: relative ones are summed by push()
+    if (!m_started)
+    {
+      m_origin = timestamp;
+      m_started = true;
+    }
+    m_time = timestamp - m_origin;
+
+    // Ticks at the tempo of the file, split to avoid overflows with long captures
+    int64_t tick = (m_time / ns_per_quarter) * ticksPerQuarterNote
+                   + (m_time % ns_per_quarter) * ticksPerQuarterNote / ns_per_quarter;
+    tick = std::max(tick, m_tick);
+
+    util::encode_event(uint32_t(tick - m_tick), bytes, runningStatus, m_status, out);
+    m_tick = tick;
+  });
+
+  const auto size = out.out - m_pending.data();
+  if (size > 0)
+  {
+    m_file.write(reinterpret_cast<const char*>(m_pending.data()), size);
+    m_trackSize += uint32_t(size);
+  }
+}
+
+LIBREMIDI_INLINE
+bool smf_recorder::flush() noexcept
+{
+  // Make the file readable up to this point
+  uint8_t length[4];
+  util::write_uint32_be(length, m_trackSize);
+
+  const auto end = m_file.tellp();
+  m_file.seekp(recorder_track_length_offset);
+  m_file.write(reinterpret_cast<const char*>(length), 4);
+  m_file.seekp(end);
+  m_file.flush();
+
+  if (!m_file.good())
+    m_error = true;
+  return !m_error;
+}
+
+LIBREMIDI_INLINE
+bool smf_recorder::close()
+{
+  if (!is_open())
+    return false;
+
+  m_stop.store(true, std::memory_order_release);
+  m_thread.join();
+
+  uint8_t eot[4];
+  util::byte_writer out{eot};
+  util::encode_end_of_track(0, out);
+  m_file.write(reinterpret_cast<const char*>(eot), 4);
+  m_trackSize += 4;
+
+  bool ok = flush();
+  m_file.close();
+  return ok && !m_file.fail();
+}
+
+LIBREMIDI_INLINE
+bool smf_recorder::recover(const std::filesystem::path& path) noexcept
+{
+  std::size_t valid_end{};
+  bool has_end{};
+  {
+    mapped_file file;
+    if (!file.open(path))
+      return false;
+
+    const uint8_t* const data = file.data();
+    const uint8_t* const end = data + file.size();
+    if (file.size() < recorder_track_offset || std::memcmp(data, "MThd", 4) != 0
+        || std::memcmp(data + 14, "MTrk", 4) != 0)
+      return false;
+
+    const uint8_t* p = data + recorder_track_offset;
+    const uint8_t* valid = p;
+    uint8_t status = 0;
+    for (;;)
+    {
+      const auto res = util::scan_smf_event(p, end, status);
+      if (res == util::scanned_event::incomplete)
+        break;
+      valid = p;
+      if (res == util::scanned_event::end_of_track)
+      {
+        has_end = true;
+        break;
+      }
+    }
+    valid_end = std::size_t(valid - data);
+  }
+
+  std::error_code ec;
+  std::filesystem::resize_file(path, valid_end, ec);
+  if (ec)
+    return false;
+
+  std::fstream file{path, std::ios::binary | std::ios::in | std::ios::out};
+  if (!file.is_open())
+    return false;
+
+  auto track_size = uint32_t(valid_end - recorder_track_offset);
+  if (!has_end)
+  {
+    uint8_t eot[4];
+    util::byte_writer out{eot};
+    util::encode_end_of_track(0, out);
+    file.seekp(0, std::ios::end);
+    file.write(reinterpret_cast<const char*>(eot), 4);
+    track_size += 4;
+  }
+
+  uint8_t length[4];
+  util::write_uint32_be(length, track_size);
+  file.seekp(recorder_track_length_offset);
+  file.write(reinterpret_cast<const char*>(length), 4);
+  file.flush();
+  return file.good();
+}
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <libremidi/detail/spsc_byte_queue.hpp>
+#include <libremidi/input_configuration.hpp>
+#include <libremidi/message.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace libremidi
+{
+/**
+ * @brief Records incoming MIDI messages to a Standard MIDI file as they arrive.
+ *
+ * Unlike writer, nothing is kept in memory: the messages are appended to a single
+ * format-0 track by a background thread, which periodically flushes the file and updates
+ * its track length. A capture thus only loses the last flush interval if the process dies,
+ * and recover() makes the file valid again.
+ *
+ * The messages are passed to the background thread through a lock-free buffer,
+ * so that push() never blocks nor allocates: it can be called from the input callback.
+ *
+ * ```
+ * libremidi::smf_recorder rec;
+ * rec.open("capture.mid");
+ * libremidi::midi_in in{{.on_message = rec.callback()}};
+ * in.open_port(...);
+ * ...
+ * in.close_port();
+ * rec.close();
+ * ```
+ */
+class LIBREMIDI_EXPORT smf_recorder
+{
+public:
+  smf_recorder() noexcept;
+  smf_recorder(const smf_recorder&) = delete;
+  smf_recorder& operator=(const smf_recorder&) = delete;
+  ~smf_recorder();
+
+  //! The following are used by open()
+  int ticksPerQuarterNote{480};
+  uint32_t tempo{500000}; //! In microseconds per quarter note, written at the start
+
+  //! How the timestamps of the messages are to be understood, as set in the
+  //! input_configuration. With NoTimestamp, the messages are timestamped when pushed.
+  //! The time of the first message is the start of the file.
+  timestamp_mode timestamps{timestamp_mode::Absolute};
+
+  std::size_t bufferSize{1 << 20}; //! In bytes, for the messages not written yet
+  std::chrono::milliseconds flushInterval{1000};
+  bool runningStatus{false};
+
+  //! Creates the file, and starts the thread writing to it
+  bool open(const std::filesystem::path& path);
+  bool is_open() const noexcept { return m_thread.joinable(); }
+
+  //! Appends a message, from a single thread at a time. Realtime and system
+  //! common messages cannot be stored in a file and are ignored.
+  //! Returns false if the message is dropped because the buffer is full.
+  bool push(const message& m) noexcept;
+  bool push(std::span<const uint8_t> bytes, int64_t timestamp) noexcept;
+
+  //! To be used as input_configuration::on_message
+  message_callback callback() noexcept
+  {
+    return [this](message&& m) { push(m); };
+  }
+
+  //! Writes the pending messages and the end of the track, and closes the file.
+  //! Returns false if the file could not be written completely.
+  bool close();
+
+  //! Number of messages dropped because the buffer was full
+  std::size_t dropped() const noexcept { return m_dropped.load(std::memory_order_relaxed); }
+
+  //! Makes a file left by a recorder which was not closed valid again: the incomplete
+  //! event at the end is removed, and the end of the track and its length are written.
+  static bool recover(const std::filesystem::path& path) noexcept;
+
+private:
+  void run() noexcept;
+  void drain() noexcept;
+  bool flush() noexcept;
+
+  spsc_byte_queue m_queue;
+  std::thread m_thread;
+  std::atomic_bool m_stop{};
+  std::atomic_size_t m_dropped{};
+
+  // Only used by the thread calling push()
+  int64_t m_pushClock{};
+  bool m_pushStarted{};
+
+  // Only used by the writing thread
+  std::ofstream m_file;
+  std::vector<uint8_t> m_pending;
+  int64_t m_origin{};
+  int64_t m_time{};
+  int64_t m_tick{};
+  uint32_t m_trackSize{};
+  uint8_t m_status{};
+  bool m_started{};
+  bool m_error{};
+};
+}
+
+#if defined(LIBREMIDI_HEADER_ONLY)
+  #include <libremidi/recorder.cpp>
+#endif
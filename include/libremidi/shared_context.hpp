@@ -1,6 +1,7 @@
 #pragma once
 #include <libremidi/api.hpp>
 #include <libremidi/config.hpp>
+#include <libremidi/thread_policy.hpp>
 
 #include <any>
 
@@ -30,4 +31,9 @@ struct shared_configurations
 LIBREMIDI_EXPORT
 shared_configurations create_shared_context(libremidi::API api, std::string_view client_name);
 
+//! Same as above, the policy being applied to the threads started by the context
+LIBREMIDI_EXPORT
+shared_configurations create_shared_context(
+    libremidi::API api, std::string_view client_name, const thread_policy& policy);
+
 }
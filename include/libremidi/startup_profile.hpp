@@ -0,0 +1,70 @@
+#pragma once
+#include <libremidi/config.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+namespace libremidi
+{
+enum class startup_phase : uint8_t
+{
+  //! dlopen of a system library, e.g. libasound.so.2
+  library_load,
+
+  //! Resolution of the symbols of a subsystem, e.g. the ALSA sequencer functions
+  symbol_resolution,
+
+  //! Creation of a midi_in, midi_out or observer object by a back-end
+  client_creation,
+
+  //! First port enumeration done by an observer
+  first_enumeration
+};
+
+struct startup_event
+{
+  startup_phase phase{};
+
+  //! Library, subsystem or API name, e.g. "libasound.so.2", "alsa seq", "alsa_seq"
+  std::string_view backend;
+
+  std::chrono::nanoseconds duration{};
+};
+
+using startup_profiler = std::function<void(const startup_event&)>;
+
+namespace detail
+{
+struct startup_profiler_state
+{
+  std::atomic_bool enabled{};
+  std::mutex mutex;
+  std::shared_ptr<const startup_profiler> callback;
+
+  static startup_profiler_state& instance() noexcept
+  {
+    static startup_profiler_state self;
+    return self;
+  }
+};
+}
+
+//! Installs a callback reporting the time spent while starting back-ends.
+//! It is called from the thread doing the work, possibly concurrently.
+//! Passing an empty function disables profiling, which then costs a single atomic load.
+inline void set_startup_profiler(startup_profiler cb)
+{
+  auto& state = detail::startup_profiler_state::instance();
+  std::lock_guard _{state.mutex};
+  if (cb)
+    state.callback = std::make_shared<const startup_profiler>(std::move(cb));
+  else
+    state.callback.reset();
+  state.enabled.store(bool(state.callback), std::memory_order_release);
+}
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <libremidi/config.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace libremidi
+{
+//! A TEMPO_CHANGE meta event, at an absolute tick
+struct tempo_change
+{
+  int64_t tick{};
+  uint32_t us_per_quarter{500000};
+};
+
+//! Part of a tempo_map where the tempo is constant
+struct tempo_segment
+{
+  int64_t tick{};
+  uint32_t us_per_quarter{500000};
+  int64_t ns{}; //! Time at which the segment starts
+};
+
+/**
+ * @brief Converts between ticks and time, following the tempo changes of a file.
+ *
+ * The segments are sorted, and each stores the time at which it starts,
+ * so conversions are a binary search followed by a multiplication.
+ * Before the first tempo change, the tempo is 120 BPM as per the SMF specification.
+ */
+class tempo_map
+{
+public:
+  tempo_map() = default;
+
+  //! The changes do not need to be sorted. For changes at the same tick, the last one wins.
+  tempo_map(int ticks_per_quarter, std::vector<tempo_change> changes)
+      : m_tpq{std::max(ticks_per_quarter, 1)}
+  {
+    std::ranges::stable_sort(changes, {}, &tempo_change::tick);
+
+    for (const auto& change : changes)
+    {
+      if (change.us_per_quarter == 0)
+        continue;
+
+      auto& last = m_segments.back();
+      if (change.tick <= last.tick)
+      {
+        // Same tick as the current segment: it is replaced
+        last.us_per_quarter = change.us_per_quarter;
+      }
+      else if (change.us_per_quarter != last.us_per_quarter)
+      {
+        m_segments.push_back(
+            {change.tick, change.us_per_quarter,
+             last.ns + ticks_to_ns(change.tick - last.tick, last.us_per_quarter)});
+      }
+    }
+  }
+
+  [[nodiscard]] int64_t tick_to_ns(int64_t tick) const noexcept
+  {
+    const auto& seg = segment_at_tick(tick);
+    return seg.ns + ticks_to_ns(tick - seg.tick, seg.us_per_quarter);
+  }
+
+  [[nodiscard]] double tick_to_seconds(int64_t tick) const noexcept
+  {
+    return double(tick_to_ns(tick)) / 1e9;
+  }
+
+  //! The last tick whose time is not after the given time
+  [[nodiscard]] int64_t ns_to_tick(int64_t ns) const noexcept
+  {
+    auto it = std::ranges::upper_bound(m_segments, ns, {}, &tempo_segment::ns);
+    const auto& seg = it == m_segments.begin() ? *it : *std::prev(it);
+
+    // Split to avoid overflows with long durations
+    const int64_t ns_per_quarter = int64_t(seg.us_per_quarter) * 1000;
+    const int64_t d = ns - seg.ns;
+    int64_t ticks = (d / ns_per_quarter) * m_tpq + (d % ns_per_quarter) * m_tpq / ns_per_quarter;
+
+    // tick_to_ns rounds down, so the next tick may start at the same nanosecond
+    if (ticks_to_ns(ticks + 1, seg.us_per_quarter) <= d)
+      ticks++;
+    return seg.tick + ticks;
+  }
+
+  //! Tempo in microseconds per quarter note at the given tick
+  [[nodiscard]] uint32_t tempo_at(int64_t tick) const noexcept
+  {
+    return segment_at_tick(tick).us_per_quarter;
+  }
+
+  [[nodiscard]] int ticks_per_quarter() const noexcept { return m_tpq; }
+  [[nodiscard]] std::span<const tempo_segment> segments() const noexcept { return m_segments; }
+
+private:
+  const tempo_segment& segment_at_tick(int64_t tick) const noexcept
+  {
+    auto it = std::ranges::upper_bound(m_segments, tick, {}, &tempo_segment::tick);
+    return it == m_segments.begin() ? *it : *std::prev(it);
+  }
+
+  int64_t ticks_to_ns(int64_t ticks, uint32_t us_per_quarter) const noexcept
+  {
+    // Split to avoid overflows with long durations
+    const int64_t us = ticks * us_per_quarter;
+    return (us / m_tpq) * 1000 + (us % m_tpq) * 1000 / m_tpq;
+  }
+
+  std::vector<tempo_segment> m_segments{tempo_segment{}};
+  int m_tpq{480};
+};
+}
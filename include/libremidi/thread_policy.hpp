@@ -0,0 +1,74 @@
+#pragma once
+#include <libremidi/config.hpp>
+#include <libremidi/error.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace libremidi
+{
+enum class thread_scheduler : uint8_t
+{
+  //! Keep the scheduling of the thread which created the object
+  inherit,
+
+  //! SCHED_FIFO on POSIX systems, time-critical priority on Windows
+  fifo,
+
+  //! SCHED_RR on POSIX systems, time-critical priority on Windows
+  round_robin
+};
+
+//! Tells which parts of a thread_policy could be applied to a thread.
+//! Each member is empty when the corresponding setting was applied or not requested.
+struct thread_policy_report
+{
+  //! Which thread the report is about, e.g. "alsa_raw input"
+  std::string_view thread;
+
+  stdx::error scheduling{};
+  stdx::error affinity{};
+  stdx::error memory_lock{};
+
+  bool ok() const noexcept
+  {
+    return scheduling == stdx::error{} && affinity == stdx::error{}
+           && memory_lock == stdx::error{};
+  }
+};
+
+//! Scheduling of the threads started by libremidi: input threads, observer threads,
+//! and the threads of the shared contexts.
+//! Threads owned by the host API (CoreMIDI, JACK, WinMIDI...) are not affected.
+//! The policy is applied by each thread when it starts.
+struct thread_policy
+{
+  thread_scheduler scheduler = thread_scheduler::inherit;
+
+  //! For fifo and round_robin, clamped to the range supported by the system
+  //! (1 to 99 on Linux). Realtime scheduling usually needs CAP_SYS_NICE or an rtprio limit.
+  int priority = 0;
+
+  //! CPUs the threads are allowed to run on. Empty: no restriction.
+  std::vector<int> cpus;
+
+  //! Lock the current and future memory of the whole process with mlockall,
+  //! so that page faults cannot delay the threads.
+  bool lock_memory = false;
+
+  //! Touch this many bytes of stack when the thread starts, so that it is
+  //! committed (and locked with lock_memory) before the first message arrives.
+  std::size_t prefault_stack = 0;
+
+  //! Called from each thread once the policy was applied to it
+  std::function<void(const thread_policy_report&)> on_applied;
+
+  bool empty() const noexcept
+  {
+    return scheduler == thread_scheduler::inherit && cpus.empty() && !lock_memory
+           && prefault_stack == 0 && !on_applied;
+  }
+};
+}
@@ -26,132 +26,106 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #if !defined(LIBREMIDI_HEADER_ONLY)
   #include <libremidi/writer.hpp>
 #endif
-#include <numeric>
+#include <libremidi/detail/parallel_for.hpp>
+#include <libremidi/detail/smf_encoding.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <new>
 #include <ostream>
 #include <string>
+#include <thread>
 #include <utility>
 
 namespace libremidi
 {
 namespace util
 {
-static LIBREMIDI_INLINE std::ostream& write_uint16_be(std::ostream& out, uint16_t value)
+// Encodes the events of a track, followed by an end-of-track event.
+// The same code computes the size of the track and writes it, so that both always agree.
+// With absolute ticks, the events are taken in the given order, if any.
+template <typename Output>
+static void encode_track(
+    const midi_track& track, std::span<const uint32_t> order, bool absoluteTicks,
+    bool runningStatus, Output& out) noexcept
 {
-  union
-  {
-    uint8_t bytes[2];
-    uint16_t v;
-  } data;
-  data.v = value;
-  out << data.bytes[1];
-  out << data.bytes[0];
-  return out;
-}
+  uint8_t status = 0;
+  int64_t previous = 0;
+  int64_t end = 0;
+  const auto encode = [&](const track_event& event) noexcept {
+    const auto& msg = event.m;
+    if (msg.empty())
+      return;
+
+    // Suppress end-of-track meta messages (one will be added
+    // automatically after all track data has been written).
+    if (msg.bytes[0] == 0xFF && msg.size() >= 2 && msg.bytes[1] == 0x2F)
+    {
+      end = std::max(end, int64_t(event.tick));
+      return;
+    }
 
-[[maybe_unused]] static LIBREMIDI_INLINE std::ostream&
-write_int16_be(std::ostream& out, int16_t value)
-{
-  union
-  {
-    uint8_t bytes[2];
-    int16_t v;
-  } data;
-  data.v = value;
-  out << data.bytes[1];
-  out << data.bytes[0];
-  return out;
-}
+    uint32_t delta = static_cast<uint32_t>(event.tick);
+    if (absoluteTicks)
+    {
+      const int64_t tick = std::max(event.tick, 0);
+      delta = static_cast<uint32_t>(tick - previous);
+      previous = tick;
+    }
 
-static LIBREMIDI_INLINE std::ostream& write_uint32_be(std::ostream& out, uint32_t value)
-{
-  union
-  {
-    uint8_t bytes[4];
-    uint32_t v;
-  } data;
-  data.v = value;
-  out << data.bytes[3];
-  out << data.bytes[2];
-  out << data.bytes[1];
-  out << data.bytes[0];
-  return out;
-}
+    encode_event(delta, {msg.bytes.data(), msg.bytes.size()}, runningStatus, status, out);
+  };
 
-[[maybe_unused]] static LIBREMIDI_INLINE std::ostream&
-write_int32_be(std::ostream& out, int32_t value)
-{
-  union
+  if (order.empty())
   {
-    uint8_t bytes[4];
-    int32_t v;
-  } data;
-  data.v = value;
-  out << data.bytes[3];
-  out << data.bytes[2];
-  out << data.bytes[1];
-  out << data.bytes[0];
-  return out;
-}
-
-[[maybe_unused]] static LIBREMIDI_INLINE std::ostream&
-write_float_be(std::ostream& out, float value)
-{
-  union
+    for (const auto& event : track)
+      encode(event);
+  }
+  else
   {
-    uint8_t bytes[4];
-    float v;
-  } data;
-  data.v = value;
-  out << data.bytes[3];
-  out << data.bytes[2];
-  out << data.bytes[1];
-  out << data.bytes[0];
-  return out;
-}
+    for (uint32_t i : order)
+      encode(track[i]);
+  }
 
-[[maybe_unused]] static LIBREMIDI_INLINE std::ostream&
-write_double_be(std::ostream& out, double value)
-{
-  union
-  {
-    uint8_t bytes[8];
-    double v;
-  } data;
-  data.v = value;
-  out << data.bytes[7];
-  out << data.bytes[6];
-  out << data.bytes[5];
-  out << data.bytes[4];
-  out << data.bytes[3];
-  out << data.bytes[2];
-  out << data.bytes[1];
-  out << data.bytes[0];
-  return out;
+  // With absolute ticks, an end-of-track event after the last event sets the track length
+  encode_end_of_track(absoluteTicks && end > previous ? uint32_t(end - previous) : 0, out);
 }
 
-// Write a number to the midifile
-// as a variable length value which segments a file into 7-bit
-// values.  Maximum size of aValue is 0x7fffffff
-static LIBREMIDI_INLINE void write_variable_length(uint32_t aValue, std::vector<uint8_t>& outdata)
+// Stable order of the events of a track by tick, or nothing if they are already in order.
+// LSD radix sort on (tick, index) pairs, skipping the bytes which are the same for all ticks.
+static LIBREMIDI_INLINE void sort_by_tick(
+    const midi_track& track, std::vector<uint32_t>& order, std::vector<uint64_t>& keys,
+    std::vector<uint64_t>& scratch)
 {
-  uint8_t bytes[5] = {0};
-
-  bytes[0] = static_cast<uint8_t>((aValue >> 28) & 0x7F); // most significant 5 bits
-  bytes[1] = static_cast<uint8_t>((aValue >> 21) & 0x7F); // next largest 7 bits
-  bytes[2] = static_cast<uint8_t>((aValue >> 14) & 0x7F);
-  bytes[3] = static_cast<uint8_t>((aValue >> 7) & 0x7F);
-  bytes[4] = static_cast<uint8_t>((aValue)&0x7F); // least significant 7 bits
+  order.clear();
+  if (std::ranges::is_sorted(track, {}, &track_event::tick))
+    return;
 
-  int start = 0;
-  while (start < 5 && bytes[start] == 0)
-    start++;
+  const std::size_t n = track.size();
+  keys.resize(n);
+  scratch.resize(n);
+  for (std::size_t i = 0; i < n; i++)
+    keys[i] = uint64_t(uint32_t(std::max(track[i].tick, 0))) << 32 | i;
 
-  for (int i = start; i < 4; i++)
+  for (int shift = 32; shift < 64; shift += 8)
   {
-    bytes[i] = bytes[i] | 0x80;
-    outdata.push_back(bytes[i]);
+    std::size_t count[257]{};
+    for (uint64_t k : keys)
+      count[((k >> shift) & 0xFF) + 1]++;
+    if (std::ranges::find(count, n) != std::end(count))
+      continue;
+
+    for (int b = 0; b < 256; b++)
+      count[b + 1] += count[b];
+    for (uint64_t k : keys)
+      scratch[count[(k >> shift) & 0xFF]++] = k;
+    keys.swap(scratch);
   }
-  outdata.push_back(bytes[4]);
+
+  order.resize(n);
+  for (std::size_t i = 0; i < n; i++)
+    order[i] = uint32_t(keys[i]);
 }
 
 static LIBREMIDI_INLINE void
@@ -191,84 +165,137 @@ void writer::add_track()
   util::add_event_track_count_check(tracks, static_cast<int>(tracks.size() + 1));
 }
 
-LIBREMIDI_INLINE
-void writer::write(std::ostream& out) const
+namespace util
 {
-  // MIDI File Header
-  out << 'M';
-  out << 'T';
-  out << 'h';
-  out << 'd';
-  util::write_uint32_be(out, 6);
-  util::write_uint16_be(out, (tracks.size() == 1) ? 0 : 1);
-  util::write_uint16_be(out, static_cast<uint16_t>(tracks.size()));
-  util::write_uint16_be(out, ticksPerQuarterNote);
-
-  std::vector<uint8_t> trackRawData;
-  for (const auto& event_list : tracks)
-  {
-    trackRawData.clear();
-    // Rough estimation of the memory to allocate
-    trackRawData.reserve(event_list.size() * 3);
+// Number of threads to use for encoding the tracks
+static LIBREMIDI_INLINE int
+write_thread_count(int requested, const std::vector<midi_track>& tracks) noexcept
+{
+  if (requested > 0)
+    return requested;
+
+  // Automatic: not worth starting threads for small files
+  std::size_t events = 0;
+  for (const auto& track : tracks)
+    events += track.size();
+  if (events < 64 * 1024)
+    return 1;
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
 
-    for (const auto& event : event_list)
-    {
-      const auto& msg = event.m;
-      if (msg.empty())
-        continue;
-
-      // Suppress end-of-track meta messages (one will be added
-      // automatically after all track data has been written).
-      if (msg.get_meta_event_type() == meta_event_type::END_OF_TRACK)
-        continue;
-
-      util::write_variable_length(static_cast<uint32_t>(event.tick), trackRawData);
-
-      if ((msg.get_message_type() == message_type::SYSTEM_EXCLUSIVE)
-          || (event.m.get_message_type() == message_type::EOX))
-      {
-        // 0xf0 == Complete sysex message (0xf0 is part of the raw MIDI).
-        // 0xf7 == Raw byte message (0xf7 not part of the raw MIDI).
-        // Print the first byte of the message (0xf0 or 0xf7), then
-        // print a VLV length for the rest of the bytes in the message.
-        // In other words, when creating a 0xf0 or 0xf7 MIDI message,
-        // do not insert the VLV byte length yourself, as this code will
-        // do it for you automatically.
-        trackRawData.emplace_back(msg.bytes[0]); // 0xf0 or 0xf7;
-
-        util::write_variable_length(static_cast<uint32_t>(msg.size()) - 1, trackRawData);
-
-        trackRawData.insert(
-            trackRawData.end(), msg.bytes.data() + 1, msg.bytes.data() + msg.bytes.size());
-      }
-      else
-      {
-        // Non-sysex type of message, so just output the bytes of the message:
-        trackRawData.insert(
-            trackRawData.end(), msg.bytes.data(), msg.bytes.data() + msg.bytes.size());
-      }
-    }
+// MIDI File Header
+static LIBREMIDI_INLINE uint8_t* write_smf_header(uint8_t* out, const writer& w) noexcept
+{
+  std::memcpy(out, "MThd", 4);
+  out = write_uint32_be(out + 4, 6);
+  out = write_uint16_be(out, (w.tracks.size() == 1) ? 0 : 1);
+  out = write_uint16_be(out, static_cast<uint16_t>(w.tracks.size()));
+  return write_uint16_be(out, static_cast<uint16_t>(w.ticksPerQuarterNote));
+}
 
-    auto size = trackRawData.size();
-    const auto eot = meta_events::end_of_track();
+// Write the track ID marker "MTrk", then the track, and finally its length
+static LIBREMIDI_INLINE uint8_t* write_smf_track(
+    uint8_t* out, const midi_track& track, std::span<const uint32_t> order, bool absoluteTicks,
+    bool runningStatus) noexcept
+{
+  std::memcpy(out, "MTrk", 4);
+  byte_writer writer{out + 8};
+  encode_track(track, order, absoluteTicks, runningStatus, writer);
+  write_uint32_be(out + 4, static_cast<uint32_t>(writer.out - out - 8));
+  return writer.out;
+}
 
-    if ((size < 3) || !((trackRawData[size - 3] == 0xFF) && (trackRawData[size - 2] == 0x2F)))
-    {
-      trackRawData.emplace_back(0x0); // tick
-      trackRawData.emplace_back(eot[0]);
-      trackRawData.emplace_back(eot[1]);
-      trackRawData.emplace_back(eot[2]);
-    }
+// Order of the events and position of each track in the file
+struct smf_layout
+{
+  std::vector<std::vector<uint32_t>> orders;
+  std::vector<std::size_t> offsets;
+  std::size_t size{};
 
-    // Write the track ID marker "MTrk":
-    out << 'M';
-    out << 'T';
-    out << 'r';
-    out << 'k';
-    util::write_uint32_be(out, static_cast<uint32_t>(trackRawData.size()));
-    out.write(
-        reinterpret_cast<char*>(trackRawData.data()),
-        static_cast<std::streamsize>(trackRawData.size()));
+  std::span<const uint32_t> order(std::size_t track) const noexcept
+  {
+    return orders.empty() ? std::span<const uint32_t>{} : orders[track];
   }
+};
+
+// The size of each track is computed on up to `threads` threads,
+// which gives the position of each track in the file.
+static LIBREMIDI_INLINE smf_layout layout_smf(const writer& w, int threads)
+{
+  const auto& tracks = w.tracks;
+  smf_layout layout;
+  if (w.useAbsoluteTicks)
+  {
+    layout.orders.resize(tracks.size());
+    std::vector<uint64_t> keys, scratch;
+    for (std::size_t i = 0; i < tracks.size(); i++)
+      sort_by_tick(tracks[i], layout.orders[i], keys, scratch);
+  }
+
+  layout.offsets.resize(tracks.size());
+  detail::parallel_for(tracks.size(), threads, [&](std::size_t i, int) noexcept {
+    byte_counter counter;
+    encode_track(tracks[i], layout.order(i), w.useAbsoluteTicks, w.runningStatus, counter);
+    layout.offsets[i] = counter.size;
+  });
+
+  layout.size = 14;
+  for (auto& offset : layout.offsets)
+    layout.size += 8 + std::exchange(offset, layout.size);
+  return layout;
+}
+
+// Writes the file in get_buffer(size), which returns a smaller span if it cannot be written.
+// Each track is encoded at its place in the buffer, so they can be encoded in parallel.
+template <typename GetBuffer>
+static std::size_t write_smf(const writer& w, GetBuffer&& get_buffer)
+{
+  const auto& tracks = w.tracks;
+  const int threads = write_thread_count(w.threadCount, tracks);
+  const auto layout = layout_smf(w, threads);
+
+  const std::span<uint8_t> buffer = get_buffer(layout.size);
+  if (buffer.size() < layout.size)
+    return 0;
+
+  write_smf_header(buffer.data(), w);
+  detail::parallel_for(tracks.size(), threads, [&](std::size_t i, int) noexcept {
+    write_smf_track(
+        buffer.data() + layout.offsets[i], tracks[i], layout.order(i), w.useAbsoluteTicks,
+        w.runningStatus);
+  });
+  return layout.size;
+}
+}
+
+LIBREMIDI_INLINE
+std::size_t writer::encoded_size() const
+{
+  return util::layout_smf(*this, util::write_thread_count(threadCount, tracks)).size;
+}
+
+LIBREMIDI_INLINE
+std::size_t writer::write_to(std::span<uint8_t> buffer) const
+{
+  return util::write_smf(*this, [buffer](std::size_t) noexcept { return buffer; });
+}
+
+LIBREMIDI_INLINE
+void writer::write_to(std::vector<uint8_t>& buffer) const
+{
+  util::write_smf(*this, [&buffer](std::size_t size) {
+    buffer.resize(size);
+    return std::span<uint8_t>{buffer};
+  });
+}
+
+LIBREMIDI_INLINE
+void writer::write(std::ostream& out) const
+{
+  std::vector<uint8_t> buffer;
+  write_to(buffer);
+  out.write(
+      reinterpret_cast<const char*>(buffer.data()),
+      static_cast<std::streamsize>(buffer.size()));
 }
 }
@@ -27,6 +27,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <libremidi/message.hpp>
 
 #include <cstdint>
+#include <span>
 #include <vector>
 
 namespace libremidi
@@ -37,12 +38,34 @@ public:
   int ticksPerQuarterNote{120};
   std::vector<midi_track> tracks;
 
+  //! Omits the status byte of channel messages which have the same as the previous event
+  bool runningStatus{false};
+
+  //! Whether the ticks of the events are absolute instead of deltas. The events of a track
+  //! can then be in any order: they are sorted by tick when writing, keeping the order of
+  //! the events at the same tick.
+  bool useAbsoluteTicks{false};
+
+  //! Number of threads encoding the tracks: 1 encodes them in the calling thread,
+  //! 0 uses one per hardware thread for large files. The output does not depend on it.
+  int threadCount{1};
+
   void add_event(int tick, int track, const message& m);
   void add_event(int track, const track_event& m);
 
   void add_track();
 
   void write(std::ostream& out) const;
+
+  //! Exact size of the file written by write and write_to
+  [[nodiscard]] std::size_t encoded_size() const;
+
+  //! Writes the file in the buffer, and returns its size,
+  //! or 0 without writing anything if the buffer is too small
+  std::size_t write_to(std::span<uint8_t> buffer) const;
+
+  //! Replaces the content of the buffer by the file
+  void write_to(std::vector<uint8_t>& buffer) const;
 };
 }
 
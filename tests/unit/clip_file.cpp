@@ -0,0 +1,221 @@
+#include "../include_catch.hpp"
+
+#include <libremidi/clip_file.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+// Note on and off of MIDI 2.0 channel voice messages, on group 0 and channel 0
+constexpr libremidi::ump note_on{0x40903C00, 0xFFFF0000};
+constexpr libremidi::ump note_off{0x40803C00, 0x00000000};
+
+bool same_words(const libremidi::clip_event& ev, const libremidi::ump& m)
+{
+  if (ev.size() != libremidi::ump_word_count(m.data[0]))
+    return false;
+  for (std::size_t i = 0; i < ev.size(); i++)
+    if (ev.word(i) != m.data[i])
+      return false;
+  return true;
+}
+}
+
+TEST_CASE("write and read a clip file", "[clip_file]")
+{
+  libremidi::clip_writer w;
+  w.ticksPerQuarterNote = 960;
+  w.add_event(0, note_on);
+  w.add_event(960, note_off);
+  // Sysex8 message of 4 words, which a single ump::size() does not describe
+  w.add_event(480, libremidi::ump{0x50000102, 0x03040506, 0x07080900, 0});
+  w.endTick = 1920;
+
+  std::vector<uint8_t> buffer;
+  w.write_to(buffer);
+  REQUIRE(buffer.size() == w.encoded_size());
+  REQUIRE(std::equal(buffer.begin(), buffer.begin() + 8, "SMF2CLIP"));
+
+  libremidi::clip_reader r;
+  REQUIRE(r.parse(buffer) == libremidi::reader::validated);
+  CHECK(r.diagnostics.empty());
+  CHECK(r.ticksPerQuarterNote == 960);
+  CHECK(r.get_end_tick() == 1920);
+  CHECK(r.get_end_seconds() == 1.0);
+  REQUIRE(r.events.size() == 3);
+
+  // Sorted by tick when written
+  CHECK(r.events[0].tick == 0);
+  CHECK(same_words(r.events[0], note_on));
+  CHECK(r.events[1].tick == 480);
+  CHECK(r.events[1].size() == 4);
+  CHECK(r.events[2].tick == 960);
+  CHECK(same_words(r.events[2], note_off));
+
+  // The events refer to the buffer
+  CHECK(r.events[0].data >= buffer.data());
+  CHECK(r.events[2].data < buffer.data() + buffer.size());
+
+  const auto m = r.events[0].to_ump();
+  CHECK(m.data[0] == note_on.data[0]);
+  CHECK(m.data[1] == note_on.data[1]);
+}
+
+TEST_CASE("write a clip file to a fixed buffer", "[clip_file]")
+{
+  libremidi::clip_writer w;
+  w.add_event(10, note_on);
+
+  std::vector<uint8_t> buffer(w.encoded_size());
+  CHECK(w.write_to(std::span{buffer}.first(buffer.size() - 1)) == 0);
+  CHECK(w.write_to(std::span{buffer}) == buffer.size());
+
+  std::vector<uint8_t> other;
+  w.write_to(other);
+  CHECK(other == buffer);
+}
+
+TEST_CASE("clip file deltas larger than a delta clockstamp", "[clip_file]")
+{
+  libremidi::clip_writer w;
+  const int64_t far = 3 * 0xFFFFF + 17;
+  w.add_event(0, note_on);
+  w.add_event(far, note_off);
+
+  std::vector<uint8_t> buffer;
+  w.write_to(buffer);
+
+  libremidi::clip_reader r;
+  REQUIRE(r.parse(buffer) == libremidi::reader::validated);
+  REQUIRE(r.events.size() == 2);
+  CHECK(r.events[1].tick == far);
+  CHECK(r.get_end_tick() == far);
+}
+
+TEST_CASE("clip file tempo", "[clip_file]")
+{
+  libremidi::clip_writer w;
+  w.ticksPerQuarterNote = 100;
+  w.tempo = 250000;
+  w.add_event(100, note_on);
+
+  std::vector<uint8_t> buffer;
+  w.write_to(buffer);
+
+  libremidi::clip_reader r;
+  REQUIRE(r.parse(buffer) == libremidi::reader::validated);
+  CHECK(r.tempoMap.tempo_at(0) == 250000);
+  CHECK(r.tempoMap.tick_to_ns(100) == 250'000'000);
+
+  // The Set Tempo message is kept as an event
+  REQUIRE(r.events.size() == 2);
+  CHECK(r.events[0].word(0) >> 28 == 0xD);
+}
+
+TEST_CASE("clip file from a stream with timing messages", "[clip_file]")
+{
+  libremidi::clip_writer w;
+  w.ticksPerQuarterNote = 480;
+
+  // At 120 BPM, a quarter note is 15625 JR timestamp units
+  const uint32_t stream[]{
+      0x00200000 | 0xFFF0,                   // JR timestamp, close to wrapping around
+      note_on.data[0],       note_on.data[1],
+      0x00200000 | ((0xFFF0 + 15625) & 0xFFFF), // One quarter note later
+      note_off.data[0],      note_off.data[1],
+      0x00000000,                            // NOOP
+      0x00400000 | 240,                      // Delta clockstamp
+      note_on.data[0],       note_on.data[1],
+  };
+  CHECK(w.add_stream(0, stream) == 720);
+  REQUIRE(w.size() == 3);
+
+  std::vector<uint8_t> buffer;
+  w.write_to(buffer);
+
+  libremidi::clip_reader r;
+  REQUIRE(r.parse(buffer) == libremidi::reader::validated);
+  REQUIRE(r.events.size() == 3);
+  CHECK(r.events[0].tick == 0);
+  CHECK(r.events[1].tick == 480);
+  CHECK(r.events[2].tick == 720);
+
+  // Written clips only use delta clockstamps
+  for (const auto& ev : r.events)
+    CHECK(ev.word(0) >> 28 != 0);
+}
+
+TEST_CASE("read an invalid clip file", "[clip_file]")
+{
+  libremidi::clip_reader r;
+  CHECK(r.parse(nullptr, 0) == libremidi::reader::invalid);
+
+  const uint8_t smf[]{'M', 'T', 'h', 'd', 0, 0, 0, 6};
+  CHECK(r.parse(smf, sizeof(smf)) == libremidi::reader::invalid);
+  REQUIRE(r.diagnostics.size() == 1);
+  CHECK(r.diagnostics[0].error == libremidi::parse_error::invalid_header);
+
+  libremidi::clip_writer w;
+  w.add_event(0, note_on);
+  w.add_event(10, note_off);
+  std::vector<uint8_t> buffer;
+  w.write_to(buffer);
+
+  SECTION("truncated")
+  {
+    // In the middle of the End of Clip message
+    buffer.resize(buffer.size() - 8);
+    CHECK(r.parse(buffer) == libremidi::reader::incomplete);
+    CHECK(r.events.size() == 2);
+    REQUIRE(r.diagnostics.size() == 1);
+    CHECK(r.diagnostics[0].error == libremidi::parse_error::truncated_event);
+  }
+
+  SECTION("missing delta clockstamp")
+  {
+    // Replaces the delta clockstamp before the note off by a NOOP
+    const std::size_t note_off_offset = buffer.size() - 20 - 8;
+    std::fill_n(buffer.begin() + note_off_offset - 4, 4, 0);
+    CHECK(r.parse(buffer) == libremidi::reader::complete);
+    CHECK(r.events.size() == 2);
+    REQUIRE(r.diagnostics.size() == 1);
+    CHECK(r.diagnostics[0].error == libremidi::parse_error::missing_delta_clockstamp);
+    CHECK(r.diagnostics[0].offset == note_off_offset);
+  }
+}
+
+TEST_CASE("read a clip file from disk", "[clip_file]")
+{
+  libremidi::clip_writer w;
+  w.add_configuration(libremidi::ump{0xF0020000, 0, 0, 0});
+  for (int i = 0; i < 100; i++)
+    w.add_event(i * 10, i % 2 ? note_off : note_on);
+
+  const auto path = std::filesystem::temp_directory_path() / "libremidi_clip_test.midi2";
+  {
+    std::ofstream f{path, std::ios::binary};
+    w.write(f);
+  }
+
+  {
+    libremidi::clip_reader r;
+    REQUIRE(r.parse_file(path) == libremidi::reader::validated);
+    REQUIRE(r.configuration.size() == 1);
+    CHECK(r.configuration[0].word(0) == 0xF0020000);
+    REQUIRE(r.events.size() == 100);
+    CHECK(r.events[99].tick == 990);
+    CHECK(same_words(r.events[99], note_off));
+
+    // A missing file does not keep anything of the previous one
+    CHECK(r.parse_file(path.string() + ".missing") == libremidi::reader::invalid);
+    CHECK(r.events.empty());
+    CHECK(r.configuration.empty());
+    CHECK(r.ticksPerQuarterNote == 0);
+    CHECK(r.get_end_tick() == 0);
+    CHECK(r.get_end_seconds() == 0.);
+    REQUIRE(r.diagnostics.size() == 1);
+    CHECK(r.diagnostics[0].error == libremidi::parse_error::empty_buffer);
+  }
+  std::filesystem::remove(path);
+}
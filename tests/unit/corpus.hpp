@@ -0,0 +1,54 @@
+#pragma once
+#include "../include_catch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <vector>
+
+//! The .mid files of the given subfolders of the test corpus, e.g. "Valid", in path order
+inline std::vector<std::filesystem::path> corpus_files(std::initializer_list<const char*> subfolders)
+{
+  constexpr auto recursive = std::filesystem::directory_options::follow_directory_symlink;
+
+  std::vector<std::filesystem::path> res;
+  for (const char* subfolder : subfolders)
+  {
+    const auto folder = std::filesystem::path{LIBREMIDI_TEST_CORPUS} / subfolder;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(folder, recursive))
+      if (entry.is_regular_file() && entry.path().extension() == ".mid")
+        res.push_back(entry.path());
+  }
+  std::ranges::sort(res);
+  return res;
+}
+
+//! Calls f(bytes) with the content of each .mid file of the subfolders of the test corpus.
+//! With a stride of n, only one file out of n of each folder is read, starting with the
+//! first one: the checks which re-read the files many times run on a subset which still
+//! covers every kind of file of the corpus.
+template <typename F>
+void for_each_corpus_file(std::initializer_list<const char*> subfolders, F&& f, int stride = 1)
+{
+  std::vector<uint8_t> bytes;
+  std::filesystem::path folder;
+  int index_in_folder = 0;
+  for (const auto& path : corpus_files(subfolders))
+  {
+    if (path.parent_path() != folder)
+    {
+      folder = path.parent_path();
+      index_in_folder = 0;
+    }
+    if (index_in_folder++ % stride != 0)
+      continue;
+
+    INFO(path);
+    std::ifstream file{path, std::ios::binary};
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    f(bytes);
+  }
+}
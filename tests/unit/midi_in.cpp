@@ -62,3 +62,277 @@ TEST_CASE("poly aftertouch", "[midi_in]")
 #endif
 #endif
 }
+
+#include <libremidi/backends/loopback.hpp>
+TEST_CASE("loopback: receive from a virtual output", "[midi_in]")
+{
+  auto ctx = std::make_shared<libremidi::loopback::context>(
+      libremidi::loopback::context_configuration{.virtual_clock = true});
+
+  libremidi::midi_out midi_out{{}, libremidi::loopback::output_configuration{ctx}};
+  REQUIRE(midi_out.open_virtual_port("source") == stdx::error{});
+
+  auto ports = libremidi::observer{{}, libremidi::loopback::observer_configuration{ctx}}
+                   .get_input_ports();
+  REQUIRE(ports.size() == 1);
+  REQUIRE(ports[0].port_name == "source");
+
+  std::vector<libremidi::message> queue;
+  libremidi::midi_in midi{
+      {.on_message = [&](libremidi::message&& msg) { queue.push_back(std::move(msg)); }},
+      libremidi::loopback::input_configuration{ctx}};
+  REQUIRE(midi.open_port(ports[0]) == stdx::error{});
+
+  midi_out.send_message(libremidi::channel_events::poly_pressure(1, 60, 100));
+  REQUIRE(queue.size() == 1);
+  REQUIRE(queue[0].bytes == libremidi::channel_events::poly_pressure(1, 60, 100).bytes);
+  REQUIRE(queue[0].timestamp == 0);
+
+  midi.close_port();
+  midi_out.send_message(libremidi::channel_events::poly_pressure(1, 60, 100));
+  REQUIRE(queue.size() == 1);
+}
+
+TEST_CASE("loopback: latency with a virtual clock", "[midi_in]")
+{
+  using namespace std::chrono_literals;
+  auto ctx = std::make_shared<libremidi::loopback::context>(
+      libremidi::loopback::context_configuration{.latency = 1ms, .virtual_clock = true});
+
+  std::vector<libremidi::message> queue;
+  libremidi::midi_in midi{
+      {.on_message = [&](libremidi::message&& msg) { queue.push_back(std::move(msg)); },
+       .timestamps = libremidi::timestamp_mode::Absolute},
+      libremidi::loopback::input_configuration{ctx}};
+  REQUIRE(midi.open_virtual_port("sink") == stdx::error{});
+
+  libremidi::midi_out midi_out{{}, libremidi::loopback::output_configuration{ctx}};
+  auto outputs = libremidi::observer{{}, libremidi::loopback::observer_configuration{ctx}}
+                     .get_output_ports();
+  REQUIRE(outputs.size() == 1);
+  REQUIRE(midi_out.open_port(outputs[0]) == stdx::error{});
+
+  midi_out.send_message(0x90, 60, 100);
+  REQUIRE(queue.empty());
+  ctx->advance(999us);
+  REQUIRE(queue.empty());
+  ctx->advance(1us);
+  REQUIRE(queue.size() == 1);
+  REQUIRE(queue[0].timestamp == 1'000'000);
+
+  // Scheduling in the future
+  const unsigned char note_off[3]{0x80, 60, 0};
+  midi_out.schedule_message(midi_out.current_time() + 5'000'000, note_off, 3);
+  ctx->advance(5ms);
+  REQUIRE(queue.size() == 1);
+  ctx->advance(1ms);
+  REQUIRE(queue.size() == 2);
+  REQUIRE(queue[1].timestamp == 7'000'000);
+}
+
+TEST_CASE("loopback: relative timestamps", "[midi_in]")
+{
+  using namespace std::chrono_literals;
+  auto ctx = std::make_shared<libremidi::loopback::context>(
+      libremidi::loopback::context_configuration{.virtual_clock = true});
+
+  std::vector<libremidi::message> queue;
+  libremidi::midi_in midi{
+      {.on_message = [&](libremidi::message&& msg) { queue.push_back(std::move(msg)); },
+       .timestamps = libremidi::timestamp_mode::Relative},
+      libremidi::loopback::input_configuration{ctx}};
+  midi.open_virtual_port("sink");
+
+  libremidi::midi_out midi_out{{}, libremidi::loopback::output_configuration{ctx}};
+  midi_out.open_port(
+      libremidi::observer{{}, libremidi::loopback::observer_configuration{ctx}}
+          .get_output_ports()
+          .front());
+
+  midi_out.send_message(0x90, 60, 100);
+  ctx->advance(500us);
+  midi_out.send_message(0x80, 60, 0);
+  ctx->advance(250us);
+  midi_out.send_message(0x90, 62, 100);
+
+  REQUIRE(queue.size() == 3);
+  REQUIRE(queue[0].timestamp == 0);
+  REQUIRE(queue[1].timestamp == 500'000);
+  REQUIRE(queue[2].timestamp == 250'000);
+}
+
+TEST_CASE("loopback: jitter does not reorder messages", "[midi_in]")
+{
+  using namespace std::chrono_literals;
+  auto ctx = std::make_shared<libremidi::loopback::context>(
+      libremidi::loopback::context_configuration{
+          .latency = 100us, .jitter = 1ms, .virtual_clock = true});
+
+  std::vector<libremidi::message> queue;
+  libremidi::midi_in midi{
+      {.on_message = [&](libremidi::message&& msg) { queue.push_back(std::move(msg)); }},
+      libremidi::loopback::input_configuration{ctx}};
+  midi.open_virtual_port("sink");
+
+  libremidi::midi_out midi_out{{}, libremidi::loopback::output_configuration{ctx}};
+  midi_out.open_port(
+      libremidi::observer{{}, libremidi::loopback::observer_configuration{ctx}}
+          .get_output_ports()
+          .front());
+
+  for (int i = 0; i < 100; i++)
+  {
+    midi_out.send_message(0x90, i, 100);
+    ctx->advance(10us);
+  }
+  ctx->advance(2ms);
+
+  REQUIRE(queue.size() == 100);
+  for (int i = 0; i < 100; i++)
+  {
+    REQUIRE(queue[i].bytes[1] == i);
+    REQUIRE(queue[i].timestamp >= i * 10'000 + 100'000);
+    if (i > 0)
+      REQUIRE(queue[i].timestamp >= queue[i - 1].timestamp);
+  }
+}
+
+TEST_CASE("loopback: real clock", "[midi_in]")
+{
+  using namespace std::chrono_literals;
+  auto ctx = std::make_shared<libremidi::loopback::context>(
+      libremidi::loopback::context_configuration{.latency = 1ms});
+
+  std::atomic_int count = 0;
+  libremidi::midi_in midi{
+      {.on_message = [&](libremidi::message&&) { count++; }},
+      libremidi::loopback::input_configuration{ctx}};
+  midi.open_virtual_port("sink");
+
+  libremidi::midi_out midi_out{{}, libremidi::loopback::output_configuration{ctx}};
+  midi_out.open_port(
+      libremidi::observer{{}, libremidi::loopback::observer_configuration{ctx}}
+          .get_output_ports()
+          .front());
+
+  for (int i = 0; i < 10; i++)
+    midi_out.send_message(0x90, i, 100);
+
+  for (int i = 0; i < 100 && count < 10; i++)
+    std::this_thread::sleep_for(10ms);
+  REQUIRE(count == 10);
+}
+
+TEST_CASE("loopback: thread policy", "[midi_in]")
+{
+  using namespace std::chrono_literals;
+  std::atomic_int applied = 0;
+  std::atomic_bool affinity_ok = false;
+  std::thread::id policy_thread, message_thread;
+
+  // Realtime scheduling needs privileges: only ask for what any process can do
+  libremidi::thread_policy policy{.cpus = {0}, .prefault_stack = 64 * 1024};
+  policy.on_applied = [&](const libremidi::thread_policy_report& report) {
+    policy_thread = std::this_thread::get_id();
+    affinity_ok = report.affinity == stdx::error{};
+    applied++;
+  };
+
+  auto ctx = std::make_shared<libremidi::loopback::context>(
+      libremidi::loopback::context_configuration{.latency = 1ms, .threading = policy});
+
+  std::atomic_int count = 0;
+  auto on_message = [&](libremidi::message&&) {
+    message_thread = std::this_thread::get_id();
+    count++;
+  };
+  libremidi::midi_in midi{
+      {.on_message = on_message}, libremidi::loopback::input_configuration{ctx}};
+  midi.open_virtual_port("sink");
+
+  libremidi::midi_out midi_out{{}, libremidi::loopback::output_configuration{ctx}};
+  midi_out.open_port(
+      libremidi::observer{{}, libremidi::loopback::observer_configuration{ctx}}
+          .get_output_ports()
+          .front());
+
+  midi_out.send_message(0x90, 64, 100);
+  for (int i = 0; i < 100 && count < 1; i++)
+    std::this_thread::sleep_for(10ms);
+
+  REQUIRE(count == 1);
+  REQUIRE(applied == 1);
+  REQUIRE(policy_thread == message_thread);
+  #if defined(__linux__)
+  REQUIRE(affinity_ok);
+  #endif
+}
+
+#if defined(LIBREMIDI_ALSA_RAW_DIRECT)
+  #include <libremidi/backends/alsa_raw_direct.hpp>
+
+  #include <sys/stat.h>
+
+  #include <fcntl.h>
+  #include <unistd.h>
+
+  #include <filesystem>
+TEST_CASE("alsa_raw_direct: read from a FIFO", "[midi_in]")
+{
+  using namespace std::chrono_literals;
+  char dir[] = "/tmp/libremidi-XXXXXX";
+  REQUIRE(mkdtemp(dir));
+  const auto path = std::string(dir) + "/midi";
+  REQUIRE(mkfifo(path.c_str(), 0600) == 0);
+
+  std::mutex mtx;
+  std::vector<libremidi::message> queue;
+  libremidi::midi_in midi{
+      {.on_message =
+           [&](libremidi::message&& msg) {
+             std::lock_guard _{mtx};
+             queue.push_back(std::move(msg));
+           },
+       .ignore_sysex = false},
+      libremidi::alsa_raw_direct::input_configuration{.device_path = path}};
+  REQUIRE(midi.open_port(libremidi::input_port{}) == stdx::error{});
+
+  libremidi::midi_out midi_out{
+      {}, libremidi::alsa_raw_direct::output_configuration{.device_path = path}};
+  REQUIRE(midi_out.open_port(libremidi::output_port{}) == stdx::error{});
+
+  const auto received = [&] {
+    std::lock_guard _{mtx};
+    return queue.size();
+  };
+
+  // Successive writes may be coalesced into a single read
+  const unsigned char notes[] = {0x90, 60, 100, 0x80, 60, 0};
+  midi_out.send_message(notes, sizeof(notes));
+  const unsigned char sysex[] = {0xF0, 0x7E, 0x7F, 0x06, 0x01, 0xF7};
+  midi_out.send_message(sysex, sizeof(sysex));
+
+  for (int i = 0; i < 100 && received() < 3; i++)
+    std::this_thread::sleep_for(10ms);
+
+  {
+    std::lock_guard _{mtx};
+    REQUIRE(queue.size() == 3);
+    REQUIRE(queue[0].bytes == libremidi::midi_bytes{0x90, 60, 100});
+    REQUIRE(queue[1].bytes == libremidi::midi_bytes{0x80, 60, 0});
+    REQUIRE(queue[2].bytes == libremidi::midi_bytes{0xF0, 0x7E, 0x7F, 0x06, 0x01, 0xF7});
+  }
+
+  // Nothing is delivered after the port is closed.
+  // Another reader keeps the write from raising SIGPIPE.
+  const int other_reader = ::open(path.c_str(), O_RDONLY | O_NONBLOCK);
+  midi.close_port();
+  midi_out.send_message(0x90, 64, 100);
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(received() == 3);
+
+  midi_out.close_port();
+  ::close(other_reader);
+  std::filesystem::remove_all(dir);
+}
+#endif
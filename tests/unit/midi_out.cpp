@@ -50,3 +50,52 @@ TEST_CASE("sending chunked messages", "[midi_out]")
 }
   #endif
 #endif
+
+#include <libremidi/backends/loopback.hpp>
+TEST_CASE("loopback: capacity", "[midi_out]")
+{
+  using namespace std::chrono_literals;
+  auto ctx = std::make_shared<libremidi::loopback::context>(
+      libremidi::loopback::context_configuration{
+          .latency = 1ms, .capacity = 2, .virtual_clock = true});
+
+  int count = 0;
+  libremidi::midi_in midi{
+      {.on_message = [&](libremidi::message&&) { count++; }},
+      libremidi::loopback::input_configuration{ctx}};
+  midi.open_virtual_port("sink");
+
+  libremidi::midi_out midi_out{{}, libremidi::loopback::output_configuration{ctx}};
+  auto ports = libremidi::observer{{}, libremidi::loopback::observer_configuration{ctx}}
+                   .get_output_ports();
+  REQUIRE(ports.size() == 1);
+  REQUIRE(midi_out.open_port(ports[0]) == stdx::error{});
+
+  REQUIRE(midi_out.send_message(0xF8) == stdx::error{});
+  REQUIRE(midi_out.send_message(0xFA) == stdx::error{});
+  REQUIRE(midi_out.send_message(0xFC) == std::errc::no_buffer_space);
+
+  ctx->advance(1ms);
+  REQUIRE(count == 1); // Clock is ignored by default
+  REQUIRE(midi_out.send_message(0xFC) == stdx::error{});
+}
+
+TEST_CASE("loopback: observer notifications", "[midi_out]")
+{
+  auto ctx = std::make_shared<libremidi::loopback::context>();
+
+  std::vector<std::string> added, removed;
+  libremidi::observer obs{
+      {.input_added = [&](const libremidi::input_port& p) { added.push_back(p.port_name); },
+       .input_removed = [&](const libremidi::input_port& p) { removed.push_back(p.port_name); }},
+      libremidi::loopback::observer_configuration{ctx}};
+
+  {
+    libremidi::midi_out midi_out{{}, libremidi::loopback::output_configuration{ctx}};
+    midi_out.open_virtual_port("a");
+    REQUIRE(added == std::vector<std::string>{"a"});
+    REQUIRE(obs.get_input_ports().size() == 1);
+  }
+  REQUIRE(removed == std::vector<std::string>{"a"});
+  REQUIRE(obs.get_input_ports().empty());
+}
@@ -1,8 +1,15 @@
 #include "../include_catch.hpp"
+#include "corpus.hpp"
 
+#include <libremidi/batch_reader.hpp>
 #include <libremidi/reader.hpp>
+#include <libremidi/writer.hpp>
 
+#include <atomic>
 #include <filesystem>
+#include <ranges>
+#include <sstream>
+#include <stdexcept>
 
 TEST_CASE("read valid files from corpus", "[midi_reader]")
 {
@@ -101,3 +108,716 @@ TEST_CASE("midi file duration in absolute mode", "[midi_reader]")
     REQUIRE(r.get_end_time() == 75388.);
   }
 }
+
+TEST_CASE("reader_view gives the same events as reader", "[midi_reader]")
+{
+  for_each_corpus_file({"Valid", "Invalid"}, [&](const std::vector<uint8_t>& bytes) {
+    libremidi::reader r;
+    libremidi::reader_view v;
+    const auto result = r.parse(bytes);
+    REQUIRE(v.parse(bytes) == result);
+    CHECK(v.format == r.format);
+    CHECK(v.ticksPerBeat == r.ticksPerBeat);
+    CHECK(v.get_end_time() == r.get_end_time());
+
+    REQUIRE(v.tracks.size() == r.tracks.size());
+    for (std::size_t t = 0; t < r.tracks.size(); t++)
+    {
+      REQUIRE(v.tracks[t].size() == r.tracks[t].size());
+      std::size_t i = 0;
+      for (const auto& ev : v.tracks[t])
+      {
+        const auto& expected = r.tracks[t][i++];
+        CHECK(ev.tick == expected.tick);
+        CHECK(ev.track == expected.track);
+        CHECK(std::ranges::equal(ev.m.bytes, expected.m.bytes));
+      }
+
+      // The views are returned by value: reverse iterators do not dangle
+      for (const auto& ev : std::views::reverse(v.tracks[t]))
+      {
+        const auto& expected = r.tracks[t][--i];
+        CHECK(ev.tick == expected.tick);
+        CHECK(std::ranges::equal(ev.m.bytes, expected.m.bytes));
+      }
+    }
+  });
+}
+
+TEST_CASE("parsing tracks in parallel gives the same result", "[midi_reader]")
+{
+  for_each_corpus_file({"Valid", "Invalid"}, [&](const std::vector<uint8_t>& bytes) {
+    libremidi::reader serial;
+    libremidi::reader parallel;
+    parallel.threadCount = 4;
+    libremidi::reader_view parallel_view;
+    parallel_view.threadCount = 4;
+
+    const auto result = serial.parse(bytes);
+    REQUIRE(parallel.parse(bytes) == result);
+    REQUIRE(parallel_view.parse(bytes) == result);
+    REQUIRE(parallel.tracks.size() == serial.tracks.size());
+    REQUIRE(parallel_view.tracks.size() == serial.tracks.size());
+    for (std::size_t t = 0; t < serial.tracks.size(); t++)
+    {
+      REQUIRE(parallel.tracks[t].size() == serial.tracks[t].size());
+      REQUIRE(parallel_view.tracks[t].size() == serial.tracks[t].size());
+      for (std::size_t i = 0; i < serial.tracks[t].size(); i++)
+      {
+        const auto& expected = serial.tracks[t][i];
+        CHECK(parallel.tracks[t][i].tick == expected.tick);
+        CHECK(parallel.tracks[t][i].m.bytes == expected.m.bytes);
+        CHECK(parallel_view.tracks[t][i].tick == expected.tick);
+        CHECK(std::ranges::equal(parallel_view.tracks[t][i].m.bytes, expected.m.bytes));
+      }
+    }
+  });
+}
+
+TEST_CASE("parse a file from a memory mapping", "[midi_reader]")
+{
+  const auto path = LIBREMIDI_TEST_CORPUS "/Valid/MultiTrack/Middle/pilgrim.mid";
+
+  std::vector<uint8_t> bytes;
+  std::ifstream file{path, std::ios::binary};
+  bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+  libremidi::reader expected;
+  REQUIRE(expected.parse(bytes) == libremidi::reader::validated);
+
+  const auto check_tracks = [&](const std::vector<libremidi::midi_track>& tracks) {
+    REQUIRE(tracks.size() == expected.tracks.size());
+    for (std::size_t t = 0; t < tracks.size(); t++)
+    {
+      REQUIRE(tracks[t].size() == expected.tracks[t].size());
+      for (std::size_t i = 0; i < tracks[t].size(); i++)
+      {
+        CHECK(tracks[t][i].tick == expected.tracks[t][i].tick);
+        CHECK(tracks[t][i].m.bytes == expected.tracks[t][i].m.bytes);
+      }
+    }
+  };
+
+  SECTION("reader")
+  {
+    libremidi::reader r;
+    REQUIRE(r.parse_file(path) == libremidi::reader::validated);
+    check_tracks(r.tracks);
+  }
+
+  SECTION("reader_view")
+  {
+    libremidi::reader_view r;
+    REQUIRE(r.parse_file(path) == libremidi::reader::validated);
+    // The events are still valid after moving the reader_view, which owns the mapping
+    auto moved = std::move(r);
+    check_tracks(moved.to_tracks());
+  }
+
+  SECTION("missing file")
+  {
+    // Nothing is kept from the file parsed before
+    const auto missing = LIBREMIDI_TEST_CORPUS "/does_not_exist.mid";
+    const auto check_reset = [](const auto& r) {
+      CHECK(r.tracks.empty());
+      CHECK(r.get_end_tick() == 0);
+      REQUIRE(r.tempoMap.segments().size() == 1);
+      CHECK(r.tempoMap.segments()[0].us_per_quarter == 500000);
+      CHECK(r.format == 0);
+      CHECK(r.ticksPerBeat == 0.f);
+      REQUIRE(r.diagnostics.size() == 1);
+      CHECK(r.diagnostics[0].error == libremidi::parse_error::empty_buffer);
+    };
+
+    libremidi::reader r;
+    REQUIRE(r.parse_file(path) == libremidi::reader::validated);
+    CHECK(r.parse_file(missing) == libremidi::reader::invalid);
+    check_reset(r);
+
+    libremidi::reader_view v;
+    REQUIRE(v.parse_file(path) == libremidi::reader::validated);
+    CHECK(v.parse_file(missing) == libremidi::reader::invalid);
+    check_reset(v);
+  }
+}
+
+TEST_CASE("stream_reader gives the events of reader in time order", "[midi_reader]")
+{
+  // Compares every event: a quarter of each folder of the corpus is enough
+  for_each_corpus_file({"Valid", "Invalid"}, [&](const std::vector<uint8_t>& bytes) {
+    libremidi::reader r{true};
+    const auto result = r.parse(bytes);
+
+    libremidi::stream_reader s;
+    if (s.open(bytes) == libremidi::reader::invalid)
+    {
+      CHECK(result == libremidi::reader::invalid);
+      return;
+    }
+
+    // Stable merge of the tracks of reader, by absolute tick then track
+    std::vector<const libremidi::track_event*> expected;
+    for (const auto& track : r.tracks)
+      for (const auto& ev : track)
+        expected.push_back(&ev);
+    std::ranges::stable_sort(expected, [](auto* lhs, auto* rhs) {
+      return lhs->tick < rhs->tick;
+    });
+
+    if (result == libremidi::reader::invalid)
+    {
+      // reader drops the tracks after one with an unreadable delta-time
+      while (s.next())
+        ;
+      CHECK(s.result() == result);
+      return;
+    }
+
+    std::size_t i = 0;
+    while (auto ev = s.next())
+    {
+      REQUIRE(i < expected.size());
+      CHECK(ev->tick == expected[i]->tick);
+      CHECK(ev->track == expected[i]->track);
+      CHECK(std::ranges::equal(ev->m.bytes, expected[i]->m.bytes));
+      i++;
+    }
+
+    CHECK(i == expected.size());
+    CHECK(s.result() == result);
+  }, 4);
+}
+
+namespace
+{
+struct seek_result
+{
+  std::vector<libremidi::message> state;
+  std::vector<std::pair<int, std::vector<uint8_t>>> events;
+};
+
+// The state at the tick and the events from the tick on, reading the file from the start
+seek_result read_from(libremidi::stream_reader& s, int64_t tick)
+{
+  seek_result res;
+  libremidi::playback_state state;
+  s.rewind();
+  while (auto ev = s.next())
+  {
+    if (ev->tick < tick)
+      state.apply(ev->m.bytes);
+    else
+      res.events.push_back({ev->tick, {ev->m.bytes.begin(), ev->m.bytes.end()}});
+  }
+  res.state = state.messages();
+  return res;
+}
+
+seek_result seek_to(libremidi::stream_reader& s, int64_t tick)
+{
+  seek_result res;
+  res.state = s.seek(tick).messages();
+  while (auto ev = s.next())
+    res.events.push_back({ev->tick, {ev->m.bytes.begin(), ev->m.bytes.end()}});
+  return res;
+}
+
+bool same_state(const std::vector<libremidi::message>& lhs, const std::vector<libremidi::message>& rhs)
+{
+  return std::ranges::equal(
+      lhs, rhs, [](const auto& l, const auto& r) { return std::ranges::equal(l.bytes, r.bytes); });
+}
+}
+
+TEST_CASE("playback state messages", "[midi_reader]")
+{
+  using ev = libremidi::channel_events;
+  const auto position = [](const std::vector<libremidi::message>& msgs, uint8_t cc) {
+    auto it = std::ranges::find_if(msgs, [=](const auto& m) {
+      return m.bytes.size() == 3 && (m.bytes[0] & 0xF0) == 0xB0 && m.bytes[1] == cc;
+    });
+    return it - msgs.begin();
+  };
+
+  libremidi::playback_state state;
+  const auto apply = [&](const libremidi::message& m) {
+    state.apply({m.bytes.data(), m.bytes.size()});
+  };
+  SECTION("data entry is sent after the parameter numbers")
+  {
+    // NRPN selected first, then the pitch bend range RPN
+    for (const auto& m :
+         {ev::control_change(1, 99, 1), ev::control_change(1, 98, 2), ev::control_change(1, 7, 90),
+          ev::control_change(1, 101, 0), ev::control_change(1, 100, 0), ev::control_change(1, 6, 12)})
+      apply(m);
+
+    const auto msgs = state.messages();
+    REQUIRE(msgs.size() == 6);
+    CHECK(position(msgs, 7) == 0);
+    CHECK(position(msgs, 99) < position(msgs, 101));
+    CHECK(position(msgs, 98) < position(msgs, 101));
+    CHECK(position(msgs, 101) < position(msgs, 100));
+    CHECK(position(msgs, 100) < position(msgs, 6));
+    CHECK(position(msgs, 6) == 5);
+
+    // The NRPN selected last comes last
+    apply(ev::control_change(1, 99, 3));
+    const auto nrpn = state.messages();
+    CHECK(position(nrpn, 100) < position(nrpn, 99));
+    CHECK(position(nrpn, 99) < position(nrpn, 98));
+    CHECK(position(nrpn, 98) < position(nrpn, 6));
+  }
+
+  SECTION("reset all controllers")
+  {
+    for (const auto& m :
+         {ev::control_change(1, 7, 90), ev::control_change(1, 11, 20), ev::control_change(1, 64, 127),
+          ev::control_change(1, 101, 0), ev::control_change(1, 100, 0), ev::control_change(1, 6, 12),
+          ev::control_change(1, 2, 50), ev::pitch_bend(1, 0)})
+      apply(m);
+    apply(ev::control_change(1, 121, 0));
+
+    const auto& c = state.channels[0];
+    CHECK(c.controllers[7] == 90);
+    CHECK(c.controllers[11] == 127);
+    CHECK(c.controllers[64] == 0);
+    CHECK(c.controllers[101] == 127);
+    CHECK(c.controllers[100] == 127);
+    CHECK(c.controllers[6] == 12);
+    CHECK(c.controllers[2] == libremidi::playback_state::unset);
+    CHECK(c.pitch_bend == 0x2000);
+  }
+}
+
+TEST_CASE("seek in a file with a seek index", "[midi_reader]")
+{
+  libremidi::writer w;
+  w.useAbsoluteTicks = true;
+  w.ticksPerQuarterNote = 96;
+  for (int t = 0; t < 4; t++)
+  {
+    const int channel = 1 + t;
+    for (int i = 0; i < 500; i++)
+    {
+      const int tick = i * 48 + t * 7;
+      w.add_event(tick, t, libremidi::channel_events::note_on(channel, uint8_t(40 + i % 40), 100));
+      if (i % 7 == 0)
+        w.add_event(tick, t, libremidi::channel_events::control_change(channel, 7, uint8_t(i % 128)));
+      if (i % 11 == 0)
+        w.add_event(tick, t, libremidi::channel_events::program_change(channel, uint8_t(i % 128)));
+      if (i % 13 == 0)
+        w.add_event(tick, t, libremidi::channel_events::pitch_bend(channel, i * 31 % 16384));
+      if (i == 300)
+        w.add_event(tick, t, libremidi::channel_events::control_change(channel, 121, 0));
+    }
+    if (t == 0)
+      w.add_event(12000, 0, libremidi::meta_events::tempo(400000));
+    w.add_event(24000, t, libremidi::meta_events::end_of_track());
+  }
+
+  std::vector<uint8_t> bytes;
+  w.write_to(bytes);
+
+  libremidi::stream_reader linear;
+  REQUIRE(linear.open(bytes) == libremidi::reader::complete);
+
+  libremidi::stream_reader s;
+  REQUIRE(s.open(bytes) == libremidi::reader::complete);
+  REQUIRE(s.build_seek_index(384));
+  CHECK(s.result() == libremidi::reader::validated);
+
+  for (int64_t tick : {0, 1, 383, 384, 1000, 12000, 12001, 14401, 23999, 24000, 30000})
+  {
+    INFO(tick);
+    const auto expected = read_from(linear, tick);
+    const auto res = seek_to(s, tick);
+    CHECK(same_state(res.state, expected.state));
+    CHECK(res.events == expected.events);
+    CHECK(s.seek(tick).tempo == (tick > 12000 ? 400000 : 500000));
+  }
+  CHECK(s.result() == libremidi::reader::validated);
+  CHECK(s.diagnostics.empty());
+
+  // The same without an index
+  libremidi::stream_reader unindexed;
+  REQUIRE(unindexed.open(bytes) == libremidi::reader::complete);
+  const auto expected = read_from(linear, 5000);
+  const auto res = seek_to(unindexed, 5000);
+  CHECK(same_state(res.state, expected.state));
+  CHECK(res.events == expected.events);
+}
+
+TEST_CASE("seek in the files of the corpus", "[midi_reader]")
+{
+  // Each seek is checked against a read from the start: on an eighth of each folder
+  for_each_corpus_file({"Valid", "Invalid"}, [&](const std::vector<uint8_t>& bytes) {
+    libremidi::stream_reader linear;
+    if (linear.open(bytes) == libremidi::reader::invalid)
+      return;
+
+    int64_t end = 0;
+    while (auto ev = linear.next())
+      end = ev->tick;
+    const auto result = linear.result();
+    const auto diagnostics = linear.diagnostics.size();
+
+    libremidi::stream_reader s;
+    s.open(bytes);
+    REQUIRE(s.build_seek_index(96));
+    CHECK(s.result() == result);
+    CHECK(s.diagnostics.size() == diagnostics);
+
+    for (int64_t tick : {end / 3, end / 2 + 1, end})
+    {
+      const auto expected = read_from(linear, tick);
+      const auto res = seek_to(s, tick);
+      CHECK(same_state(res.state, expected.state));
+      CHECK(res.events == expected.events);
+    }
+    CHECK(s.diagnostics.size() == diagnostics);
+  }, 8);
+}
+
+TEST_CASE("columns of the files of the corpus", "[midi_reader]")
+{
+  // Compares every event: a quarter of each folder of the corpus is enough
+  for_each_corpus_file({"Valid", "Invalid"}, [&](const std::vector<uint8_t>& bytes) {
+    libremidi::reader r;
+    if (r.parse(bytes) == libremidi::reader::invalid)
+      return;
+
+    const auto cols = r.columns();
+    REQUIRE(cols.payload_offsets.size() == cols.size() + 1);
+    REQUIRE(cols.track.size() == cols.size());
+    REQUIRE(cols.status.size() == cols.size());
+
+    std::size_t i = 0;
+    for (const auto ev : r.merged())
+    {
+      REQUIRE(i < cols.size());
+      const auto expected = cols.to_event(i);
+      CHECK(expected.tick == ev.tick);
+      CHECK(expected.track == ev.track);
+      CHECK(std::ranges::equal(expected.m.bytes, ev.m.bytes));
+      i++;
+    }
+    CHECK(i == cols.size());
+  }, 4);
+}
+
+TEST_CASE("scan the columns of a file", "[midi_reader]")
+{
+  libremidi::writer w;
+  for (int t = 0; t < 3; t++)
+  {
+    for (int i = 0; i < 100; i++)
+    {
+      w.add_event(10, t, libremidi::channel_events::note_on(1 + t, 60, uint8_t(i + 1)));
+      w.add_event(10, t, libremidi::channel_events::note_off(1 + t, 60, 0));
+    }
+    w.add_event(0, t, libremidi::meta_events::end_of_track());
+  }
+
+  std::vector<uint8_t> bytes;
+  w.write_to(bytes);
+
+  libremidi::reader r;
+  REQUIRE(r.parse(bytes) == libremidi::reader::validated);
+  const auto cols = r.columns();
+  REQUIRE(cols.size() == 3 * 201);
+
+  const auto is_loud_note = [](uint8_t status, uint8_t, uint8_t velocity) {
+    return (status & 0xF0) == 0x90 && velocity > 90;
+  };
+  CHECK(cols.count(is_loud_note) == 3 * 10);
+
+  const auto loud = cols.select(is_loud_note);
+  REQUIRE(loud.size() == 30);
+  CHECK(std::ranges::is_sorted(loud));
+  for (auto i : loud)
+    CHECK(cols.data2[i] > 90);
+
+  // Events of the same tick are in track order
+  CHECK(cols.tick[loud[0]] == 1810);
+  CHECK(cols.track[loud[0]] == 0);
+  CHECK(cols.track[loud[1]] == 1);
+
+  // The end of tracks are meta events: their bytes are in the payload
+  const auto meta = cols.select([](uint8_t status, uint8_t, uint8_t) { return status == 0xFF; });
+  REQUIRE(meta.size() == 3);
+  CHECK(cols.data1[meta[0]] == 0x2F);
+  CHECK(cols.payload_of(meta[0]).size() == 3);
+  CHECK(cols.payload.size() == 9);
+}
+
+TEST_CASE("batch reading of the corpus", "[midi_reader]")
+{
+  const auto paths = libremidi::batch_reader::list_files(LIBREMIDI_TEST_CORPUS);
+  REQUIRE(!paths.empty());
+  REQUIRE(std::ranges::is_sorted(paths));
+
+  // What parsing each file alone gives
+  struct expected_file
+  {
+    libremidi::reader::parse_result result{};
+    std::size_t events{};
+    std::vector<libremidi::parse_diagnostic> diagnostics;
+  };
+  std::vector<expected_file> expected;
+  libremidi::batch_statistics expected_stats;
+  for (const auto& path : paths)
+  {
+    libremidi::reader_view r;
+    auto& e = expected.emplace_back();
+    e.result = r.parse_file(path);
+    for (const auto& t : r.tracks)
+      e.events += t.size();
+    e.diagnostics = r.diagnostics;
+    for (const auto& d : r.diagnostics)
+      expected_stats.errors[std::size_t(d.error)]++;
+  }
+
+  for (int threads : {1, 3})
+  {
+    INFO(threads);
+    libremidi::batch_reader batch;
+    batch.threadCount = threads;
+
+    std::vector<expected_file> results(paths.size());
+    std::vector<int> calls(paths.size());
+    const auto stats = batch.run(paths, [&](const libremidi::batch_file& f) {
+      // Each file is only given to one thread
+      auto& res = results[f.index];
+      calls[f.index]++;
+      res.result = f.result;
+      for (const auto& t : f.file.tracks)
+        res.events += t.size();
+      res.diagnostics = f.file.diagnostics;
+    });
+
+    CHECK(stats.files == paths.size());
+    CHECK(stats.unreadable == 0);
+    CHECK(stats.errors == expected_stats.errors);
+    CHECK(
+        stats.invalid + stats.incomplete + stats.complete + stats.validated == paths.size());
+    CHECK(stats.bytes_per_second() > 0.);
+
+    for (std::size_t i = 0; i < paths.size(); i++)
+    {
+      INFO(paths[i]);
+      CHECK(calls[i] == 1);
+      CHECK(results[i].result == expected[i].result);
+      CHECK(results[i].events == expected[i].events);
+      CHECK(results[i].diagnostics.size() == expected[i].diagnostics.size());
+    }
+  }
+}
+
+TEST_CASE("batch reading errors", "[midi_reader]")
+{
+  libremidi::batch_reader batch;
+  batch.threadCount = 2;
+
+  const std::filesystem::path valid = LIBREMIDI_TEST_CORPUS "/Valid";
+  std::vector<std::filesystem::path> paths = libremidi::batch_reader::list_files(valid);
+  REQUIRE(paths.size() > 2);
+  paths.insert(paths.begin() + 1, LIBREMIDI_TEST_CORPUS "/does_not_exist.mid");
+
+  bool unreadable_reported = false;
+  const auto stats = batch.run(paths, [&](const libremidi::batch_file& f) {
+    if (!f.opened)
+    {
+      unreadable_reported = true;
+      CHECK(f.index == 1);
+      CHECK(f.result == libremidi::reader::invalid);
+      CHECK(f.file.tracks.empty());
+      CHECK(f.file.diagnostics.empty());
+    }
+  });
+  CHECK(unreadable_reported);
+  CHECK(stats.unreadable == 1);
+  CHECK(stats.files == paths.size());
+
+#if defined(__cpp_exceptions)
+  // An exception in the callback stops the batch and is given back
+  std::atomic_int calls = 0;
+  CHECK_THROWS_AS(
+      batch.run(
+          paths,
+          [&](const libremidi::batch_file&) {
+            calls++;
+            throw std::runtime_error{"stop"};
+          }),
+      std::runtime_error);
+  CHECK(calls <= batch.threadCount);
+#endif
+
+  CHECK(batch.run(std::span<const std::filesystem::path>{}, {}).files == 0);
+}
+
+TEST_CASE("diagnostics of the corpus", "[midi_reader]")
+{
+  for_each_corpus_file({"Valid", "Invalid"}, [&](const std::vector<uint8_t>& bytes) {
+    libremidi::reader r;
+    const auto result = r.parse(bytes);
+
+    // Every file which is not validated says why
+    CHECK((result == libremidi::reader::validated) == r.diagnostics.empty());
+    for (const auto& d : r.diagnostics)
+    {
+      CHECK(d.error != libremidi::parse_error::none);
+      CHECK(d.offset <= bytes.size());
+      CHECK(d.track < int(r.tracks.size()) + 1);
+    }
+  });
+}
+
+TEST_CASE("diagnostics give the position of the error", "[midi_reader]")
+{
+  // clang-format off
+  std::vector<uint8_t> bytes{
+    'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, 2, 0, 96,
+    // Track 0: note on, note off with a data byte > 127, end of track
+    'M', 'T', 'r', 'k', 0, 0, 0, 12,
+    0x00, 0x90, 60, 100,
+    0x10, 0x80, 60, 200,
+    0x00, 0xFF, 0x2F, 0x00,
+    // Track 1: end of track, then a truncated note
+    'M', 'T', 'r', 'k', 0, 0, 0, 7,
+    0x00, 0xFF, 0x2F, 0x00,
+    0x00, 0x90, 60,
+  };
+  // clang-format on
+
+  libremidi::reader r;
+  REQUIRE(r.parse(bytes) == libremidi::reader::incomplete);
+  REQUIRE(r.tracks.size() == 2);
+  CHECK(r.tracks[0].size() == 1);
+  CHECK(r.tracks[1].size() == 1);
+
+  REQUIRE(r.diagnostics.size() == 2);
+  CHECK(r.diagnostics[0].track == 0);
+  CHECK(r.diagnostics[0].offset == 27);
+  CHECK(r.diagnostics[0].error == libremidi::parse_error::invalid_data_byte);
+  CHECK(r.diagnostics[1].track == 1);
+  CHECK(r.diagnostics[1].offset == 47);
+  CHECK(r.diagnostics[1].error == libremidi::parse_error::truncated_event);
+
+  libremidi::stream_reader s;
+  REQUIRE(s.open(bytes) == libremidi::reader::complete);
+  while (s.next())
+    ;
+  CHECK(s.result() == libremidi::reader::incomplete);
+  CHECK(s.diagnostics.size() == 2);
+}
+
+TEST_CASE("tempo map of a file", "[midi_reader]")
+{
+  // clang-format off
+  std::vector<uint8_t> bytes{
+    'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, 2, 0, 96,
+    // Track 0: 60 BPM at tick 0, 120 BPM at tick 192
+    'M', 'T', 'r', 'k', 0, 0, 0, 19,
+    0x00, 0xFF, 0x51, 0x03, 0x0F, 0x42, 0x40,
+    0x81, 0x40, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20,
+    0x00, 0xFF, 0x2F, 0x00,
+    // Track 1: a note ending at tick 288
+    'M', 'T', 'r', 'k', 0, 0, 0, 13,
+    0x00, 0x90, 60, 100,
+    0x82, 0x20, 0x80, 60, 0,
+    0x00, 0xFF, 0x2F, 0x00,
+  };
+  // clang-format on
+
+  libremidi::reader r;
+  REQUIRE(r.parse(bytes) == libremidi::reader::validated);
+  CHECK(r.startingTempo == 60.f);
+  CHECK(r.get_end_tick() == 288);
+
+  const auto& map = r.tempoMap;
+  CHECK(map.ticks_per_quarter() == 96);
+  REQUIRE(map.segments().size() == 2);
+  CHECK(map.tempo_at(191) == 1'000'000);
+  CHECK(map.tempo_at(192) == 500'000);
+
+  // Two quarters at 60 BPM, then one at 120 BPM
+  CHECK(map.tick_to_ns(96) == 1'000'000'000);
+  CHECK(map.tick_to_ns(192) == 2'000'000'000);
+  CHECK(map.tick_to_ns(288) == 2'500'000'000);
+  CHECK(r.get_end_seconds() == 2.5);
+
+  for (int64_t tick : {0, 1, 95, 96, 191, 192, 193, 288, 10000})
+    CHECK(map.ns_to_tick(map.tick_to_ns(tick)) == tick);
+
+  libremidi::reader_view v;
+  REQUIRE(v.parse(bytes) == libremidi::reader::validated);
+  CHECK(v.get_end_seconds() == 2.5);
+  CHECK(v.tempoMap.segments().size() == 2);
+}
+
+TEST_CASE("merged tracks are in time order", "[midi_reader]")
+{
+  for_each_corpus_file({"Valid"}, [&](const std::vector<uint8_t>& bytes) {
+    libremidi::reader r;
+    libremidi::reader ra{true};
+    REQUIRE(r.parse(bytes) != libremidi::reader::invalid);
+    REQUIRE(ra.parse(bytes) != libremidi::reader::invalid);
+
+    std::vector<const libremidi::track_event*> expected;
+    for (const auto& track : ra.tracks)
+      for (const auto& ev : track)
+        expected.push_back(&ev);
+    std::ranges::stable_sort(
+        expected, [](auto* lhs, auto* rhs) { return lhs->tick < rhs->tick; });
+
+    for (const auto* reader : {&r, &ra})
+    {
+      std::size_t i = 0;
+      for (libremidi::track_event_view ev : reader->merged())
+      {
+        REQUIRE(i < expected.size());
+        CHECK(ev.tick == expected[i]->tick);
+        CHECK(ev.track == expected[i]->track);
+        CHECK(std::ranges::equal(ev.m.bytes, expected[i]->m.bytes));
+        i++;
+      }
+      CHECK(i == expected.size());
+    }
+
+    // The format-0 track has the same events, with a single end of track
+    const auto is_eot = [](const libremidi::track_event* ev) {
+      return ev->m.get_meta_event_type() == libremidi::meta_event_type::END_OF_TRACK;
+    };
+    const auto eot_count = std::erase_if(expected, is_eot);
+
+    const auto flat = r.merged().to_track(true);
+    REQUIRE(flat.size() == expected.size() + (eot_count > 0));
+    for (std::size_t i = 0; i < expected.size(); i++)
+    {
+      CHECK(flat[i].tick == expected[i]->tick);
+      CHECK(flat[i].m.bytes == expected[i]->m.bytes);
+    }
+    if (flat.empty())
+      return;
+    CHECK(is_eot(&flat.back()));
+
+    // With delta ticks, it can be written and read back
+    libremidi::writer w;
+    w.ticksPerQuarterNote = int(r.ticksPerBeat);
+    w.tracks.push_back(r.merged().to_track());
+
+    std::stringstream out;
+    w.write(out);
+    const auto written = out.str();
+
+    libremidi::reader rw{true};
+    const auto res = rw.parse((const uint8_t*)written.data(), written.size());
+    REQUIRE(res == libremidi::reader::validated);
+    REQUIRE(rw.tracks.size() == 1);
+    REQUIRE(rw.tracks[0].size() == flat.size());
+
+    // The writer does not keep the delta-time of the end of track
+    for (std::size_t i = 0; i + 1 < flat.size(); i++)
+      CHECK(rw.tracks[0][i].tick == flat[i].tick);
+  });
+}
@@ -1,8 +1,15 @@
 #include "../include_catch.hpp"
+#include "corpus.hpp"
 
+#include <libremidi/reader.hpp>
+#include <libremidi/recorder.hpp>
 #include <libremidi/writer.hpp>
 
+#include <algorithm>
 #include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
 
 TEST_CASE("write an empty file", "[midi_writer]")
 {
@@ -67,3 +74,356 @@ TEST_CASE("adding events in invalid tracks", "[midi_writer]")
   REQUIRE_THROWS(writer.add_event(-1, {}));
   REQUIRE_THROWS(writer.add_event(500000, {}));
 }
+
+TEST_CASE("write to a buffer", "[midi_writer]")
+{
+  libremidi::writer writer;
+  writer.ticksPerQuarterNote = 96;
+  for (int i = 0; i < 3; i++)
+  {
+    writer.add_event(0, 0, libremidi::channel_events::note_on(1, 60 + i, 100));
+    writer.add_event(200, 0, libremidi::channel_events::note_off(1, 60 + i, 0));
+  }
+  writer.add_event(0, 1, libremidi::meta_events::tempo(500000));
+  writer.add_event(10, 1, libremidi::message{0xF0, 0x7E, 0x7F, 0x09, 0x01, 0xF7});
+
+  std::stringstream str;
+  writer.write(str);
+  const auto expected = str.str();
+
+  std::vector<uint8_t> bytes;
+  writer.write_to(bytes);
+  REQUIRE(bytes.size() == writer.encoded_size());
+  CHECK(std::ranges::equal(bytes, expected, {}, {}, [](char c) { return uint8_t(c); }));
+
+  // Header: format 1, 2 tracks, 96 ticks per quarter note, in big endian
+  CHECK(
+      std::ranges::equal(
+          std::span{bytes}.first(14),
+          std::vector<uint8_t>{'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, 2, 0, 96}));
+
+  std::vector<uint8_t> buffer(bytes.size() + 10, 0xAA);
+  CHECK(writer.write_to(std::span{buffer}.first(bytes.size() - 1)) == 0);
+  CHECK(buffer[0] == 0xAA);
+  CHECK(writer.write_to(std::span{buffer}) == bytes.size());
+  CHECK(std::ranges::equal(std::span{buffer}.first(bytes.size()), bytes));
+  CHECK(buffer[bytes.size()] == 0xAA);
+}
+
+TEST_CASE("write with running status", "[midi_writer]")
+{
+  libremidi::writer writer;
+  for (int i = 0; i < 4; i++)
+  {
+    writer.add_event(0, 0, libremidi::channel_events::note_on(1, 60 + i, 100));
+    writer.add_event(10, 0, libremidi::channel_events::note_on(1, 60 + i, 0));
+  }
+  writer.add_event(0, 0, libremidi::message{0xFF, 0x01, 0x01, 'x'});
+  writer.add_event(0, 0, libremidi::channel_events::note_on(1, 72, 100));
+  writer.add_event(0, 0, libremidi::channel_events::note_on(2, 72, 100));
+
+  std::vector<uint8_t> full, compressed;
+  writer.write_to(full);
+  writer.runningStatus = true;
+  writer.write_to(compressed);
+  REQUIRE(compressed.size() == writer.encoded_size());
+
+  // The status is written again after the text event, and when the channel changes
+  CHECK(full.size() - compressed.size() == 7);
+
+  libremidi::reader expected, actual;
+  REQUIRE(expected.parse(full) == libremidi::reader::validated);
+  REQUIRE(actual.parse(compressed) == libremidi::reader::validated);
+  REQUIRE(actual.tracks.size() == 1);
+  REQUIRE(actual.tracks[0].size() == expected.tracks[0].size());
+  for (std::size_t i = 0; i < actual.tracks[0].size(); i++)
+  {
+    CHECK(actual.tracks[0][i].tick == expected.tracks[0][i].tick);
+    CHECK(actual.tracks[0][i].m.bytes == expected.tracks[0][i].m.bytes);
+  }
+}
+
+TEST_CASE("write tracks in parallel", "[midi_writer]")
+{
+  for_each_corpus_file({"Valid"}, [&](const std::vector<uint8_t>& bytes) {
+    libremidi::reader r;
+    REQUIRE(r.parse(bytes) != libremidi::reader::invalid);
+
+    libremidi::writer writer;
+    writer.ticksPerQuarterNote = int(r.ticksPerBeat);
+    writer.tracks = std::move(r.tracks);
+
+    for (bool running : {false, true})
+    {
+      writer.runningStatus = running;
+
+      std::vector<uint8_t> serial, parallel;
+      writer.threadCount = 1;
+      writer.write_to(serial);
+      writer.threadCount = 4;
+      writer.write_to(parallel);
+      CHECK(serial == parallel);
+
+      std::vector<uint8_t> buffer(serial.size());
+      CHECK(writer.write_to(std::span{buffer}) == serial.size());
+      CHECK(buffer == serial);
+      CHECK(writer.write_to(std::span{buffer}.first(serial.size() - 1)) == 0);
+    }
+  });
+}
+
+TEST_CASE("write events with absolute ticks", "[midi_writer]")
+{
+  libremidi::writer writer;
+  writer.useAbsoluteTicks = true;
+  writer.add_event(300, 0, libremidi::channel_events::note_off(1, 62, 0));
+  writer.add_event(100, 0, libremidi::channel_events::note_on(1, 61, 100));
+  writer.add_event(500, 0, libremidi::meta_events::end_of_track());
+  writer.add_event(200, 0, libremidi::channel_events::note_on(1, 62, 100));
+  writer.add_event(100, 0, libremidi::channel_events::note_off(1, 60, 0));
+  writer.add_event(0, 0, libremidi::channel_events::note_on(1, 60, 100));
+
+  std::vector<uint8_t> bytes;
+  writer.write_to(bytes);
+
+  libremidi::reader r{true};
+  REQUIRE(r.parse(bytes) == libremidi::reader::validated);
+  REQUIRE(r.tracks.size() == 1);
+
+  const auto& t = r.tracks[0];
+  REQUIRE(t.size() == 6);
+  const int ticks[]{0, 100, 100, 200, 300, 500};
+  const int notes[]{60, 61, 60, 62, 62};
+  for (int i = 0; i < 6; i++)
+    CHECK(t[i].tick == ticks[i]);
+  for (int i = 0; i < 5; i++)
+    CHECK(t[i].m.bytes[1] == notes[i]);
+
+  // The end of track gives the length of the track
+  CHECK(t[5].m.get_meta_event_type() == libremidi::meta_event_type::END_OF_TRACK);
+}
+
+TEST_CASE("write a large unordered track with absolute ticks", "[midi_writer]")
+{
+  std::mt19937 rng{1234};
+  std::uniform_int_distribution<int> tick{0, 1 << 20};
+
+  libremidi::writer writer;
+  writer.useAbsoluteTicks = true;
+  for (int i = 0; i < 20000; i++)
+    writer.add_event(tick(rng), 0, libremidi::channel_events::control_change(1, 1, i % 128));
+
+  auto expected = writer.tracks[0];
+  std::ranges::stable_sort(expected, {}, &libremidi::track_event::tick);
+
+  std::vector<uint8_t> bytes;
+  writer.write_to(bytes);
+  CHECK(bytes.size() == writer.encoded_size());
+
+  libremidi::reader r{true};
+  REQUIRE(r.parse(bytes) == libremidi::reader::validated);
+  REQUIRE(r.tracks.size() == 1);
+  REQUIRE(r.tracks[0].size() == expected.size() + 1);
+  for (std::size_t i = 0; i < expected.size(); i++)
+  {
+    CHECK(r.tracks[0][i].tick == expected[i].tick);
+    CHECK(r.tracks[0][i].m.bytes == expected[i].m.bytes);
+  }
+}
+
+TEST_CASE("write the corpus with absolute ticks", "[midi_writer]")
+{
+  for_each_corpus_file({"Valid"}, [&](const std::vector<uint8_t>& bytes) {
+    libremidi::reader r{true};
+    REQUIRE(r.parse(bytes) != libremidi::reader::invalid);
+
+    libremidi::writer writer;
+    writer.useAbsoluteTicks = true;
+    writer.ticksPerQuarterNote = int(r.ticksPerBeat);
+    writer.tracks = r.tracks;
+
+    std::vector<uint8_t> written;
+    writer.write_to(written);
+
+    // Same events, and same track lengths as the end-of-track events are kept
+    libremidi::reader rw{true};
+    REQUIRE(rw.parse(written) == libremidi::reader::validated);
+    REQUIRE(rw.tracks.size() == r.tracks.size());
+    for (std::size_t t = 0; t < r.tracks.size(); t++)
+    {
+      std::vector<libremidi::track_event> expected;
+      std::ranges::copy_if(r.tracks[t], std::back_inserter(expected), [](const auto& ev) {
+        return !ev.m.empty()
+               && ev.m.get_meta_event_type() != libremidi::meta_event_type::END_OF_TRACK;
+      });
+
+      REQUIRE(rw.tracks[t].size() == expected.size() + 1);
+      for (std::size_t i = 0; i < expected.size(); i++)
+      {
+        CHECK(rw.tracks[t][i].tick == expected[i].tick);
+        CHECK(rw.tracks[t][i].m.bytes == expected[i].m.bytes);
+      }
+      if (!r.tracks[t].empty())
+        CHECK(rw.tracks[t].back().tick == std::max(r.tracks[t].back().tick, 0));
+    }
+  });
+}
+
+TEST_CASE("record to a file", "[midi_recorder]")
+{
+  const auto path = std::filesystem::temp_directory_path() / "libremidi_recorder_test.mid";
+
+  libremidi::smf_recorder rec;
+  rec.ticksPerQuarterNote = 96;
+  rec.tempo = 1'000'000; // One quarter note per second
+  rec.flushInterval = std::chrono::milliseconds{1};
+  REQUIRE(rec.open(path));
+
+  // Timestamps in nanoseconds, the first one is the start of the file
+  const int64_t start = 123'000'000'000;
+  auto on = libremidi::channel_events::note_on(1, 60, 100);
+  on.timestamp = start;
+  auto off = libremidi::channel_events::note_off(1, 60, 0);
+  off.timestamp = start + 500'000'000;
+  auto sysex = libremidi::message{0xF0, 0x7E, 0x7F, 0x09, 0x01, 0xF7};
+  sysex.timestamp = start + 2'000'000'000;
+  auto clock = libremidi::message{0xF8};
+  clock.timestamp = start + 2'500'000'000;
+
+  for (const auto& m : {on, off, sysex, clock})
+    CHECK(rec.push(m));
+  CHECK(rec.close());
+  CHECK(rec.dropped() == 0);
+
+  libremidi::reader r{true};
+  REQUIRE(r.parse_file(path) == libremidi::reader::validated);
+  REQUIRE(r.tracks.size() == 1);
+
+  // Tempo, the three messages which can be stored, end of track
+  const auto& t = r.tracks[0];
+  REQUIRE(t.size() == 5);
+  CHECK(t[0].m.get_meta_event_type() == libremidi::meta_event_type::TEMPO_CHANGE);
+  CHECK(t[1].tick == 0);
+  CHECK(t[1].m.bytes == on.bytes);
+  CHECK(t[2].tick == 48);
+  CHECK(t[2].m.bytes == off.bytes);
+  CHECK(t[3].tick == 192);
+  CHECK(t[3].m.bytes == sysex.bytes);
+  CHECK(r.get_end_seconds() == 2.);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("record with relative timestamps", "[midi_recorder]")
+{
+  const auto path = std::filesystem::temp_directory_path() / "libremidi_recorder_relative.mid";
+
+  libremidi::smf_recorder rec;
+  rec.ticksPerQuarterNote = 96;
+  rec.tempo = 1'000'000; // One quarter note per second
+  rec.timestamps = libremidi::timestamp_mode::Relative;
+  REQUIRE(rec.open(path));
+
+  // Each timestamp is the time since the previous message, clocks included,
+  // even though they are not stored: a note every half second, a clock every 1/8 second
+  const auto note = [](uint8_t velocity, int64_t delta) {
+    auto m = libremidi::channel_events::note_on(1, 60, velocity);
+    m.timestamp = delta;
+    return m;
+  };
+  auto clock = libremidi::message{0xF8};
+  clock.timestamp = 125'000'000;
+
+  CHECK(rec.push(note(1, 999'000'000)));
+  for (uint8_t i = 2; i <= 4; i++)
+  {
+    for (int c = 0; c < 3; c++)
+      CHECK(rec.push(clock));
+    CHECK(rec.push(note(i, 125'000'000)));
+  }
+  CHECK(rec.close());
+
+  libremidi::reader r{true};
+  REQUIRE(r.parse_file(path) == libremidi::reader::validated);
+  REQUIRE(r.tracks.size() == 1);
+
+  // Tempo, the four notes, end of track
+  const auto& t = r.tracks[0];
+  REQUIRE(t.size() == 6);
+  for (int i = 0; i < 4; i++)
+  {
+    CHECK(t[1 + i].tick == 48 * i);
+    CHECK(t[1 + i].m.bytes[2] == i + 1);
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("record more than the buffer can hold", "[midi_recorder]")
+{
+  const auto path = std::filesystem::temp_directory_path() / "libremidi_recorder_full.mid";
+
+  libremidi::smf_recorder rec;
+  rec.bufferSize = 64;
+  rec.runningStatus = true;
+  REQUIRE(rec.open(path));
+
+  int pushed = 0;
+  for (int i = 0; i < 1000; i++)
+  {
+    auto m = libremidi::channel_events::note_on(1, 60, uint8_t(i % 128));
+    m.timestamp = i * 1'000'000;
+    pushed += rec.push(m);
+  }
+  REQUIRE(rec.close());
+  CHECK(pushed + rec.dropped() == 1000);
+
+  libremidi::reader r;
+  REQUIRE(r.parse_file(path) == libremidi::reader::validated);
+  REQUIRE(r.tracks.size() == 1);
+  CHECK(r.tracks[0].size() == std::size_t(pushed) + 2);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("recover an interrupted recording", "[midi_recorder]")
+{
+  const auto path = std::filesystem::temp_directory_path() / "libremidi_recorder_recover.mid";
+
+  libremidi::smf_recorder rec;
+  REQUIRE(rec.open(path));
+  for (int i = 0; i < 10; i++)
+  {
+    auto m = libremidi::channel_events::note_on(1, 60 + i, 100);
+    m.timestamp = i * 10'000'000;
+    REQUIRE(rec.push(m));
+  }
+  REQUIRE(rec.close());
+
+  // As if the process had stopped in the middle of the last note,
+  // before updating the length of the track
+  const auto size = std::filesystem::file_size(path);
+  std::filesystem::resize_file(path, size - 4 - 2);
+  {
+    std::fstream f{path, std::ios::binary | std::ios::in | std::ios::out};
+    f.seekp(18);
+    f.write("\0\0\0\7", 4);
+  }
+
+  libremidi::reader broken;
+  CHECK(broken.parse_file(path) != libremidi::reader::validated);
+
+  REQUIRE(libremidi::smf_recorder::recover(path));
+
+  libremidi::reader r;
+  REQUIRE(r.parse_file(path) == libremidi::reader::validated);
+  REQUIRE(r.tracks.size() == 1);
+  CHECK(r.tracks[0].size() == 1 + 9 + 1);
+
+  // Recovering a complete file does not change it
+  const auto recovered = std::filesystem::file_size(path);
+  REQUIRE(libremidi::smf_recorder::recover(path));
+  CHECK(std::filesystem::file_size(path) == recovered);
+
+  std::filesystem::remove(path);
+}
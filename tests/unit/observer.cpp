@@ -0,0 +1,233 @@
+#include "../include_catch.hpp"
+
+#include <libremidi/configurations.hpp>
+#include <libremidi/libremidi.hpp>
+
+TEST_CASE("port identifiers are stable", "[observer]")
+{
+  libremidi::observer obs{{}, libremidi::dummy_configuration{}};
+
+  libremidi::input_port a{{.client = 1, .port = 1, .port_name = "a", .display_name = "A"}};
+  libremidi::input_port b{{.client = 1, .port = 2, .port_name = "b", .display_name = "B"}};
+  // Same handles but different name: some APIs identify ports by name only
+  libremidi::input_port c{{.client = 1, .port = 2, .port_name = "c", .display_name = "C"}};
+
+  const auto id_a = obs.get_port_id(a);
+  const auto id_b = obs.get_port_id(b);
+  const auto id_c = obs.get_port_id(c);
+  REQUIRE(id_a != id_b);
+  REQUIRE(id_b != id_c);
+  REQUIRE(obs.get_port_id(a) == id_a);
+  REQUIRE(obs.get_port_id(b) == id_b);
+
+  auto port = obs.get_input_port(id_b);
+  REQUIRE(port);
+  REQUIRE(*port == b);
+
+  // The direction is tracked separately
+  REQUIRE(!obs.get_output_port(id_b));
+  libremidi::output_port b_out{b};
+  REQUIRE(obs.get_port_id(b_out) == id_b);
+  REQUIRE(obs.get_output_port(id_b));
+
+  REQUIRE(!obs.get_input_port(1000));
+}
+
+TEST_CASE("port identifiers follow metadata updates", "[observer]")
+{
+  libremidi::observer obs{{}, libremidi::dummy_configuration{}};
+
+  libremidi::output_port a{{.client = 0, .port = 4, .port_name = "a", .display_name = "A"}};
+  const auto id = obs.get_port_id(a);
+
+  a.display_name = "Renamed";
+  REQUIRE(obs.get_port_id(a) == id);
+  REQUIRE(obs.get_output_port(id)->display_name == "Renamed");
+}
+
+#include <libremidi/backends/loopback.hpp>
+TEST_CASE("cached port snapshots", "[observer]")
+{
+  auto ctx = std::make_shared<libremidi::loopback::context>(
+      libremidi::loopback::context_configuration{.virtual_clock = true});
+
+  int added = 0;
+  libremidi::observer obs{
+      {.input_added = [&](const libremidi::input_port&) { added++; }, .cache_ports = true},
+      libremidi::loopback::observer_configuration{ctx}};
+
+  REQUIRE(obs.generation() == 0);
+  auto empty = obs.snapshot();
+  REQUIRE(empty->inputs.empty());
+  REQUIRE(obs.snapshot() == empty);
+
+  {
+    libremidi::midi_out out{{}, libremidi::loopback::output_configuration{ctx}};
+    out.open_virtual_port("source");
+
+    // The user callbacks are still called
+    REQUIRE(added == 1);
+    REQUIRE(obs.generation() == 1);
+
+    auto snap = obs.snapshot();
+    REQUIRE(snap != empty);
+    REQUIRE(snap->generation == 1);
+    REQUIRE(snap->inputs.size() == 1);
+    REQUIRE(snap->inputs[0].port_name == "source");
+    REQUIRE(obs.get_input_ports() == snap->inputs);
+
+    // Nothing changed: same snapshot
+    REQUIRE(obs.snapshot() == snap);
+  }
+
+  REQUIRE(obs.generation() == 2);
+  REQUIRE(obs.snapshot()->inputs.empty());
+
+  // Older snapshots are immutable
+  REQUIRE(empty->inputs.empty());
+}
+
+TEST_CASE("uncached port snapshots", "[observer]")
+{
+  auto ctx = std::make_shared<libremidi::loopback::context>(
+      libremidi::loopback::context_configuration{.virtual_clock = true});
+  libremidi::observer obs{{}, libremidi::loopback::observer_configuration{ctx}};
+
+  libremidi::midi_out out{{}, libremidi::loopback::output_configuration{ctx}};
+  out.open_virtual_port("source");
+
+  REQUIRE(obs.generation() == 0);
+  REQUIRE(obs.snapshot()->inputs.size() == 1);
+}
+
+#include <mutex>
+#include <thread>
+TEST_CASE("coalesced hotplug notifications", "[observer]")
+{
+  using namespace std::chrono_literals;
+  auto ctx = std::make_shared<libremidi::loopback::context>();
+
+  std::mutex mtx;
+  std::vector<libremidi::port_changes> changes;
+  int added = 0;
+  auto on_changes = [&](const libremidi::port_changes& c) {
+    std::lock_guard _{mtx};
+    changes.push_back(c);
+  };
+  libremidi::observer obs{
+      {.input_added = [&](const libremidi::input_port&) { added++; },
+       .on_changes = on_changes,
+       .settle_window = 50ms},
+      libremidi::loopback::observer_configuration{ctx}};
+
+  libremidi::midi_out a{{}, libremidi::loopback::output_configuration{ctx}};
+  a.open_virtual_port("a");
+  {
+    // Appears and disappears within the window: not reported
+    libremidi::midi_out b{{}, libremidi::loopback::output_configuration{ctx}};
+    b.open_virtual_port("b");
+  }
+
+  // The individual callbacks are still called immediately
+  REQUIRE(added == 2);
+
+  for (int i = 0; i < 200; i++)
+  {
+    {
+      std::lock_guard _{mtx};
+      if (!changes.empty())
+        break;
+    }
+    std::this_thread::sleep_for(10ms);
+  }
+  std::this_thread::sleep_for(100ms);
+
+  std::lock_guard _{mtx};
+  REQUIRE(changes.size() == 1);
+  REQUIRE(changes[0].inputs_added.size() == 1);
+  REQUIRE(changes[0].inputs_added[0].port_name == "a");
+  REQUIRE(changes[0].inputs_removed.empty());
+  REQUIRE(changes[0].outputs_added.empty());
+  REQUIRE(changes[0].outputs_removed.empty());
+}
+
+TEST_CASE("cached port snapshots with concurrent hotplug", "[observer]")
+{
+  auto ctx = std::make_shared<libremidi::loopback::context>();
+
+  // Endpoints are created, with the context locked, while observers enumerate them
+  constexpr int port_count = 100;
+  std::vector<std::unique_ptr<libremidi::midi_out>> outs;
+  std::thread hotplug{[&] {
+    for (int i = 0; i < port_count; i++)
+    {
+      auto out = std::make_unique<libremidi::midi_out>(
+          libremidi::output_configuration{}, libremidi::loopback::output_configuration{ctx});
+      out->open_virtual_port("port " + std::to_string(i));
+      outs.push_back(std::move(out));
+    }
+  }};
+
+  std::vector<std::unique_ptr<libremidi::observer>> observers;
+  for (int i = 0; i < 50; i++)
+    observers.push_back(std::make_unique<libremidi::observer>(
+        libremidi::observer_configuration{.cache_ports = true},
+        libremidi::loopback::observer_configuration{ctx}));
+  hotplug.join();
+
+  // The ports created during the first enumeration are not lost
+  for (const auto& obs : observers)
+    REQUIRE(obs->snapshot()->inputs.size() == port_count);
+}
+
+#include <libremidi/startup_profile.hpp>
+TEST_CASE("startup profiler", "[observer]")
+{
+  std::vector<libremidi::startup_event> events;
+  libremidi::set_startup_profiler(
+      [&](const libremidi::startup_event& e) { events.push_back(e); });
+
+  auto ctx = std::make_shared<libremidi::loopback::context>();
+  libremidi::observer obs{{}, libremidi::loopback::observer_configuration{ctx}};
+  REQUIRE(events.size() == 1);
+  REQUIRE(events[0].phase == libremidi::startup_phase::client_creation);
+  REQUIRE(events[0].backend == "loopback");
+
+  REQUIRE(obs.get_input_ports().empty());
+  REQUIRE(obs.get_output_ports().empty());
+  REQUIRE(obs.get_input_ports().empty());
+  REQUIRE(events.size() == 2);
+  REQUIRE(events[1].phase == libremidi::startup_phase::first_enumeration);
+  REQUIRE(events[1].backend == "loopback");
+
+  libremidi::set_startup_profiler({});
+  libremidi::observer other{{}, libremidi::loopback::observer_configuration{ctx}};
+  REQUIRE(other.get_input_ports().empty());
+  REQUIRE(events.size() == 2);
+}
+
+#if defined(LIBREMIDI_ALSA) && LIBREMIDI_HAS_UDEV
+  #include <libremidi/backends/alsa_raw/observer.hpp>
+TEST_CASE("alsa_raw: udev device names", "[observer]")
+{
+  using event = libremidi::alsa_raw::sound_device_event;
+
+  auto ev = event::parse("midiC2D1");
+  REQUIRE(ev.kind == event::type::rawmidi);
+  REQUIRE(ev.card == 2);
+  REQUIRE(ev.device == 1);
+
+  ev = event::parse("umpC3D0");
+  REQUIRE(ev.kind == event::type::rawmidi);
+  REQUIRE(ev.card == 3);
+
+  ev = event::parse("card12");
+  REQUIRE(ev.kind == event::type::card);
+  REQUIRE(ev.card == 12);
+
+  REQUIRE(event::parse("controlC1").kind == event::type::card);
+  REQUIRE(event::parse("pcmC1D0p").kind == event::type::other);
+  REQUIRE(event::parse("seq").kind == event::type::other);
+  REQUIRE(event::parse(nullptr).kind == event::type::other);
+}
+#endif